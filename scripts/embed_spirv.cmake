@@ -0,0 +1,27 @@
+# Embed a SPIR-V binary as a constexpr uint32_t array
+#
+# usage: cmake -DINPUT=<file.spv> -DOUTPUT=<file.hpp> -DNAME=<identifier> -P embed_spirv.cmake
+
+file(READ "${INPUT}" spirv_hex HEX)
+
+# SPIR-V words are little endian, swap every 4 bytes into a 0x........ literal
+string(REGEX REPLACE
+        "([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])"
+        "0x\\4\\3\\2\\1, "
+        spirv_words "${spirv_hex}")
+string(REGEX REPLACE "((0x[0-9a-f]+, ){8})" "\\1\n        " spirv_words "${spirv_words}")
+
+file(WRITE "${OUTPUT}"
+"// generated from ${INPUT} by embed_spirv.cmake, do not edit
+#pragma once
+
+#include <cstdint>
+
+namespace venture::spirv {
+
+inline constexpr uint32_t ${NAME}[] = {
+        ${spirv_words}
+};
+
+} // venture::spirv
+")
@@ -0,0 +1,25 @@
+// Bindless heap (set 1) and push constants shared by every pipeline, see src/hal/vulkan/BindlessHeap.hpp
+//
+// Storage buffers are declared by the including shader, one block type per array all aliasing binding 1:
+//     layout(std430, set = 1, binding = 1) readonly buffer ObjectBuffer { ObjectData objects[]; } object_buffers[];
+// Images are sampled as sampler2D(bindless_images[nonuniformEXT(i)], bindless_samplers[SAMPLER_LINEAR_REPEAT]) when
+// the index is not dynamically uniform, e.g. read from per object data.
+// Indexing either array with a push constant or uniform value relies on the device's
+// shaderSampledImageArrayDynamicIndexing and shaderStorageBufferArrayDynamicIndexing, required and enabled by the
+// renderer, see DeviceProfile::missing_requirement.
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(set = 1, binding = 0) uniform texture2D bindless_images[];
+layout(set = 1, binding = 2) uniform sampler bindless_samplers[2];
+
+const uint SAMPLER_LINEAR_REPEAT = 0;
+const uint SAMPLER_NEAREST_CLAMP = 1;
+
+// see PushConstants in src/hal/vulkan/ShaderInterface.hpp, storage buffer slots of the scene
+layout(push_constant) uniform PushConstants {
+    uint objects;
+    uint mesh_draws;
+    uint draw_commands;
+    uint draw_counts;
+} push;
@@ -0,0 +1,11 @@
+// Per frame uniforms (set 0 binding 0) read by every pipeline, the GLSL side of FrameUniforms in
+// src/hal/vulkan/ShaderInterface.hpp, change both together
+
+layout(set = 0, binding = 0) uniform FrameUniforms {
+    mat4 view_proj;
+    vec4 time;       // x = seconds since start, y = delta seconds
+    vec4 frustum[6]; // world space planes, xyz normal pointing inward and w distance
+    uvec4 scene;     // x = object count, y = scene color slot, z = detail texture slot
+    vec4 lod;        // x = pixels per world unit at clip w 1, y = error threshold in pixels
+    vec4 resolution; // xy = rendered fraction of the scene color target, zw = its texel size
+} frame;
@@ -1,9 +1,23 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "bindless.glsl"
+
+// permutations, see SpecializationId in src/hal/vulkan/PipelineDesc.hpp
+layout(constant_id = 0) const bool ALPHA_BLEND = false;
+
+#include "frame.glsl"
 
 layout(location = 0) in vec3 frag_color;
 layout(location = 0) out vec4 out_color;
 
 void main()
 {
-    out_color = vec4(frag_color, 1.0);
-}
\ No newline at end of file
+    // the detail texture spans the rendered area, white while it streams in or without one, see TextureStreamer.
+    // Rendered area = target size * rendered fraction, its level follows the resolution just like the renderer requests
+    vec2 uv = gl_FragCoord.xy * frame.resolution.zw / frame.resolution.xy;
+
+    // dynamically uniform, covered by shaderSampledImageArrayDynamicIndexing
+    vec3 detail = texture(sampler2D(bindless_images[frame.scene.z], bindless_samplers[SAMPLER_LINEAR_REPEAT]), uv).rgb;
+    out_color = vec4(frag_color * detail, ALPHA_BLEND ? 0.5 : 1.0);
+}
@@ -1,21 +1,29 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
 
-layout(location = 0) out vec3 frag_color;
+#include "bindless.glsl"
+
+// see Vertex in src/hal/vulkan/Mesh.hpp
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 color;
+
+#include "frame.glsl"
 
-vec3 positions[3] = vec3[](
-    vec3( 0.0, -0.4, 0.0),
-    vec3( 0.4,  0.4, 0.0),
-    vec3(-0.4,  0.4, 0.0)
-);
+struct ObjectData {
+    mat4 model;
+    vec4 bounds;
+    uint mesh;
+};
 
-vec3 colors[3] = vec3[](
-    vec3(1.0, 0.0, 0.0),
-    vec3(0.0, 1.0, 0.0),
-    vec3(0.0, 0.0, 1.0)
-);
+layout(std430, set = 1, binding = 1) readonly buffer ObjectBuffer {
+    ObjectData objects[];
+} object_buffers[];
+
+layout(location = 0) out vec3 frag_color;
 
 void main()
 {
-    gl_Position = vec4(positions[gl_VertexIndex], 1.0);
-    frag_color = colors[gl_VertexIndex];
+    // firstInstance of every indirect command is the object index, see shaders/cull.comp
+    gl_Position = frame.view_proj * object_buffers[push.objects].objects[gl_InstanceIndex].model * vec4(position, 1.0);
+    frag_color = color;
 }
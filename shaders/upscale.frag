@@ -0,0 +1,22 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// Bilinear upscale of the rendered part of the scene color target to the output, see DynamicResolution
+
+#include "bindless.glsl"
+
+#include "frame.glsl"
+
+layout(location = 0) in vec2 frag_uv;
+layout(location = 0) out vec4 out_color;
+
+void main()
+{
+    // the target is sized for the largest scale, texels past the rendered part hold stale or undefined contents and
+    // the repeating sampler would wrap onto them, keep the filter footprint half a texel inside
+    vec2 half_texel = frame.resolution.zw * 0.5;
+    vec2 uv = clamp(frag_uv * frame.resolution.xy, half_texel, frame.resolution.xy - half_texel);
+
+    // dynamically uniform, covered by shaderSampledImageArrayDynamicIndexing
+    out_color = texture(sampler2D(bindless_images[frame.scene.y], bindless_samplers[SAMPLER_LINEAR_REPEAT]), uv);
+}
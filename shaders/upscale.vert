@@ -0,0 +1,13 @@
+#version 450
+
+// One triangle covering the viewport, no vertex input, see the upscale pass in src/hal/vulkan/VulkanRenderer.cpp
+
+layout(location = 0) out vec2 frag_uv;
+
+void main()
+{
+    // (0,0) (2,0) (0,2) in uv, the part past 1 is clipped
+    vec2 uv = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+    frag_uv = uv;
+}
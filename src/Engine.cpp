@@ -2,21 +2,26 @@
 
 namespace venture {
 
-Engine::Engine()
-        : _window(800, 600),
-          _renderer(&_window)
+Engine::Engine(const EngineConfig &config)
+        : _window(config.width, config.height, "Venture", true, config.headless),
+          _renderer(&_window, config.renderer),
+          _frame_limiter(config.frame_limit)
 {
     bool static exists = false;
     if (!exists) exists = true; else throw std::runtime_error("Multiple instances of Engine");
 }
 
-void Engine::run()
+void Engine::run(uint64_t frame_count)
 {
-    while (!_window.should_close())
+    for (uint64_t frame = 0; !_window.should_close() && (frame_count == 0 || frame < frame_count); frame++)
     {
+        _frame_limiter.wait();
         _window.poll_events();
         _renderer.draw();
     }
+
+    // all submitted frames count towards the run
+    _renderer.wait_idle();
 }
 
-} // venture
\ No newline at end of file
+} // venture
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include "EngineConfig.hpp"
+#include "FrameLimiter.hpp"
 #include "hal/Renderer.hpp"
 #include "hal/Window.hpp"
 
@@ -8,15 +11,23 @@ namespace venture {
 class Engine final
 {
 public:
-    explicit Engine();
-    void run();
+    explicit Engine(const EngineConfig &config = {});
+
+    /** run until the window closes, or for frame_count frames if non-zero */
+    void run(uint64_t frame_count = 0);
+
+    /** cpu time the renderer spent drawing every frame run so far, time waiting on the gpu excluded */
+    [[nodiscard]]
+    inline double render_cpu_ms() const noexcept;
 
 private:
 
 private:
     Window _window;
     Renderer _renderer;
+    FrameLimiter _frame_limiter;
 };
 
-} // venture
+double Engine::render_cpu_ms() const noexcept { return _renderer.total_cpu_ms(); }
 
+} // venture
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include "hal/RendererConfig.hpp"
+
+namespace venture {
+
+/** Startup options for Engine, defaults match a regular windowed launch */
+struct EngineConfig
+{
+    int32_t width = 800;
+    int32_t height = 600;
+    bool headless = false; // render to offscreen images, no display required
+    double frame_limit = 0.0; // frames per second cap applied before polling input, 0 is uncapped
+    RendererConfig renderer = {};
+};
+
+} // venture
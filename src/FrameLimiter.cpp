@@ -0,0 +1,29 @@
+#include "FrameLimiter.hpp"
+#include <thread>
+
+namespace venture {
+
+FrameLimiter::FrameLimiter(double frame_rate)
+{
+    if (frame_rate > 0.0)
+        _period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / frame_rate));
+}
+
+void FrameLimiter::wait()
+{
+    if (_period == Clock::duration::zero())
+        return;
+
+    auto now = Clock::now();
+    if (_next - now > SPIN_THRESHOLD)
+        std::this_thread::sleep_until(_next - SPIN_THRESHOLD);
+
+    while (Clock::now() < _next)
+        std::this_thread::yield();
+
+    // a frame that ran long does not earn the following frames a burst to catch up
+    now = Clock::now();
+    _next = now - _next > _period ? now + _period : _next + _period;
+}
+
+} // venture
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <chrono>
+
+namespace venture {
+
+/**
+ * CPU side frame cap
+ *
+ * Sleeping happens at the top of the frame, before input is polled, so the input a frame renders is as fresh as the
+ * cap allows instead of going stale while the frame waits on the swapchain.
+ */
+class FrameLimiter
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** frames per second, 0 disables the limiter */
+    explicit FrameLimiter(double frame_rate = 0.0);
+
+    /** block until the next frame is due */
+    void wait();
+
+private:
+    Clock::duration _period = Clock::duration::zero();
+    Clock::time_point _next = Clock::now();
+
+    // sleep overshoots by up to a scheduler tick, the remainder is spun
+    constexpr static std::chrono::microseconds SPIN_THRESHOLD = std::chrono::microseconds(1500);
+};
+
+} // venture
@@ -0,0 +1,115 @@
+#include "MappedFile.hpp"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace venture::assets {
+
+MappedFile::~MappedFile()
+{
+    reset();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+        : _data(std::exchange(other._data, nullptr)),
+          _size(std::exchange(other._size, 0))
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+    }
+    return *this;
+}
+
+// the view keeps the file alive on both platforms, no handle outlives open()
+#ifdef _WIN32
+Result<MappedFile> MappedFile::open(const std::filesystem::path &path)
+{
+    HANDLE file = CreateFileW(
+            path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return Error(error_view("file cannot be opened"));
+
+    LARGE_INTEGER size = {};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return Error(error_view("file is empty"));
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr)
+        return Error(error_view("file cannot be mapped"));
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr)
+        return Error(error_view("file cannot be mapped"));
+
+    MappedFile mapped;
+    mapped._data = static_cast<const std::byte *>(view);
+    mapped._size = static_cast<size_t>(size.QuadPart);
+    return mapped;
+}
+
+void MappedFile::reset()
+{
+    if (_data != nullptr)
+        UnmapViewOfFile(_data);
+    _data = nullptr;
+    _size = 0;
+}
+#else
+Result<MappedFile> MappedFile::open(const std::filesystem::path &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return Error(error_view("file cannot be opened"));
+
+    struct stat st = {};
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return Error(error_view("file is empty"));
+    }
+
+    void *view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        return Error(error_view("file cannot be mapped"));
+
+    // every byte is copied out right after opening, start reading ahead now
+    madvise(view, static_cast<size_t>(st.st_size), MADV_WILLNEED);
+
+    MappedFile mapped;
+    mapped._data = static_cast<const std::byte *>(view);
+    mapped._size = static_cast<size_t>(st.st_size);
+    return mapped;
+}
+
+void MappedFile::reset()
+{
+    if (_data != nullptr)
+        munmap(const_cast<std::byte *>(_data), _size);
+    _data = nullptr;
+    _size = 0;
+}
+#endif
+
+} // venture::assets
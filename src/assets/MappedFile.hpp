@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include "error_handling/Result.hpp"
+
+namespace venture::assets {
+
+/** Read only memory mapping of a whole file, pages are faulted in on first touch. Move only */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    void operator=(const MappedFile&) = delete;
+
+    /** empty files are an error, they cannot be mapped */
+    [[nodiscard]]
+    static Result<MappedFile> open(const std::filesystem::path &path);
+
+    void reset();
+
+    [[nodiscard]]
+    inline std::span<const std::byte> bytes() const noexcept;
+
+private:
+    const std::byte *_data = nullptr;
+    size_t _size = 0;
+};
+
+std::span<const std::byte> MappedFile::bytes() const noexcept { return { _data, _size }; }
+
+} // venture::assets
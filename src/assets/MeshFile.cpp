@@ -0,0 +1,88 @@
+#include "MeshFile.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace venture::assets {
+
+Result<MeshFile> MeshFile::open(const std::filesystem::path &path)
+{
+    auto mapped = MappedFile::open(path);
+    if (!mapped)
+        return Error(mapped.error());
+
+    auto bytes = mapped->bytes();
+    if (bytes.size() < sizeof(MeshFileHeader))
+        return Error(error_view("mesh file truncated"));
+
+    // the mapping is page aligned and the cooker aligns every record, the structs are read in place
+    const auto *header = reinterpret_cast<const MeshFileHeader *>(bytes.data());
+    if (header->magic != MESH_FILE_MAGIC)
+        return Error(error_view("mesh file magic mismatch"));
+    if (header->version != MESH_FILE_VERSION || header->vertex_stride != sizeof(CookedVertex))
+        return Error(error_view("mesh file version mismatch, recook it"));
+    if (header->file_size != bytes.size())
+        return Error(error_view("mesh file truncated"));
+
+    uint64_t entries_end = sizeof(MeshFileHeader) + uint64_t(header->mesh_count) * sizeof(MeshFileEntry);
+    if (entries_end > bytes.size())
+        return Error(error_view("mesh file truncated"));
+
+    MeshFile file;
+    file._entries = { reinterpret_cast<const MeshFileEntry *>(bytes.data() + sizeof(MeshFileHeader)), header->mesh_count };
+
+    for (const auto &entry : file._entries)
+    {
+        std::pair<uint64_t, uint64_t> blobs[] = {
+                { entry.vertex_offset, uint64_t(entry.vertex_count) * sizeof(CookedVertex) },
+                { entry.index_offset, uint64_t(entry.index_count) * sizeof(uint32_t) },
+                { entry.lod_offset, uint64_t(entry.lod_count) * sizeof(MeshFileLod) },
+                { entry.meshlet_offset, uint64_t(entry.meshlet_count) * sizeof(CookedMeshlet) },
+                { entry.meshlet_vertex_offset, uint64_t(entry.meshlet_vertex_count) * sizeof(uint32_t) },
+                { entry.meshlet_triangle_offset, uint64_t(entry.meshlet_triangle_count) * 3 },
+        };
+
+        for (auto [offset, size] : blobs)
+        {
+            if (offset % MESH_FILE_ALIGNMENT != 0 || offset > bytes.size() || size > bytes.size() - offset)
+                return Error(error_view("mesh file blob out of range"));
+        }
+
+        if (entry.lod_count == 0 || entry.lod_count > MESH_MAX_LODS)
+            return Error(error_view("mesh file lod count out of range"));
+        for (const auto &lod : std::span(reinterpret_cast<const MeshFileLod *>(bytes.data() + entry.lod_offset), entry.lod_count))
+        {
+            if (lod.first_index > entry.index_count || lod.index_count > entry.index_count - lod.first_index)
+                return Error(error_view("mesh file lod out of range"));
+        }
+
+        // the loader copies indices straight into index buffers, one out of range would read past the vertices
+        if (entry.vertex_count == 0 || entry.index_count == 0)
+            return Error(error_view("mesh file mesh is empty"));
+        auto in_vertices = [&entry](uint32_t index) { return index < entry.vertex_count; };
+        auto indices = std::span(reinterpret_cast<const uint32_t *>(bytes.data() + entry.index_offset), entry.index_count);
+        auto meshlet_vertices = std::span(
+                reinterpret_cast<const uint32_t *>(bytes.data() + entry.meshlet_vertex_offset), entry.meshlet_vertex_count);
+        if (!std::ranges::all_of(indices, in_vertices) || !std::ranges::all_of(meshlet_vertices, in_vertices))
+            return Error(error_view("mesh file index out of range"));
+
+        for (const auto &meshlet : std::span(reinterpret_cast<const CookedMeshlet *>(bytes.data() + entry.meshlet_offset), entry.meshlet_count))
+        {
+            if (meshlet.vertex_offset > entry.meshlet_vertex_count
+                || meshlet.vertex_count > entry.meshlet_vertex_count - meshlet.vertex_offset
+                || meshlet.triangle_offset > entry.meshlet_triangle_count
+                || meshlet.triangle_count > entry.meshlet_triangle_count - meshlet.triangle_offset)
+                return Error(error_view("mesh file meshlet out of range"));
+
+            const auto *triangles = reinterpret_cast<const uint8_t *>(bytes.data() + entry.meshlet_triangle_offset);
+            auto meshlet_triangles = std::span(triangles + uint64_t(meshlet.triangle_offset) * 3, uint64_t(meshlet.triangle_count) * 3);
+            if (!std::ranges::all_of(meshlet_triangles, [&meshlet](uint8_t index) { return index < meshlet.vertex_count; }))
+                return Error(error_view("mesh file meshlet index out of range"));
+        }
+    }
+
+    // moving the mapping keeps its address, the entries stay valid
+    file._file = std::move(*mapped);
+    return file;
+}
+
+} // venture::assets
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include "MappedFile.hpp"
+#include "MeshFormat.hpp"
+#include "error_handling/Result.hpp"
+
+namespace venture::assets {
+
+/**
+ * Memory mapped cooked mesh file, see MeshFormat.hpp
+ *
+ * open() only validates the header and that every blob lies inside the file, the blobs are handed out as views into
+ * the mapping and are valid for as long as the MeshFile lives.
+ */
+class MeshFile
+{
+public:
+    [[nodiscard]]
+    static Result<MeshFile> open(const std::filesystem::path &path);
+
+    [[nodiscard]]
+    inline uint32_t mesh_count() const noexcept;
+    [[nodiscard]]
+    inline const MeshFileEntry &entry(uint32_t mesh) const noexcept;
+    /** CookedVertex records */
+    [[nodiscard]]
+    inline std::span<const std::byte> vertices(uint32_t mesh) const noexcept;
+    /** uint32 indices of every LOD */
+    [[nodiscard]]
+    inline std::span<const std::byte> indices(uint32_t mesh) const noexcept;
+    /** at least one, full detail first */
+    [[nodiscard]]
+    inline std::span<const MeshFileLod> lods(uint32_t mesh) const noexcept;
+
+    [[nodiscard]]
+    inline std::span<const CookedMeshlet> meshlets(uint32_t mesh) const noexcept;
+    [[nodiscard]]
+    inline std::span<const uint32_t> meshlet_vertices(uint32_t mesh) const noexcept;
+    /** three per triangle */
+    [[nodiscard]]
+    inline std::span<const uint8_t> meshlet_triangles(uint32_t mesh) const noexcept;
+
+private:
+    MappedFile _file;
+    std::span<const MeshFileEntry> _entries;
+};
+
+uint32_t MeshFile::mesh_count() const noexcept { return static_cast<uint32_t>(_entries.size()); }
+const MeshFileEntry &MeshFile::entry(uint32_t mesh) const noexcept { return _entries[mesh]; }
+
+std::span<const std::byte> MeshFile::vertices(uint32_t mesh) const noexcept
+{
+    const auto &e = _entries[mesh];
+    return _file.bytes().subspan(e.vertex_offset, e.vertex_count * sizeof(CookedVertex));
+}
+
+std::span<const std::byte> MeshFile::indices(uint32_t mesh) const noexcept
+{
+    const auto &e = _entries[mesh];
+    return _file.bytes().subspan(e.index_offset, e.index_count * sizeof(uint32_t));
+}
+
+std::span<const MeshFileLod> MeshFile::lods(uint32_t mesh) const noexcept
+{
+    const auto &e = _entries[mesh];
+    return { reinterpret_cast<const MeshFileLod *>(_file.bytes().data() + e.lod_offset), e.lod_count };
+}
+
+std::span<const CookedMeshlet> MeshFile::meshlets(uint32_t mesh) const noexcept
+{
+    const auto &e = _entries[mesh];
+    return { reinterpret_cast<const CookedMeshlet *>(_file.bytes().data() + e.meshlet_offset), e.meshlet_count };
+}
+
+std::span<const uint32_t> MeshFile::meshlet_vertices(uint32_t mesh) const noexcept
+{
+    const auto &e = _entries[mesh];
+    return { reinterpret_cast<const uint32_t *>(_file.bytes().data() + e.meshlet_vertex_offset), e.meshlet_vertex_count };
+}
+
+std::span<const uint8_t> MeshFile::meshlet_triangles(uint32_t mesh) const noexcept
+{
+    const auto &e = _entries[mesh];
+    return { reinterpret_cast<const uint8_t *>(_file.bytes().data() + e.meshlet_triangle_offset), e.meshlet_triangle_count * size_t(3) };
+}
+
+} // venture::assets
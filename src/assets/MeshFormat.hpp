@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+
+namespace venture::assets {
+
+/**
+ * Cooked mesh file, written by the cooker (src/cooker) and memory mapped by MeshFile
+ *
+ * Layout: MeshFileHeader, mesh_count MeshFileEntry records, then the blobs of every mesh. Every blob starts on
+ * MESH_FILE_ALIGNMENT and holds exactly what the GPU buffers hold, CookedVertex records and uint32 indices already
+ * reordered for the vertex cache, overdraw and vertex fetch, followed by the mesh's LOD table and meshlets, so loading
+ * is a copy from the mapping into staging memory. Every LOD indexes the same vertices, their index lists follow each
+ * other in the index blob, full detail first. Little endian, bump MESH_FILE_VERSION on any change to these structs or to
+ * the vertex layout.
+ */
+constexpr uint32_t MESH_FILE_MAGIC = 0x48534D56; // 'VMSH'
+constexpr uint32_t MESH_FILE_VERSION = 3;
+constexpr uint64_t MESH_FILE_ALIGNMENT = 64;
+
+// meshlet limits, small enough for mesh shader workgroups and for the uint8 local indices
+constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+// LOD 0 included, mirrored by the renderer's MeshDrawData
+constexpr uint32_t MESH_MAX_LODS = 8;
+
+/** mirrors venture::vulkan::Vertex, the renderer static_asserts the two agree */
+struct CookedVertex
+{
+    float position[3];
+    float color[3];
+};
+
+struct MeshFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t mesh_count;
+    uint32_t vertex_stride; // sizeof(CookedVertex) of the cooker
+    uint64_t file_size;
+};
+
+struct MeshFileLod
+{
+    uint32_t first_index; // into the mesh's index blob
+    uint32_t index_count;
+    float error;          // object space bound on a vertex's distance from the full detail triangles it replaces, 0 for LOD 0
+    uint32_t reserved;
+};
+
+/**
+ * Cluster of at most MESHLET_MAX_TRIANGLES triangles over at most MESHLET_MAX_VERTICES vertices
+ *
+ * The whole cluster is outside the frustum when its sphere is, and faces away from the camera when
+ * dot(center - camera_position, cone_axis) >= cone_cutoff * length(center - camera_position) + radius.
+ * A cone_cutoff of 1 never passes that test, used when the triangles face too many directions.
+ */
+struct CookedMeshlet
+{
+    float center[3];
+    float radius;
+    float cone_axis[3];
+    float cone_cutoff;        // sine of the cone's half angle
+    uint32_t vertex_offset;   // into the mesh's meshlet vertices
+    uint32_t triangle_offset; // into the mesh's meshlet triangles, in triangles
+    uint32_t vertex_count;
+    uint32_t triangle_count;
+};
+
+struct MeshFileEntry
+{
+    float bounds[4];                  // object space bounding sphere, xyz center and w radius
+    uint64_t vertex_offset;           // from the start of the file
+    uint64_t index_offset;            // every LOD's indices, index_count in total
+    uint64_t lod_offset;              // lod_count MeshFileLod records
+    uint64_t meshlet_offset;          // CookedMeshlet records
+    uint64_t meshlet_vertex_offset;   // uint32 indices into the vertex blob
+    uint64_t meshlet_triangle_offset; // three uint8 indices into the meshlet's vertices per triangle
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t lod_count;
+    uint32_t meshlet_count;           // meshlets cover LOD 0
+    uint32_t meshlet_vertex_count;
+    uint32_t meshlet_triangle_count;
+};
+
+static_assert(sizeof(CookedVertex) == 24);
+static_assert(sizeof(MeshFileHeader) == 24);
+static_assert(sizeof(MeshFileLod) == 16);
+static_assert(sizeof(CookedMeshlet) == 48);
+static_assert(sizeof(MeshFileEntry) == 88);
+
+} // venture::assets
@@ -0,0 +1,103 @@
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include "Engine.hpp"
+#include "error_handling/Log.hpp"
+
+using namespace venture;
+
+namespace {
+
+/** the whole argument has to be a number in range */
+template<typename T>
+bool parse(const char *argument, T &value)
+{
+    const char *end = argument + std::strlen(argument);
+    auto [last, error] = std::from_chars(argument, end, value);
+    return error == std::errc() && last == end;
+}
+
+} // anonymous
+
+/**
+ * Headless frame throughput benchmark
+ *
+ * usage: VentureBench [--frames N] [--warmup N] [--width W] [--height H] [--frames-in-flight N] [--gpu-csv PATH]
+ *                    [--texture PATH.ktx2] [--dynamic-resolution BUDGET_MS]
+ * Renders offscreen so it runs on machines without a display (e.g. lavapipe, VK_ICD_FILENAMES=lvp_icd.json). The
+ * resolution is fixed unless --dynamic-resolution is given, a scale following gpu time makes runs incomparable
+ */
+int main(int argc, char **argv)
+{
+    uint64_t frames = 1000;
+    uint64_t warmup = 100;
+    EngineConfig config = { .width = 1280, .height = 720, .headless = true };
+
+    // every flag takes a value
+    for (int i = 1; i < argc; i += 2)
+    {
+        if (i + 1 == argc)
+        {
+            fprintf(stderr, "argument '%s' is missing its value\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+
+        bool valid = true;
+        if (std::strcmp(argv[i], "--frames") == 0)
+            valid = parse(argv[i + 1], frames) && frames > 0; // frames/sec divides by it
+        else if (std::strcmp(argv[i], "--warmup") == 0)
+            valid = parse(argv[i + 1], warmup);
+        else if (std::strcmp(argv[i], "--width") == 0)
+            valid = parse(argv[i + 1], config.width) && config.width > 0;
+        else if (std::strcmp(argv[i], "--height") == 0)
+            valid = parse(argv[i + 1], config.height) && config.height > 0;
+        else if (std::strcmp(argv[i], "--frames-in-flight") == 0)
+            valid = parse(argv[i + 1], config.renderer.frames_in_flight) && config.renderer.frames_in_flight > 0;
+        else if (std::strcmp(argv[i], "--gpu-csv") == 0)
+        {
+            config.renderer.gpu_profiling = true;
+            config.renderer.pipeline_statistics = true;
+            config.renderer.profile_csv = argv[i + 1];
+        }
+        else if (std::strcmp(argv[i], "--texture") == 0)
+            config.renderer.texture_path = argv[i + 1];
+        else if (std::strcmp(argv[i], "--dynamic-resolution") == 0)
+        {
+            config.renderer.dynamic_resolution = true;
+            valid = parse(argv[i + 1], config.renderer.gpu_budget_ms) && config.renderer.gpu_budget_ms > 0.0f;
+        }
+        else
+        {
+            fprintf(stderr, "unknown argument '%s'\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+
+        if (!valid)
+        {
+            fprintf(stderr, "argument '%s' has an invalid value '%s'\n", argv[i], argv[i + 1]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    try {
+        Engine engine(config);
+        engine.run(warmup);
+
+        // wall time, process cpu time would add up the worker threads and ignore time spent waiting on the gpu. The
+        // renderer's own cpu time per frame is the part of it the render thread spends recording and submitting
+        auto start = std::chrono::steady_clock::now();
+        double cpu_start_ms = engine.render_cpu_ms();
+        engine.run(frames);
+        double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double cpu_ms = engine.render_cpu_ms() - cpu_start_ms;
+
+        fprintf(stdout, "VentureBench %dx%d, %llu frames, %u in flight\n",
+                config.width, config.height, (unsigned long long)frames, config.renderer.frames_in_flight);
+        fprintf(stdout, "  wall time     : %.3f s\n", wall_s);
+        fprintf(stdout, "  frames/sec    : %.2f\n", double(frames) / wall_s);
+        fprintf(stdout, "  cpu ms/frame  : %.4f\n", cpu_ms / double(frames));
+    } catch (const std::exception &e) {
+        log(Error, "Exception caught in bench FATAL " << e.what());
+        return EXIT_FAILURE;
+    }
+}
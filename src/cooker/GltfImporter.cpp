@@ -0,0 +1,435 @@
+#include "GltfImporter.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string_view>
+#include "Json.hpp"
+
+namespace venture::cooker {
+
+namespace {
+
+constexpr uint32_t GLB_MAGIC = 0x46546C67; // 'glTF'
+constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+constexpr uint32_t COMPONENT_BYTE = 5120;
+constexpr uint32_t COMPONENT_UNSIGNED_BYTE = 5121;
+constexpr uint32_t COMPONENT_SHORT = 5122;
+constexpr uint32_t COMPONENT_UNSIGNED_SHORT = 5123;
+constexpr uint32_t COMPONENT_UNSIGNED_INT = 5125;
+constexpr uint32_t COMPONENT_FLOAT = 5126;
+
+constexpr uint32_t MODE_TRIANGLES = 4;
+
+/** strided elements of one accessor, bounds checked against its buffer view */
+struct AccessorView
+{
+    const uint8_t *data = nullptr;
+    size_t count = 0;
+    size_t stride = 0;
+    uint32_t component_type = 0;
+    uint32_t components = 0;
+    bool normalized = false;
+};
+
+bool read_file(const std::filesystem::path &path, std::vector<uint8_t> &data)
+{
+    std::ifstream ifs(path, std::ios::binary | std::ios::ate); // raii
+    if (!ifs.is_open())
+        return false;
+
+    data.resize(static_cast<size_t>(ifs.tellg()));
+    ifs.seekg(0);
+    ifs.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    return ifs.good();
+}
+
+uint32_t read_u32(const uint8_t *data)
+{
+    uint32_t value;
+    std::memcpy(&value, data, sizeof value);
+    return value;
+}
+
+bool decode_base64(std::string_view text, std::vector<uint8_t> &out)
+{
+    auto decode = [](char c) -> int {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        return -1;
+    };
+
+    uint32_t bits = 0;
+    int bit_count = 0;
+    for (char c : text)
+    {
+        if (c == '=')
+            break;
+
+        int value = decode(c);
+        if (value < 0)
+            return false;
+
+        bits = (bits << 6) | static_cast<uint32_t>(value);
+        bit_count += 6;
+        if (bit_count >= 8)
+        {
+            bit_count -= 8;
+            out.push_back(static_cast<uint8_t>(bits >> bit_count));
+        }
+    }
+    return true;
+}
+
+/** json numbers used as indices, false when negative, fractional or past size */
+bool to_index(double value, size_t size, size_t &index)
+{
+    if (!(value >= 0.0) || value >= static_cast<double>(size) || value != static_cast<double>(static_cast<size_t>(value)))
+        return false;
+    index = static_cast<size_t>(value);
+    return true;
+}
+
+/** json numbers used as sizes and offsets, malformed values become 0 and fail the range checks instead */
+size_t to_size(double value)
+{
+    return value > 0.0 && value < 9007199254740992.0 ? static_cast<size_t>(value) : 0;
+}
+
+uint32_t component_size(uint32_t component_type)
+{
+    switch (component_type)
+    {
+        case COMPONENT_BYTE:
+        case COMPONENT_UNSIGNED_BYTE:
+            return 1;
+        case COMPONENT_SHORT:
+        case COMPONENT_UNSIGNED_SHORT:
+            return 2;
+        case COMPONENT_UNSIGNED_INT:
+        case COMPONENT_FLOAT:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+uint32_t component_count(std::string_view type)
+{
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    return 0;
+}
+
+float read_float(const uint8_t *data, uint32_t component_type, bool normalized)
+{
+    switch (component_type)
+    {
+        case COMPONENT_FLOAT:
+        {
+            float value;
+            std::memcpy(&value, data, sizeof value);
+            return value;
+        }
+        case COMPONENT_UNSIGNED_BYTE:
+            return normalized ? data[0] / 255.0f : data[0];
+        case COMPONENT_BYTE:
+        {
+            auto value = static_cast<int8_t>(data[0]);
+            return normalized ? std::max(value / 127.0f, -1.0f) : value;
+        }
+        case COMPONENT_UNSIGNED_SHORT:
+        {
+            uint16_t value;
+            std::memcpy(&value, data, sizeof value);
+            return normalized ? value / 65535.0f : value;
+        }
+        case COMPONENT_SHORT:
+        {
+            int16_t value;
+            std::memcpy(&value, data, sizeof value);
+            return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+        }
+        default:
+            return 0.0f;
+    }
+}
+
+uint32_t read_index(const uint8_t *data, uint32_t component_type)
+{
+    switch (component_type)
+    {
+        case COMPONENT_UNSIGNED_BYTE:
+            return data[0];
+        case COMPONENT_UNSIGNED_SHORT:
+        {
+            uint16_t value;
+            std::memcpy(&value, data, sizeof value);
+            return value;
+        }
+        case COMPONENT_UNSIGNED_INT:
+            return read_u32(data);
+        default:
+            return UINT32_MAX;
+    }
+}
+
+class Document
+{
+public:
+    Result<void> load(const std::filesystem::path &path)
+    {
+        std::vector<uint8_t> file;
+        if (!read_file(path, file))
+            return Error(error_view("gltf file cannot be read"));
+
+        std::string_view json_text;
+        if (file.size() >= 12 && read_u32(file.data()) == GLB_MAGIC)
+        {
+            if (read_u32(file.data() + 4) != 2)
+                return Error(error_view("glb version is not 2"));
+
+            // chunks are 4 byte aligned, JSON first then an optional BIN
+            for (size_t offset = 12; offset + 8 <= file.size();)
+            {
+                uint32_t length = read_u32(file.data() + offset);
+                uint32_t type = read_u32(file.data() + offset + 4);
+                if (offset + 8 + length > file.size())
+                    return Error(error_view("glb chunk out of range"));
+
+                const auto *chunk = file.data() + offset + 8;
+                if (type == GLB_CHUNK_JSON && _json_storage.empty())
+                    _json_storage.assign(reinterpret_cast<const char *>(chunk), length);
+                else if (type == GLB_CHUNK_BIN && _glb_bin.empty())
+                    _glb_bin.assign(chunk, chunk + length);
+
+                offset += 8 + ((length + 3) & ~3u);
+            }
+            if (_json_storage.empty())
+                return Error(error_view("glb has no json chunk"));
+            json_text = _json_storage;
+        }
+        else
+        {
+            _json_storage.assign(file.begin(), file.end());
+            json_text = _json_storage;
+        }
+
+        auto json = JsonValue::parse(json_text);
+        if (!json)
+            return Error(json.error());
+        _json = std::move(*json);
+
+        return load_buffers(path.parent_path());
+    }
+
+    Result<AccessorView> accessor(double index_value) const
+    {
+        const auto *accessors = _json.find("accessors");
+        size_t index = 0;
+        if (accessors == nullptr || !to_index(index_value, accessors->elements().size(), index))
+            return Error(error_view("gltf accessor out of range"));
+
+        const auto &accessor = accessors->elements()[index];
+        if (accessor.find("sparse") != nullptr)
+            return Error(error_view("gltf sparse accessors are not supported"));
+
+        const auto *views = _json.find("bufferViews");
+        size_t view_index = 0;
+        if (views == nullptr || !to_index(accessor.number("bufferView", -1), views->elements().size(), view_index))
+            return Error(error_view("gltf accessor without buffer view"));
+        const auto &view = views->elements()[view_index];
+
+        size_t buffer_index = 0;
+        if (!to_index(view.number("buffer", -1), _buffers.size(), buffer_index))
+            return Error(error_view("gltf buffer out of range"));
+        const auto &buffer = _buffers[buffer_index];
+
+        AccessorView result;
+        result.component_type = static_cast<uint32_t>(to_size(accessor.number("componentType", 0)));
+        const auto *type = accessor.find("type");
+        result.components = type != nullptr ? component_count(type->string()) : 0;
+        result.count = to_size(accessor.number("count", 0));
+        const auto *normalized = accessor.find("normalized");
+        result.normalized = normalized != nullptr && normalized->boolean();
+
+        size_t element_size = component_size(result.component_type) * result.components;
+        if (element_size == 0)
+            return Error(error_view("gltf accessor type not supported"));
+
+        result.stride = to_size(view.number("byteStride", 0));
+        if (result.stride == 0)
+            result.stride = element_size;
+
+        auto view_offset = to_size(view.number("byteOffset", 0));
+        auto view_length = to_size(view.number("byteLength", 0));
+        auto accessor_offset = to_size(accessor.number("byteOffset", 0));
+        if (view_offset + view_length > buffer.size() ||
+            (result.count > 0 && accessor_offset + result.stride * (result.count - 1) + element_size > view_length))
+            return Error(error_view("gltf accessor out of range"));
+
+        result.data = buffer.data() + view_offset + accessor_offset;
+        return result;
+    }
+
+    [[nodiscard]]
+    const JsonValue &json() const noexcept { return _json; }
+
+private:
+    Result<void> load_buffers(const std::filesystem::path &directory)
+    {
+        const auto *buffers = _json.find("buffers");
+        if (buffers == nullptr)
+            return {};
+
+        for (const auto &buffer : buffers->elements())
+        {
+            auto &data = _buffers.emplace_back();
+            auto byte_length = to_size(buffer.number("byteLength", 0));
+
+            const auto *uri = buffer.find("uri");
+            if (uri == nullptr)
+            {
+                // the glb's own binary chunk, only ever the first buffer
+                data = _glb_bin;
+            }
+            else if (uri->string().starts_with("data:"))
+            {
+                auto comma = uri->string().find(',');
+                if (comma == std::string::npos || uri->string().find(";base64") > comma)
+                    return Error(error_view("gltf data uri is not base64"));
+                if (!decode_base64(std::string_view(uri->string()).substr(comma + 1), data))
+                    return Error(error_view("gltf invalid base64"));
+            }
+            else if (!read_file(directory / uri->string(), data))
+            {
+                return Error(error_view("gltf buffer file cannot be read"));
+            }
+
+            if (data.size() < byte_length)
+                return Error(error_view("gltf buffer shorter than its byteLength"));
+        }
+        return {};
+    }
+
+private:
+    std::string _json_storage;
+    std::vector<uint8_t> _glb_bin;
+    JsonValue _json;
+    std::vector<std::vector<uint8_t>> _buffers;
+};
+
+} // anonymous
+
+Result<std::vector<ImportedMesh>> import_gltf(const std::filesystem::path &path)
+{
+    Document document;
+    if (auto loaded = document.load(path); !loaded)
+        return Error(loaded.error());
+
+    std::vector<ImportedMesh> meshes;
+    const auto *gltf_meshes = document.json().find("meshes");
+    if (gltf_meshes == nullptr)
+        return meshes;
+
+    for (const auto &gltf_mesh : gltf_meshes->elements())
+    {
+        auto &mesh = meshes.emplace_back();
+        if (const auto *name = gltf_mesh.find("name"))
+            mesh.name = name->string();
+
+        const auto *primitives = gltf_mesh.find("primitives");
+        if (primitives == nullptr)
+            continue;
+
+        for (const auto &primitive : primitives->elements())
+        {
+            if (primitive.number("mode", MODE_TRIANGLES) != MODE_TRIANGLES)
+                continue;
+
+            const auto *attributes = primitive.find("attributes");
+            if (attributes == nullptr || attributes->find("POSITION") == nullptr)
+                return Error(error_view("gltf primitive without POSITION"));
+
+            auto positions = document.accessor(attributes->number("POSITION", -1));
+            if (!positions)
+                return Error(positions.error());
+            if (positions->components != 3)
+                return Error(error_view("gltf POSITION is not a VEC3"));
+
+            std::optional<AccessorView> colors;
+            if (attributes->find("COLOR_0") != nullptr)
+            {
+                auto color_view = document.accessor(attributes->number("COLOR_0", -1));
+                if (!color_view)
+                    return Error(color_view.error());
+                if (color_view->components < 3 || color_view->count != positions->count)
+                    return Error(error_view("gltf COLOR_0 does not match POSITION"));
+                colors = *color_view;
+            }
+
+            // primitives of a mesh share its vertex buffer, their indices are rebased
+            auto base = static_cast<uint32_t>(mesh.vertices.size());
+            for (size_t i = 0; i < positions->count; i++)
+            {
+                assets::CookedVertex vertex = { .position = {}, .color = { 1.0f, 1.0f, 1.0f } };
+                auto component = component_size(positions->component_type);
+                const auto *position = positions->data + i * positions->stride;
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    vertex.position[c] = read_float(position + c * component, positions->component_type, positions->normalized);
+                }
+
+                if (colors)
+                {
+                    auto color_component = component_size(colors->component_type);
+                    const auto *color = colors->data + i * colors->stride;
+                    for (uint32_t c = 0; c < 3; c++)
+                    {
+                        vertex.color[c] = read_float(color + c * color_component, colors->component_type, colors->normalized);
+                    }
+                }
+                mesh.vertices.push_back(vertex);
+            }
+
+            if (primitive.find("indices") == nullptr)
+            {
+                for (size_t i = 0; i < positions->count; i++)
+                {
+                    mesh.indices.push_back(base + static_cast<uint32_t>(i));
+                }
+                continue;
+            }
+
+            auto indices = document.accessor(primitive.number("indices", -1));
+            if (!indices)
+                return Error(indices.error());
+            // the accessor bounds were checked for its component size, anything else would read past them
+            bool index_type = indices->component_type == COMPONENT_UNSIGNED_BYTE
+                    || indices->component_type == COMPONENT_UNSIGNED_SHORT
+                    || indices->component_type == COMPONENT_UNSIGNED_INT;
+            if (indices->components != 1 || !index_type)
+                return Error(error_view("gltf indices are not unsigned integers"));
+
+            for (size_t i = 0; i < indices->count; i++)
+            {
+                auto index = read_index(indices->data + i * indices->stride, indices->component_type);
+                if (index >= positions->count)
+                    return Error(error_view("gltf index out of range"));
+                mesh.indices.push_back(base + index);
+            }
+        }
+    }
+
+    std::erase_if(meshes, [](const ImportedMesh &mesh) { return mesh.indices.size() < 3; });
+    return meshes;
+}
+
+} // venture::cooker
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+#include "ImportedMesh.hpp"
+#include "error_handling/Result.hpp"
+
+namespace venture::cooker {
+
+/**
+ * glTF 2.0, .gltf with external or data uri buffers and binary .glb. One mesh per glTF mesh with its triangle
+ * primitives merged, POSITION and COLOR_0 are kept. Meshes stay in their own object space, node transforms are the
+ * scene's business and are ignored, as are sparse accessors and non triangle primitives
+ */
+[[nodiscard]]
+Result<std::vector<ImportedMesh>> import_gltf(const std::filesystem::path &path);
+
+} // venture::cooker
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "assets/MeshFormat.hpp"
+
+namespace venture::cooker {
+
+/** simplified triangle list over the same vertices as the full detail one */
+struct ImportedLod
+{
+    std::vector<uint32_t> indices;
+    float error; // object space, see assets::MeshFileLod
+};
+
+/**
+ * One mesh as an importer produced it, already in the cooked vertex layout and triangle lists. The LOD and meshlet
+ * vectors stay empty until build_lods and build_meshlets fill them
+ */
+struct ImportedMesh
+{
+    std::string name;
+    std::vector<assets::CookedVertex> vertices;
+    std::vector<uint32_t> indices; // LOD 0
+    std::vector<ImportedLod> lods; // LOD 1 onwards, coarser each
+
+    std::vector<assets::CookedMeshlet> meshlets;
+    std::vector<uint32_t> meshlet_vertices;
+    std::vector<uint8_t> meshlet_triangles;
+};
+
+} // venture::cooker
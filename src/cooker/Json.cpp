@@ -0,0 +1,273 @@
+#include "Json.hpp"
+#include <charconv>
+
+namespace venture::cooker {
+
+namespace {
+
+constexpr uint32_t MAX_DEPTH = 256;
+
+void append_utf8(std::string &out, uint32_t code_point)
+{
+    if (code_point < 0x80)
+    {
+        out += static_cast<char>(code_point);
+    }
+    else if (code_point < 0x800)
+    {
+        out += static_cast<char>(0xC0 | (code_point >> 6));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else if (code_point < 0x10000)
+    {
+        out += static_cast<char>(0xE0 | (code_point >> 12));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else
+    {
+        out += static_cast<char>(0xF0 | (code_point >> 18));
+        out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+} // anonymous
+
+/** recursive descent over the text, every parse_ function leaves _pos after what it consumed */
+class JsonValue::Parser
+{
+public:
+    explicit Parser(std::string_view text) : _text(text) {}
+
+    Result<JsonValue> parse_document()
+    {
+        JsonValue value;
+        if (!parse_value(value, 0))
+            return Error(error_view(_error));
+
+        skip_whitespace();
+        if (_pos != _text.size())
+            return Error(error_view("json trailing characters"));
+        return value;
+    }
+
+private:
+    bool fail(const char *error)
+    {
+        _error = error;
+        return false;
+    }
+
+    void skip_whitespace()
+    {
+        while (_pos < _text.size() &&
+               (_text[_pos] == ' ' || _text[_pos] == '\t' || _text[_pos] == '\n' || _text[_pos] == '\r'))
+            _pos++;
+    }
+
+    bool consume(std::string_view literal)
+    {
+        if (_text.substr(_pos, literal.size()) != literal)
+            return false;
+        _pos += literal.size();
+        return true;
+    }
+
+    bool parse_value(JsonValue &value, uint32_t depth)
+    {
+        if (depth > MAX_DEPTH)
+            return fail("json nested too deep");
+
+        skip_whitespace();
+        if (_pos >= _text.size())
+            return fail("json unexpected end");
+
+        switch (_text[_pos])
+        {
+            case '{':
+                return parse_object(value, depth);
+            case '[':
+                return parse_array(value, depth);
+            case '"':
+                value._type = Type::eString;
+                return parse_string(value._string);
+            case 't':
+                value._type = Type::eBool;
+                value._bool = true;
+                return consume("true") || fail("json invalid literal");
+            case 'f':
+                value._type = Type::eBool;
+                value._bool = false;
+                return consume("false") || fail("json invalid literal");
+            case 'n':
+                value._type = Type::eNull;
+                return consume("null") || fail("json invalid literal");
+            default:
+                value._type = Type::eNumber;
+                return parse_number(value._number);
+        }
+    }
+
+    bool parse_object(JsonValue &value, uint32_t depth)
+    {
+        value._type = Type::eObject;
+        _pos++; // {
+
+        skip_whitespace();
+        if (consume("}"))
+            return true;
+
+        while (true)
+        {
+            skip_whitespace();
+            std::string key;
+            if (_pos >= _text.size() || _text[_pos] != '"' || !parse_string(key))
+                return fail("json expected member name");
+
+            skip_whitespace();
+            if (!consume(":"))
+                return fail("json expected ':'");
+
+            value._keys.push_back(std::move(key));
+            if (!parse_value(value._elements.emplace_back(), depth + 1))
+                return false;
+
+            skip_whitespace();
+            if (consume("}"))
+                return true;
+            if (!consume(","))
+                return fail("json expected ',' or '}'");
+        }
+    }
+
+    bool parse_array(JsonValue &value, uint32_t depth)
+    {
+        value._type = Type::eArray;
+        _pos++; // [
+
+        skip_whitespace();
+        if (consume("]"))
+            return true;
+
+        while (true)
+        {
+            if (!parse_value(value._elements.emplace_back(), depth + 1))
+                return false;
+
+            skip_whitespace();
+            if (consume("]"))
+                return true;
+            if (!consume(","))
+                return fail("json expected ',' or ']'");
+        }
+    }
+
+    bool parse_string(std::string &out)
+    {
+        _pos++; // "
+
+        while (_pos < _text.size())
+        {
+            char c = _text[_pos++];
+            if (c == '"')
+                return true;
+            if (c != '\\')
+            {
+                out += c;
+                continue;
+            }
+
+            if (_pos >= _text.size())
+                break;
+
+            switch (_text[_pos++])
+            {
+                case '"':  out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/':  out += '/'; break;
+                case 'b':  out += '\b'; break;
+                case 'f':  out += '\f'; break;
+                case 'n':  out += '\n'; break;
+                case 'r':  out += '\r'; break;
+                case 't':  out += '\t'; break;
+                case 'u':
+                {
+                    uint32_t code_point = 0;
+                    if (!parse_hex4(code_point))
+                        return fail("json invalid unicode escape");
+
+                    // high surrogate followed by its low half
+                    if (code_point >= 0xD800 && code_point < 0xDC00 && consume("\\u"))
+                    {
+                        uint32_t low = 0;
+                        if (!parse_hex4(low) || low < 0xDC00 || low >= 0xE000)
+                            return fail("json invalid surrogate pair");
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    append_utf8(out, code_point);
+                    break;
+                }
+                default:
+                    return fail("json invalid escape");
+            }
+        }
+
+        return fail("json unterminated string");
+    }
+
+    bool parse_hex4(uint32_t &code_point)
+    {
+        if (_pos + 4 > _text.size())
+            return false;
+
+        auto [end, ec] = std::from_chars(_text.data() + _pos, _text.data() + _pos + 4, code_point, 16);
+        if (ec != std::errc() || end != _text.data() + _pos + 4)
+            return false;
+
+        _pos += 4;
+        return true;
+    }
+
+    bool parse_number(double &number)
+    {
+        auto [end, ec] = std::from_chars(_text.data() + _pos, _text.data() + _text.size(), number);
+        if (ec != std::errc())
+            return fail("json invalid number");
+
+        _pos = static_cast<size_t>(end - _text.data());
+        return true;
+    }
+
+private:
+    std::string_view _text;
+    size_t _pos = 0;
+    const char *_error = "";
+};
+
+Result<JsonValue> JsonValue::parse(std::string_view text)
+{
+    return Parser(text).parse_document();
+}
+
+const JsonValue *JsonValue::find(std::string_view key) const noexcept
+{
+    if (_type != Type::eObject)
+        return nullptr;
+
+    for (size_t i = 0; i < _keys.size(); i++)
+    {
+        if (_keys[i] == key)
+            return &_elements[i];
+    }
+    return nullptr;
+}
+
+double JsonValue::number(std::string_view key, double fallback) const noexcept
+{
+    const auto *member = find(key);
+    return member != nullptr && member->_type == Type::eNumber ? member->_number : fallback;
+}
+
+} // venture::cooker
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "error_handling/Result.hpp"
+
+namespace venture::cooker {
+
+/** Parsed JSON document, just enough of RFC 8259 for glTF. Objects keep their members in file order */
+class JsonValue
+{
+public:
+    enum class Type
+    {
+        eNull,
+        eBool,
+        eNumber,
+        eString,
+        eArray,
+        eObject,
+    };
+
+    [[nodiscard]]
+    static Result<JsonValue> parse(std::string_view text);
+
+    /** member of an object, null when missing or not an object */
+    [[nodiscard]]
+    const JsonValue *find(std::string_view key) const noexcept;
+    /** number of a member, fallback when missing or not a number */
+    [[nodiscard]]
+    double number(std::string_view key, double fallback) const noexcept;
+
+    [[nodiscard]]
+    inline Type type() const noexcept;
+    [[nodiscard]]
+    inline bool boolean() const noexcept;
+    [[nodiscard]]
+    inline double number() const noexcept;
+    [[nodiscard]]
+    inline const std::string &string() const noexcept;
+    /** elements of an array, values of an object */
+    [[nodiscard]]
+    inline const std::vector<JsonValue> &elements() const noexcept;
+
+private:
+    class Parser;
+
+    Type _type = Type::eNull;
+    bool _bool = false;
+    double _number = 0.0;
+    std::string _string;
+    std::vector<std::string> _keys; // object only, parallel to _elements
+    std::vector<JsonValue> _elements;
+};
+
+JsonValue::Type JsonValue::type() const noexcept { return _type; }
+bool JsonValue::boolean() const noexcept { return _bool; }
+double JsonValue::number() const noexcept { return _number; }
+const std::string &JsonValue::string() const noexcept { return _string; }
+const std::vector<JsonValue> &JsonValue::elements() const noexcept { return _elements; }
+
+} // venture::cooker
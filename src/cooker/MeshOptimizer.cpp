@@ -0,0 +1,365 @@
+#include "MeshOptimizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace venture::cooker {
+
+namespace {
+
+//--- Forsyth scoring, the constants of the original paper
+constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+float vertex_score(int32_t cache_position, uint32_t remaining_triangles)
+{
+    if (remaining_triangles == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cache_position >= 0)
+    {
+        // the last triangle's vertices get a fixed score, emitting a neighbour of it hits the cache either way
+        if (cache_position < 3)
+            score = LAST_TRIANGLE_SCORE;
+        else
+            score = std::pow(1.0f - float(cache_position - 3) / float(FORSYTH_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+    }
+    // vertices with few triangles left are finished first so they stop occupying the cache
+    return score + VALENCE_BOOST_SCALE * std::pow(float(remaining_triangles), -VALENCE_BOOST_POWER);
+}
+
+/** FIFO cache over a span of triangles, flush() starts cold the way a new draw would */
+class CacheSimulator
+{
+public:
+    explicit CacheSimulator(size_t vertex_count) : _timestamps(vertex_count, 0) {}
+
+    void flush() noexcept { _time += VERTEX_CACHE_SIZE + 1; }
+
+    uint32_t misses(const uint32_t *triangle) noexcept
+    {
+        uint32_t misses = 0;
+        for (int k = 0; k < 3; k++)
+        {
+            uint32_t &timestamp = _timestamps[triangle[k]];
+            if (_time - timestamp > VERTEX_CACHE_SIZE)
+            {
+                timestamp = _time++;
+                misses++;
+            }
+        }
+        return misses;
+    }
+
+private:
+    std::vector<uint32_t> _timestamps;
+    uint32_t _time = VERTEX_CACHE_SIZE + 1;
+};
+
+struct Cluster
+{
+    uint32_t first_triangle;
+    uint32_t triangle_count;
+    float sort_key;
+};
+
+void triangle_geometry(std::span<const assets::CookedVertex> vertices, const uint32_t *triangle,
+                       float centroid[3], float normal[3])
+{
+    const float *p0 = vertices[triangle[0]].position;
+    const float *p1 = vertices[triangle[1]].position;
+    const float *p2 = vertices[triangle[2]].position;
+    float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+
+    // not normalized, the length is twice the area and weights the cluster sums
+    normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    for (int c = 0; c < 3; c++)
+        centroid[c] = (p0[c] + p1[c] + p2[c]) / 3.0f;
+}
+
+} // anonymous
+
+VertexCacheStats analyze_vertex_cache(std::span<const uint32_t> indices, size_t vertex_count, uint32_t cache_size)
+{
+    std::vector<uint32_t> timestamps(vertex_count, 0);
+    uint32_t time = cache_size + 1;
+    size_t misses = 0;
+    for (uint32_t index : indices)
+    {
+        if (time - timestamps[index] > cache_size)
+        {
+            timestamps[index] = time++;
+            misses++;
+        }
+    }
+
+    size_t triangle_count = indices.size() / 3;
+    return {
+            .acmr = triangle_count != 0 ? float(misses) / float(triangle_count) : 0.0f,
+            .atvr = vertex_count != 0 ? float(misses) / float(vertex_count) : 0.0f,
+    };
+}
+
+void optimize_vertex_cache(std::span<uint32_t> indices, size_t vertex_count)
+{
+    size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0)
+        return;
+
+    //--- Adjacency
+    // triangles of every vertex, the live ones first, emitted triangles are swapped past remaining[vertex]
+    std::vector<uint32_t> remaining(vertex_count, 0);
+    for (uint32_t index : indices)
+        remaining[index]++;
+
+    std::vector<uint32_t> first(vertex_count + 1, 0);
+    for (size_t v = 0; v < vertex_count; v++)
+        first[v + 1] = first[v] + remaining[v];
+
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(first.begin(), first.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    //--- Scores
+    std::vector<int32_t> cache_position(vertex_count, -1);
+    std::vector<float> scores(vertex_count);
+    for (size_t v = 0; v < vertex_count; v++)
+        scores[v] = vertex_score(-1, remaining[v]);
+
+    std::vector<float> triangle_scores(triangle_count);
+    std::vector<bool> emitted(triangle_count, false);
+    for (size_t t = 0; t < triangle_count; t++)
+        triangle_scores[t] = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+
+    //--- Emit
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+    uint32_t cache_count = 0;
+    size_t next_unemitted = 0;
+
+    while (result.size() < indices.size())
+    {
+        // the best triangle touching the cache, those are the only scores that changed
+        int64_t best = -1;
+        float best_score = -1.0f;
+        for (uint32_t i = 0; i < cache_count; i++)
+        {
+            uint32_t v = cache[i];
+            for (uint32_t a = first[v]; a < first[v] + remaining[v]; a++)
+            {
+                uint32_t t = adjacency[a];
+                if (triangle_scores[t] > best_score)
+                {
+                    best = t;
+                    best_score = triangle_scores[t];
+                }
+            }
+        }
+
+        // dead end, restart at the next triangle in input order
+        if (best < 0)
+        {
+            while (emitted[next_unemitted])
+                next_unemitted++;
+            best = static_cast<int64_t>(next_unemitted);
+        }
+
+        const uint32_t *triangle = &indices[static_cast<size_t>(best) * 3];
+        emitted[best] = true;
+        result.insert(result.end(), triangle, triangle + 3);
+
+        for (int k = 0; k < 3; k++)
+        {
+            uint32_t v = triangle[k];
+            auto begin = adjacency.begin() + first[v];
+            auto end = begin + remaining[v];
+            std::iter_swap(std::find(begin, end, static_cast<uint32_t>(best)), end - 1);
+            remaining[v]--;
+        }
+
+        // the triangle's vertices move to the front, everything else shifts back and may fall out
+        uint32_t next_cache[FORSYTH_CACHE_SIZE + 3];
+        uint32_t next_count = 0;
+        for (int k = 0; k < 3; k++)
+        {
+            if (std::find(next_cache, next_cache + next_count, triangle[k]) == next_cache + next_count)
+                next_cache[next_count++] = triangle[k];
+        }
+        for (uint32_t i = 0; i < cache_count; i++)
+        {
+            if (std::find(next_cache, next_cache + next_count, cache[i]) == next_cache + next_count)
+                next_cache[next_count++] = cache[i];
+        }
+
+        for (uint32_t i = 0; i < next_count; i++)
+        {
+            uint32_t v = next_cache[i];
+            cache_position[v] = i < FORSYTH_CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+            scores[v] = vertex_score(cache_position[v], remaining[v]);
+        }
+        for (uint32_t i = 0; i < next_count; i++)
+        {
+            uint32_t v = next_cache[i];
+            for (uint32_t a = first[v]; a < first[v] + remaining[v]; a++)
+            {
+                uint32_t t = adjacency[a];
+                triangle_scores[t] = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+            }
+        }
+
+        cache_count = std::min(next_count, FORSYTH_CACHE_SIZE);
+        std::copy(next_cache, next_cache + cache_count, cache);
+    }
+
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void optimize_overdraw(std::span<uint32_t> indices, std::span<const assets::CookedVertex> vertices, float threshold)
+{
+    auto triangle_count = static_cast<uint32_t>(indices.size() / 3);
+    if (triangle_count == 0)
+        return;
+
+    CacheSimulator cache(vertices.size());
+
+    //--- Hard boundaries
+    // where every vertex of a triangle misses, the cache optimizer restarted and reordering costs nothing
+    std::vector<uint32_t> hard_starts;
+    for (uint32_t t = 0; t < triangle_count; t++)
+    {
+        uint32_t misses = cache.misses(&indices[t * 3]);
+        if (t == 0 || misses == 3)
+            hard_starts.push_back(t);
+    }
+    hard_starts.push_back(triangle_count);
+
+    //--- Soft boundaries
+    // split a hard cluster wherever the part so far stays within threshold of the whole cluster's ACMR
+    std::vector<Cluster> clusters;
+    for (size_t h = 0; h + 1 < hard_starts.size(); h++)
+    {
+        uint32_t begin = hard_starts[h];
+        uint32_t end = hard_starts[h + 1];
+
+        cache.flush();
+        uint32_t cluster_misses = 0;
+        for (uint32_t t = begin; t < end; t++)
+            cluster_misses += cache.misses(&indices[t * 3]);
+        float cluster_threshold = threshold * float(cluster_misses) / float(end - begin);
+
+        cache.flush();
+        uint32_t start = begin;
+        uint32_t misses = 0;
+        for (uint32_t t = begin; t < end; t++)
+        {
+            misses += cache.misses(&indices[t * 3]);
+            if (t + 1 < end && float(misses) <= float(t + 1 - start) * cluster_threshold)
+            {
+                clusters.push_back({ .first_triangle = start, .triangle_count = t + 1 - start, .sort_key = 0.0f });
+                start = t + 1;
+                misses = 0;
+                cache.flush();
+            }
+        }
+        clusters.push_back({ .first_triangle = start, .triangle_count = end - start, .sort_key = 0.0f });
+    }
+
+    //--- Sort
+    // by how far a cluster faces out of the mesh's center, front of the mesh first
+    float mesh_centroid[3] = {};
+    float mesh_area = 0.0f;
+    for (uint32_t t = 0; t < triangle_count; t++)
+    {
+        float centroid[3], normal[3];
+        triangle_geometry(vertices, &indices[t * 3], centroid, normal);
+        float area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        for (int c = 0; c < 3; c++)
+            mesh_centroid[c] += centroid[c] * area;
+        mesh_area += area;
+    }
+    for (float &c : mesh_centroid)
+        c = mesh_area > 0.0f ? c / mesh_area : 0.0f;
+
+    for (auto &cluster : clusters)
+    {
+        float cluster_centroid[3] = {};
+        float cluster_normal[3] = {};
+        float cluster_area = 0.0f;
+        for (uint32_t t = cluster.first_triangle; t < cluster.first_triangle + cluster.triangle_count; t++)
+        {
+            float centroid[3], normal[3];
+            triangle_geometry(vertices, &indices[t * 3], centroid, normal);
+            float area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            for (int c = 0; c < 3; c++)
+            {
+                cluster_centroid[c] += centroid[c] * area;
+                cluster_normal[c] += normal[c];
+            }
+            cluster_area += area;
+        }
+
+        float normal_length = std::sqrt(cluster_normal[0] * cluster_normal[0] + cluster_normal[1] * cluster_normal[1] +
+                                        cluster_normal[2] * cluster_normal[2]);
+        if (cluster_area <= 0.0f || normal_length <= 0.0f)
+            continue;
+
+        for (int c = 0; c < 3; c++)
+        {
+            float offset = cluster_centroid[c] / cluster_area - mesh_centroid[c];
+            cluster.sort_key += offset * cluster_normal[c] / normal_length;
+        }
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster &a, const Cluster &b) {
+        return a.sort_key > b.sort_key;
+    });
+
+    //--- Emit
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (const auto &cluster : clusters)
+    {
+        auto begin = indices.begin() + cluster.first_triangle * 3;
+        result.insert(result.end(), begin, begin + cluster.triangle_count * 3);
+    }
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void optimize_vertex_fetch(ImportedMesh &mesh)
+{
+    std::vector<uint32_t> remap(mesh.vertices.size(), UINT32_MAX);
+    std::vector<assets::CookedVertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+
+    for (uint32_t &index : mesh.indices)
+    {
+        if (remap[index] == UINT32_MAX)
+        {
+            remap[index] = static_cast<uint32_t>(vertices.size());
+            vertices.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices = std::move(vertices);
+}
+
+void optimize_mesh(ImportedMesh &mesh)
+{
+    optimize_vertex_cache(mesh.indices, mesh.vertices.size());
+    optimize_overdraw(mesh.indices, mesh.vertices);
+    optimize_vertex_fetch(mesh);
+}
+
+} // venture::cooker
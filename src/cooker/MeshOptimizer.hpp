@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "ImportedMesh.hpp"
+
+namespace venture::cooker {
+
+/** FIFO size the statistics and the overdraw clustering simulate, the common size of post-transform caches */
+constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+/** within 5% of the cache optimized ACMR, what the overdraw optimizer may give up to reorder clusters */
+constexpr float OVERDRAW_THRESHOLD = 1.05f;
+
+struct VertexCacheStats
+{
+    float acmr; // average cache miss ratio, vertex shader invocations per triangle, 0.5 at best for a regular grid
+    float atvr; // average transformed vertex ratio, invocations per vertex, 1 at best
+};
+
+/** simulates a FIFO post-transform cache of cache_size entries over the triangle list */
+[[nodiscard]]
+VertexCacheStats analyze_vertex_cache(std::span<const uint32_t> indices, size_t vertex_count,
+                                      uint32_t cache_size = VERTEX_CACHE_SIZE);
+
+/** reorders triangles for post-transform cache hits, Forsyth's linear speed vertex cache optimization */
+void optimize_vertex_cache(std::span<uint32_t> indices, size_t vertex_count);
+
+/**
+ * Reorders the clusters a cache optimized triangle list splits into so outward facing clusters draw first, they are
+ * the likely occluders. Clusters are split until the list's ACMR grows by threshold at most. Triangle normals follow
+ * cross(b - a, c - a)
+ */
+void optimize_overdraw(std::span<uint32_t> indices, std::span<const assets::CookedVertex> vertices,
+                       float threshold = OVERDRAW_THRESHOLD);
+
+/** reorders vertices to the order the indices first reference them in and drops unreferenced ones */
+void optimize_vertex_fetch(ImportedMesh &mesh);
+
+/**
+ * Runs the vertex cache, overdraw and vertex fetch optimizations in that order, the order they depend on each other.
+ * Meshlets are built afterwards, they index the reordered vertices
+ */
+void optimize_mesh(ImportedMesh &mesh);
+
+} // venture::cooker
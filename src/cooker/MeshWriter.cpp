@@ -0,0 +1,173 @@
+#include "MeshWriter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+namespace venture::cooker {
+
+namespace {
+
+uint64_t align_up(uint64_t value)
+{
+    return (value + assets::MESH_FILE_ALIGNMENT - 1) & ~(assets::MESH_FILE_ALIGNMENT - 1);
+}
+
+// same sphere the renderer builds for meshes created at runtime, see vulkan::Mesh::create
+void compute_bounds(const ImportedMesh &mesh, float bounds[4])
+{
+    float min_corner[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+    float max_corner[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+    for (const auto &vertex : mesh.vertices)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            min_corner[c] = std::min(min_corner[c], vertex.position[c]);
+            max_corner[c] = std::max(max_corner[c], vertex.position[c]);
+        }
+    }
+
+    float radius_squared = 0.0f;
+    for (int c = 0; c < 3; c++)
+    {
+        bounds[c] = (min_corner[c] + max_corner[c]) * 0.5f;
+    }
+    for (const auto &vertex : mesh.vertices)
+    {
+        float dx = vertex.position[0] - bounds[0];
+        float dy = vertex.position[1] - bounds[1];
+        float dz = vertex.position[2] - bounds[2];
+        radius_squared = std::max(radius_squared, dx * dx + dy * dy + dz * dz);
+    }
+    bounds[3] = std::sqrt(radius_squared);
+}
+
+} // anonymous
+
+Result<void> write_mesh_file(const std::filesystem::path &path, std::span<const ImportedMesh> meshes)
+{
+    //--- Layout
+    std::vector<assets::MeshFileEntry> entries;
+    entries.reserve(meshes.size());
+
+    // LOD 0 and the simplified levels back to back, the table says where each starts
+    std::vector<std::vector<uint32_t>> indices(meshes.size());
+    std::vector<std::vector<assets::MeshFileLod>> lods(meshes.size());
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        lods[i].push_back({
+                .first_index = 0,
+                .index_count = static_cast<uint32_t>(meshes[i].indices.size()),
+                .error = 0.0f,
+                .reserved = 0,
+        });
+        indices[i] = meshes[i].indices;
+        for (const auto &lod : meshes[i].lods)
+        {
+            lods[i].push_back({
+                    .first_index = static_cast<uint32_t>(indices[i].size()),
+                    .index_count = static_cast<uint32_t>(lod.indices.size()),
+                    .error = lod.error,
+                    .reserved = 0,
+            });
+            indices[i].insert(indices[i].end(), lod.indices.begin(), lod.indices.end());
+        }
+    }
+
+    uint64_t offset = sizeof(assets::MeshFileHeader) + meshes.size() * sizeof(assets::MeshFileEntry);
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        const auto &mesh = meshes[i];
+        if (mesh.vertices.empty() || mesh.indices.empty() || mesh.indices.size() % 3 != 0)
+            return Error(error_view("mesh is not a non empty triangle list"));
+        if (mesh.vertices.size() > UINT32_MAX || indices[i].size() > UINT32_MAX)
+            return Error(error_view("mesh too large for 32 bit indices"));
+        if (lods[i].size() > assets::MESH_MAX_LODS)
+            return Error(error_view("mesh has too many lods"));
+        if (mesh.meshlet_triangles.size() % 3 != 0)
+            return Error(error_view("meshlet triangles are not index triples"));
+
+        auto &entry = entries.emplace_back();
+        compute_bounds(mesh, entry.bounds);
+        entry.vertex_offset = align_up(offset);
+        entry.vertex_count = static_cast<uint32_t>(mesh.vertices.size());
+        offset = entry.vertex_offset + mesh.vertices.size() * sizeof(assets::CookedVertex);
+        entry.index_offset = align_up(offset);
+        entry.index_count = static_cast<uint32_t>(indices[i].size());
+        offset = entry.index_offset + indices[i].size() * sizeof(uint32_t);
+        entry.lod_offset = align_up(offset);
+        entry.lod_count = static_cast<uint32_t>(lods[i].size());
+        offset = entry.lod_offset + lods[i].size() * sizeof(assets::MeshFileLod);
+
+        entry.meshlet_offset = align_up(offset);
+        entry.meshlet_count = static_cast<uint32_t>(mesh.meshlets.size());
+        offset = entry.meshlet_offset + mesh.meshlets.size() * sizeof(assets::CookedMeshlet);
+        entry.meshlet_vertex_offset = align_up(offset);
+        entry.meshlet_vertex_count = static_cast<uint32_t>(mesh.meshlet_vertices.size());
+        offset = entry.meshlet_vertex_offset + mesh.meshlet_vertices.size() * sizeof(uint32_t);
+        entry.meshlet_triangle_offset = align_up(offset);
+        entry.meshlet_triangle_count = static_cast<uint32_t>(mesh.meshlet_triangles.size() / 3);
+        offset = entry.meshlet_triangle_offset + mesh.meshlet_triangles.size();
+    }
+
+    assets::MeshFileHeader header = {
+            .magic = assets::MESH_FILE_MAGIC,
+            .version = assets::MESH_FILE_VERSION,
+            .mesh_count = static_cast<uint32_t>(meshes.size()),
+            .vertex_stride = sizeof(assets::CookedVertex),
+            .file_size = offset,
+    };
+
+    //--- Write
+    // next to the target and renamed, a failed cook never leaves a torn file for the runtime to map
+    auto tmp_path = path;
+    tmp_path += ".tmp";
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc); // raii
+        if (!ofs.is_open())
+            return Error(error_view("output cannot be written"));
+
+        auto pad_to = [&ofs](uint64_t target) {
+            static constexpr char zeros[assets::MESH_FILE_ALIGNMENT] = {};
+            auto padding = target - static_cast<uint64_t>(ofs.tellp());
+            ofs.write(zeros, static_cast<std::streamsize>(padding));
+        };
+
+        ofs.write(reinterpret_cast<const char *>(&header), sizeof header);
+        ofs.write(reinterpret_cast<const char *>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(assets::MeshFileEntry)));
+        for (size_t i = 0; i < meshes.size(); i++)
+        {
+            pad_to(entries[i].vertex_offset);
+            ofs.write(reinterpret_cast<const char *>(meshes[i].vertices.data()),
+                      static_cast<std::streamsize>(meshes[i].vertices.size() * sizeof(assets::CookedVertex)));
+            pad_to(entries[i].index_offset);
+            ofs.write(reinterpret_cast<const char *>(indices[i].data()),
+                      static_cast<std::streamsize>(indices[i].size() * sizeof(uint32_t)));
+            pad_to(entries[i].lod_offset);
+            ofs.write(reinterpret_cast<const char *>(lods[i].data()),
+                      static_cast<std::streamsize>(lods[i].size() * sizeof(assets::MeshFileLod)));
+            pad_to(entries[i].meshlet_offset);
+            ofs.write(reinterpret_cast<const char *>(meshes[i].meshlets.data()),
+                      static_cast<std::streamsize>(meshes[i].meshlets.size() * sizeof(assets::CookedMeshlet)));
+            pad_to(entries[i].meshlet_vertex_offset);
+            ofs.write(reinterpret_cast<const char *>(meshes[i].meshlet_vertices.data()),
+                      static_cast<std::streamsize>(meshes[i].meshlet_vertices.size() * sizeof(uint32_t)));
+            pad_to(entries[i].meshlet_triangle_offset);
+            ofs.write(reinterpret_cast<const char *>(meshes[i].meshlet_triangles.data()),
+                      static_cast<std::streamsize>(meshes[i].meshlet_triangles.size()));
+        }
+
+        if (!ofs.good())
+            return Error(error_view("output cannot be written"));
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec)
+        return Error(error_view("output cannot be replaced"));
+
+    return {};
+}
+
+} // venture::cooker
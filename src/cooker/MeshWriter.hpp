@@ -0,0 +1,14 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include "ImportedMesh.hpp"
+#include "error_handling/Result.hpp"
+
+namespace venture::cooker {
+
+/** writes the cooked mesh file described in assets/MeshFormat.hpp, replacing path only once it is complete */
+[[nodiscard]]
+Result<void> write_mesh_file(const std::filesystem::path &path, std::span<const ImportedMesh> meshes);
+
+} // venture::cooker
@@ -0,0 +1,147 @@
+#include "Meshlets.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace venture::cooker {
+
+namespace {
+
+static_assert(assets::MESHLET_MAX_VERTICES < UINT8_MAX, "local indices are uint8 with UINT8_MAX as unused");
+
+// below this the normals spread over more than ~84 degrees and the cone would hardly ever cull
+constexpr float MIN_CONE_SPREAD = 0.1f;
+
+void compute_meshlet_bounds(const ImportedMesh &mesh, assets::CookedMeshlet &meshlet)
+{
+    //--- Sphere
+    // box center and the farthest vertex, the same sphere the mesh bounds use
+    float min_corner[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+    float max_corner[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+    for (uint32_t i = 0; i < meshlet.vertex_count; i++)
+    {
+        const float *position = mesh.vertices[mesh.meshlet_vertices[meshlet.vertex_offset + i]].position;
+        for (int c = 0; c < 3; c++)
+        {
+            min_corner[c] = std::min(min_corner[c], position[c]);
+            max_corner[c] = std::max(max_corner[c], position[c]);
+        }
+    }
+
+    float radius_squared = 0.0f;
+    for (int c = 0; c < 3; c++)
+        meshlet.center[c] = (min_corner[c] + max_corner[c]) * 0.5f;
+    for (uint32_t i = 0; i < meshlet.vertex_count; i++)
+    {
+        const float *position = mesh.vertices[mesh.meshlet_vertices[meshlet.vertex_offset + i]].position;
+        float dx = position[0] - meshlet.center[0];
+        float dy = position[1] - meshlet.center[1];
+        float dz = position[2] - meshlet.center[2];
+        radius_squared = std::max(radius_squared, dx * dx + dy * dy + dz * dz);
+    }
+    meshlet.radius = std::sqrt(radius_squared);
+
+    //--- Cone
+    // axis is the average triangle normal, the cutoff comes from the normal farthest from it
+    float normals[assets::MESHLET_MAX_TRIANGLES][3];
+    uint32_t normal_count = 0;
+    float axis[3] = {};
+    for (uint32_t t = 0; t < meshlet.triangle_count; t++)
+    {
+        const uint8_t *local = &mesh.meshlet_triangles[(meshlet.triangle_offset + t) * 3];
+        const float *p0 = mesh.vertices[mesh.meshlet_vertices[meshlet.vertex_offset + local[0]]].position;
+        const float *p1 = mesh.vertices[mesh.meshlet_vertices[meshlet.vertex_offset + local[1]]].position;
+        const float *p2 = mesh.vertices[mesh.meshlet_vertices[meshlet.vertex_offset + local[2]]].position;
+        float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+        float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+        float normal[3] = {
+                e1[1] * e2[2] - e1[2] * e2[1],
+                e1[2] * e2[0] - e1[0] * e2[2],
+                e1[0] * e2[1] - e1[1] * e2[0],
+        };
+        float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (length <= 0.0f)
+            continue; // degenerate, faces nowhere
+
+        for (int c = 0; c < 3; c++)
+        {
+            normals[normal_count][c] = normal[c] / length;
+            axis[c] += normals[normal_count][c];
+        }
+        normal_count++;
+    }
+
+    float axis_length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    float min_dot = 1.0f;
+    if (axis_length > 0.0f)
+    {
+        for (float &c : axis)
+            c /= axis_length;
+        for (uint32_t n = 0; n < normal_count; n++)
+            min_dot = std::min(min_dot, normals[n][0] * axis[0] + normals[n][1] * axis[1] + normals[n][2] * axis[2]);
+    }
+
+    std::copy(axis, axis + 3, meshlet.cone_axis);
+    if (axis_length <= 0.0f || min_dot <= MIN_CONE_SPREAD)
+    {
+        meshlet.cone_cutoff = 1.0f;
+        return;
+    }
+    // backfacing once the view direction is more than 90 degrees from every normal, the cone widened by 90 degrees
+    meshlet.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+}
+
+} // anonymous
+
+void build_meshlets(ImportedMesh &mesh)
+{
+    mesh.meshlets.clear();
+    mesh.meshlet_vertices.clear();
+    mesh.meshlet_triangles.clear();
+
+    std::vector<uint8_t> local(mesh.vertices.size(), UINT8_MAX);
+    assets::CookedMeshlet meshlet = {};
+
+    auto finish = [&]() {
+        if (meshlet.triangle_count == 0)
+            return;
+        for (uint32_t i = 0; i < meshlet.vertex_count; i++)
+            local[mesh.meshlet_vertices[meshlet.vertex_offset + i]] = UINT8_MAX;
+        compute_meshlet_bounds(mesh, meshlet);
+        mesh.meshlets.push_back(meshlet);
+        meshlet = {};
+        meshlet.vertex_offset = static_cast<uint32_t>(mesh.meshlet_vertices.size());
+        meshlet.triangle_offset = static_cast<uint32_t>(mesh.meshlet_triangles.size() / 3);
+    };
+
+    for (size_t i = 0; i < mesh.indices.size(); i += 3)
+    {
+        const uint32_t *triangle = &mesh.indices[i];
+        uint32_t new_vertices = 0;
+        for (int k = 0; k < 3; k++)
+        {
+            bool repeated = (k > 0 && triangle[k] == triangle[0]) || (k > 1 && triangle[k] == triangle[1]);
+            if (local[triangle[k]] == UINT8_MAX && !repeated)
+                new_vertices++;
+        }
+
+        if (meshlet.vertex_count + new_vertices > assets::MESHLET_MAX_VERTICES ||
+            meshlet.triangle_count == assets::MESHLET_MAX_TRIANGLES)
+            finish();
+
+        for (int k = 0; k < 3; k++)
+        {
+            uint32_t vertex = triangle[k];
+            if (local[vertex] == UINT8_MAX)
+            {
+                local[vertex] = static_cast<uint8_t>(meshlet.vertex_count++);
+                mesh.meshlet_vertices.push_back(vertex);
+            }
+            mesh.meshlet_triangles.push_back(local[vertex]);
+        }
+        meshlet.triangle_count++;
+    }
+    finish();
+}
+
+} // venture::cooker
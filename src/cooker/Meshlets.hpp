@@ -0,0 +1,14 @@
+#pragma once
+
+#include "ImportedMesh.hpp"
+
+namespace venture::cooker {
+
+/**
+ * Splits the mesh's triangle list into meshlets of at most MESHLET_MAX_VERTICES vertices and MESHLET_MAX_TRIANGLES
+ * triangles, in index order, so run it after optimize_mesh. Each meshlet gets a bounding sphere and a normal cone
+ * for per cluster culling, see assets::CookedMeshlet
+ */
+void build_meshlets(ImportedMesh &mesh);
+
+} // venture::cooker
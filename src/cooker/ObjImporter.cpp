@@ -0,0 +1,132 @@
+#include "ObjImporter.hpp"
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+
+namespace venture::cooker {
+
+namespace {
+
+std::string_view next_token(std::string_view &line)
+{
+    auto begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string_view::npos)
+    {
+        line = {};
+        return {};
+    }
+
+    auto end = line.find_first_of(" \t\r", begin);
+    auto token = line.substr(begin, end - begin);
+    line = end == std::string_view::npos ? std::string_view() : line.substr(end);
+    return token;
+}
+
+bool parse_float(std::string_view token, float &value)
+{
+    auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+    return ec == std::errc() && end == token.data() + token.size();
+}
+
+/** the position part of v, v/vt, v//vn or v/vt/vn, negative indices count back from the last vertex */
+bool parse_face_index(std::string_view token, size_t vertex_count, uint32_t &index)
+{
+    token = token.substr(0, token.find('/'));
+
+    int64_t value = 0;
+    auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+    if (ec != std::errc() || end != token.data() + token.size() || value == 0)
+        return false;
+
+    int64_t resolved = value > 0 ? value - 1 : static_cast<int64_t>(vertex_count) + value;
+    if (resolved < 0 || resolved >= static_cast<int64_t>(vertex_count))
+        return false;
+
+    index = static_cast<uint32_t>(resolved);
+    return true;
+}
+
+} // anonymous
+
+Result<std::vector<ImportedMesh>> import_obj(const std::filesystem::path &path)
+{
+    std::string text;
+    {
+        std::ifstream ifs(path, std::ios::binary); // raii
+        if (!ifs.is_open())
+            return Error(error_view("obj file cannot be opened"));
+        std::ostringstream contents;
+        contents << ifs.rdbuf();
+        text = std::move(contents).str();
+    }
+
+    // positions are global to the file, every mesh only keeps the ones its faces use
+    std::vector<assets::CookedVertex> file_vertices;
+    std::vector<ImportedMesh> meshes(1);
+    std::unordered_map<uint32_t, uint32_t> remap;
+    std::vector<uint32_t> polygon;
+
+    std::string_view remaining = text;
+    while (!remaining.empty())
+    {
+        auto newline = remaining.find('\n');
+        auto line = remaining.substr(0, newline);
+        remaining = newline == std::string_view::npos ? std::string_view() : remaining.substr(newline + 1);
+
+        auto keyword = next_token(line);
+        if (keyword == "v")
+        {
+            float values[6] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+            int count = 0;
+            for (auto token = next_token(line); !token.empty() && count < 6; token = next_token(line))
+            {
+                if (!parse_float(token, values[count++]))
+                    return Error(error_view("obj invalid vertex"));
+            }
+            if (count != 3 && count != 6)
+                return Error(error_view("obj vertex needs xyz or xyz rgb"));
+
+            file_vertices.push_back({
+                    .position = { values[0], values[1], values[2] },
+                    .color = { values[3], values[4], values[5] },
+            });
+        }
+        else if (keyword == "f")
+        {
+            auto &mesh = meshes.back();
+            polygon.clear();
+            for (auto token = next_token(line); !token.empty(); token = next_token(line))
+            {
+                uint32_t index = 0;
+                if (!parse_face_index(token, file_vertices.size(), index))
+                    return Error(error_view("obj invalid face index"));
+
+                auto [it, inserted] = remap.try_emplace(index, static_cast<uint32_t>(mesh.vertices.size()));
+                if (inserted)
+                    mesh.vertices.push_back(file_vertices[index]);
+                polygon.push_back(it->second);
+            }
+            if (polygon.size() < 3)
+                return Error(error_view("obj face with fewer than 3 vertices"));
+
+            for (size_t i = 2; i < polygon.size(); i++)
+            {
+                mesh.indices.insert(mesh.indices.end(), { polygon[0], polygon[i - 1], polygon[i] });
+            }
+        }
+        else if (keyword == "o")
+        {
+            if (!meshes.back().indices.empty())
+                meshes.emplace_back();
+            meshes.back().name = std::string(next_token(line));
+            remap.clear();
+        }
+    }
+
+    std::erase_if(meshes, [](const ImportedMesh &mesh) { return mesh.indices.empty(); });
+    return meshes;
+}
+
+} // venture::cooker
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+#include "ImportedMesh.hpp"
+#include "error_handling/Result.hpp"
+
+namespace venture::cooker {
+
+/**
+ * Wavefront OBJ, one mesh per 'o' statement. Positions and the common 'v x y z r g b' vertex color extension are
+ * kept, polygons are fan triangulated, texture coordinates, normals and materials are ignored
+ */
+[[nodiscard]]
+Result<std::vector<ImportedMesh>> import_obj(const std::filesystem::path &path);
+
+} // venture::cooker
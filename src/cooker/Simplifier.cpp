@@ -0,0 +1,341 @@
+#include "Simplifier.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_set>
+#include "MeshOptimizer.hpp"
+
+namespace venture::cooker {
+
+namespace {
+
+/** sum of squared distances to a set of area weighted planes, v^T A v + 2 b.v + c */
+struct Quadric
+{
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0;
+    double c = 0;
+    double weight = 0;
+
+    void add_plane(const double n[3], double d, double w)
+    {
+        a00 += w * n[0] * n[0];
+        a01 += w * n[0] * n[1];
+        a02 += w * n[0] * n[2];
+        a11 += w * n[1] * n[1];
+        a12 += w * n[1] * n[2];
+        a22 += w * n[2] * n[2];
+        b0 += w * n[0] * d;
+        b1 += w * n[1] * d;
+        b2 += w * n[2] * d;
+        c += w * d * d;
+        weight += w;
+    }
+
+    Quadric &operator+=(const Quadric &other)
+    {
+        a00 += other.a00;
+        a01 += other.a01;
+        a02 += other.a02;
+        a11 += other.a11;
+        a12 += other.a12;
+        a22 += other.a22;
+        b0 += other.b0;
+        b1 += other.b1;
+        b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+        return *this;
+    }
+
+    /** weighted mean squared distance of p to the planes */
+    [[nodiscard]]
+    double error(const float p[3]) const
+    {
+        double x = p[0], y = p[1], z = p[2];
+        double q = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                   2.0 * (b0 * x + b1 * y + b2 * z) + c;
+        return weight > 0.0 ? std::max(q, 0.0) / weight : 0.0;
+    }
+};
+
+struct Collapse
+{
+    uint32_t from;
+    uint32_t to;
+    double cost; // squared distance, orders the collapses
+};
+
+/** plane of a source triangle, n.p + d is the signed distance of p */
+struct Plane
+{
+    double n[3];
+    double d;
+};
+
+/** cross(p1 - p0, p2 - p0) */
+void triangle_normal(const float *p0, const float *p1, const float *p2, double n[3])
+{
+    double e1[3] = { double(p1[0]) - p0[0], double(p1[1]) - p0[1], double(p1[2]) - p0[2] };
+    double e2[3] = { double(p2[0]) - p0[0], double(p2[1]) - p0[1], double(p2[2]) - p0[2] };
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+uint64_t edge_key(uint32_t a, uint32_t b)
+{
+    return (uint64_t(a) << 32) | b;
+}
+
+} // anonymous
+
+std::vector<uint32_t> simplify(
+        std::span<const uint32_t> indices,
+        std::span<const assets::CookedVertex> vertices,
+        size_t target_index_count,
+        float max_error,
+        float &result_error)
+{
+    std::vector<uint32_t> result(indices.begin(), indices.end());
+    result_error = 0.0f;
+
+    size_t vertex_count = vertices.size();
+    auto position = [&](uint32_t v) { return vertices[v].position; };
+
+    //--- Locked vertices
+    // an edge without its twin is an open border or a seam where vertices split on attributes
+    std::vector<bool> locked(vertex_count, false);
+    {
+        std::unordered_set<uint64_t> edges;
+        edges.reserve(result.size());
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            for (int k = 0; k < 3; k++)
+                edges.insert(edge_key(result[i + k], result[i + (k + 1) % 3]));
+        }
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t a = result[i + k];
+                uint32_t b = result[i + (k + 1) % 3];
+                if (!edges.contains(edge_key(b, a)))
+                {
+                    locked[a] = true;
+                    locked[b] = true;
+                }
+            }
+        }
+    }
+
+    //--- Quadrics
+    // the quadric's mean orders the collapses, the planes behind it bound how far a collapse moves the surface
+    std::vector<Quadric> quadrics(vertex_count);
+    std::vector<Plane> planes;
+    std::vector<std::vector<uint32_t>> vertex_planes(vertex_count);
+    for (size_t i = 0; i < result.size(); i += 3)
+    {
+        double n[3];
+        triangle_normal(position(result[i]), position(result[i + 1]), position(result[i + 2]), n);
+        double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length <= 0.0)
+            continue;
+
+        for (double &c : n)
+            c /= length;
+        const float *p0 = position(result[i]);
+        double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+        for (int k = 0; k < 3; k++)
+        {
+            quadrics[result[i + k]].add_plane(n, d, length * 0.5);
+            vertex_planes[result[i + k]].push_back(static_cast<uint32_t>(planes.size()));
+        }
+        planes.push_back({ .n = { n[0], n[1], n[2] }, .d = d });
+    }
+
+    // largest distance of to's position from the planes of every source triangle either vertex stands for
+    auto max_distance = [&](uint32_t from, uint32_t to) {
+        const float *p = position(to);
+        double distance = 0.0;
+        for (uint32_t v : { from, to })
+        {
+            for (uint32_t plane : vertex_planes[v])
+            {
+                const auto &[n, d] = planes[plane];
+                distance = std::max(distance, std::abs(n[0] * p[0] + n[1] * p[1] + n[2] * p[2] + d));
+            }
+        }
+        return distance;
+    };
+
+    double max_cost = double(max_error) * max_error;
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> first(vertex_count + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<bool> touched(vertex_count);
+    std::vector<uint32_t> remap(vertex_count);
+
+    while (result.size() > target_index_count)
+    {
+        //--- Candidates
+        // every half edge proposes collapsing its start onto its end, the twin proposes the other direction
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t from = result[i + k];
+                uint32_t to = result[i + (k + 1) % 3];
+                if (locked[from])
+                    continue;
+
+                Quadric merged = quadrics[from];
+                merged += quadrics[to];
+                collapses.push_back({ .from = from, .to = to, .cost = merged.error(position(to)) });
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) {
+            return a.cost < b.cost;
+        });
+
+        //--- Adjacency
+        std::fill(first.begin(), first.end(), 0);
+        for (uint32_t index : result)
+            first[index + 1]++;
+        for (size_t v = 0; v < vertex_count; v++)
+            first[v + 1] += first[v];
+        adjacency.resize(result.size());
+        {
+            std::vector<uint32_t> fill(first.begin(), first.end() - 1);
+            for (size_t i = 0; i < result.size(); i++)
+                adjacency[fill[result[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        //--- Collapse
+        // cheapest first, a vertex takes part in one collapse per pass so the flip tests stay valid
+        std::fill(touched.begin(), touched.end(), false);
+        for (uint32_t v = 0; v < vertex_count; v++)
+            remap[v] = v;
+
+        // two triangles go per collapse, stop near the target rather than overshooting it in one pass
+        size_t collapse_limit = std::max<size_t>((result.size() - target_index_count) / 6, 1);
+        size_t collapsed = 0;
+        for (const auto &collapse : collapses)
+        {
+            if (collapsed >= collapse_limit || collapse.cost > max_cost)
+                break;
+            if (touched[collapse.from] || touched[collapse.to])
+                continue;
+
+            // the mean can stay under the bound while a single plane is left far behind
+            double distance = max_distance(collapse.from, collapse.to);
+            if (distance > max_error)
+                continue;
+
+            // moving from onto to must not turn any remaining triangle around
+            bool flips = false;
+            for (uint32_t a = first[collapse.from]; a < first[collapse.from + 1] && !flips; a++)
+            {
+                const uint32_t *triangle = &result[adjacency[a] * 3];
+                if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+                    continue;
+
+                const float *before[3];
+                const float *after[3];
+                for (int k = 0; k < 3; k++)
+                {
+                    before[k] = position(triangle[k]);
+                    after[k] = position(triangle[k] == collapse.from ? collapse.to : triangle[k]);
+                }
+                double n0[3], n1[3];
+                triangle_normal(before[0], before[1], before[2], n0);
+                triangle_normal(after[0], after[1], after[2], n1);
+                flips = n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2] <= 0.0;
+            }
+            if (flips)
+                continue;
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            auto &merged_planes = vertex_planes[collapse.to];
+            merged_planes.insert(merged_planes.end(), vertex_planes[collapse.from].begin(), vertex_planes[collapse.from].end());
+            vertex_planes[collapse.from].clear();
+            result_error = std::max(result_error, static_cast<float>(distance));
+            for (uint32_t a = first[collapse.from]; a < first[collapse.from + 1]; a++)
+            {
+                const uint32_t *triangle = &result[adjacency[a] * 3];
+                touched[triangle[0]] = true;
+                touched[triangle[1]] = true;
+                touched[triangle[2]] = true;
+            }
+            collapsed++;
+        }
+
+        if (collapsed == 0)
+            break;
+
+        //--- Rebuild
+        // triangles that lost an edge degenerate and go
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            uint32_t a = remap[result[i]];
+            uint32_t b = remap[result[i + 1]];
+            uint32_t c = remap[result[i + 2]];
+            if (a == b || b == c || c == a)
+                continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    return result;
+}
+
+void build_lods(ImportedMesh &mesh)
+{
+    mesh.lods.clear();
+    if (mesh.indices.empty())
+        return;
+
+    float min_corner[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+    float max_corner[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+    for (const auto &vertex : mesh.vertices)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            min_corner[c] = std::min(min_corner[c], vertex.position[c]);
+            max_corner[c] = std::max(max_corner[c], vertex.position[c]);
+        }
+    }
+    float extent[3] = { max_corner[0] - min_corner[0], max_corner[1] - min_corner[1], max_corner[2] - min_corner[2] };
+    float radius = 0.5f * std::sqrt(extent[0] * extent[0] + extent[1] * extent[1] + extent[2] * extent[2]);
+    float max_error = radius * LOD_MAX_RELATIVE_ERROR;
+
+    // each level simplifies the previous one, cheaper than starting over and the errors add up conservatively
+    mesh.lods.reserve(assets::MESH_MAX_LODS - 1);
+    float error = 0.0f;
+    while (mesh.lods.size() + 1 < assets::MESH_MAX_LODS)
+    {
+        const auto &source = mesh.lods.empty() ? mesh.indices : mesh.lods.back().indices;
+        size_t target = static_cast<size_t>(float(source.size() / 3) * LOD_REDUCTION) * 3;
+        if (target < LOD_MIN_TRIANGLES * 3)
+            break;
+
+        float lod_error = 0.0f;
+        auto indices = simplify(source, mesh.vertices, target, max_error - error, lod_error);
+        // locked vertices or the error bound stopped it, a barely smaller level is not worth a LOD
+        if (indices.size() * 4 > source.size() * 3)
+            break;
+
+        optimize_vertex_cache(indices, mesh.vertices.size());
+        optimize_overdraw(indices, mesh.vertices);
+        error += lod_error;
+        mesh.lods.push_back({ .indices = std::move(indices), .error = error });
+    }
+}
+
+} // venture::cooker
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+#include "ImportedMesh.hpp"
+
+namespace venture::cooker {
+
+/** every LOD aims for half the triangles of the one before it */
+constexpr float LOD_REDUCTION = 0.5f;
+/** a LOD error beyond this fraction of the mesh's bounding radius no longer resembles the mesh, the chain ends */
+constexpr float LOD_MAX_RELATIVE_ERROR = 0.25f;
+constexpr size_t LOD_MIN_TRIANGLES = 16;
+
+/**
+ * Quadric error edge collapse (Garland and Heckbert) towards target_index_count indices. The quadrics only order the
+ * collapses, a collapse is made when its vertex stays within max_error of the plane of every source triangle merged
+ * into it. Vertices only collapse onto other vertices, so the result indexes the same vertex list. Vertices on open
+ * borders and attribute seams never move, LODs keep their outline and open no cracks. result_error receives the
+ * largest such distance of any collapse made
+ */
+[[nodiscard]]
+std::vector<uint32_t> simplify(
+        std::span<const uint32_t> indices,
+        std::span<const assets::CookedVertex> vertices,
+        size_t target_index_count,
+        float max_error,
+        float &result_error);
+
+/**
+ * Fills mesh.lods with up to MESH_MAX_LODS - 1 simplified levels, each optimized for the vertex cache and overdraw.
+ * Run it after optimize_mesh, the levels index the reordered vertices
+ */
+void build_lods(ImportedMesh &mesh);
+
+} // venture::cooker
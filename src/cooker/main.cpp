@@ -0,0 +1,95 @@
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "GltfImporter.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshWriter.hpp"
+#include "Meshlets.hpp"
+#include "ObjImporter.hpp"
+#include "Simplifier.hpp"
+
+using namespace venture;
+
+/**
+ * Offline mesh cooker
+ *
+ * usage: VentureCooker <input.obj|input.gltf|input.glb> <output.vmesh>
+ * Converts source meshes into the file assets::MeshFile maps at runtime (see assets/MeshFormat.hpp), all parsing,
+ * reordering for the GPU, LOD and meshlet building happens here so loading is a copy. Recook whenever MESH_FILE_VERSION
+ * changes.
+ */
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: %s <input.obj|input.gltf|input.glb> <output.vmesh>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::filesystem::path input = argv[1];
+    std::filesystem::path output = argv[2];
+    auto extension = input.extension().string();
+    for (auto &c : extension)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+
+    auto start = std::chrono::steady_clock::now();
+
+    Result<std::vector<cooker::ImportedMesh>> meshes = Error(error_view("unknown input extension"));
+    if (extension == ".obj")
+        meshes = cooker::import_obj(input);
+    else if (extension == ".gltf" || extension == ".glb")
+        meshes = cooker::import_gltf(input);
+
+    if (!meshes)
+    {
+        fprintf(stderr, "%s: %.*s\n", argv[1], (int)meshes.error().size(), meshes.error().data());
+        return EXIT_FAILURE;
+    }
+    if (meshes->empty())
+    {
+        fprintf(stderr, "%s: no triangle meshes\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    // ACMR weighted by triangles over all meshes, before and after reordering
+    double misses_before = 0.0;
+    double misses_after = 0.0;
+    size_t meshlet_count = 0;
+    size_t lod_count = 0;
+    for (auto &mesh : *meshes)
+    {
+        double triangles = double(mesh.indices.size() / 3);
+        misses_before += cooker::analyze_vertex_cache(mesh.indices, mesh.vertices.size()).acmr * triangles;
+        cooker::optimize_mesh(mesh);
+        misses_after += cooker::analyze_vertex_cache(mesh.indices, mesh.vertices.size()).acmr * triangles;
+        cooker::build_meshlets(mesh);
+        meshlet_count += mesh.meshlets.size();
+        cooker::build_lods(mesh);
+        lod_count += mesh.lods.size() + 1;
+    }
+
+    if (auto written = cooker::write_mesh_file(output, *meshes); !written)
+    {
+        fprintf(stderr, "%s: %.*s\n", argv[2], (int)written.error().size(), written.error().data());
+        return EXIT_FAILURE;
+    }
+
+    size_t vertex_count = 0;
+    size_t triangle_count = 0;
+    for (const auto &mesh : *meshes)
+    {
+        vertex_count += mesh.vertices.size();
+        triangle_count += mesh.indices.size() / 3;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stdout, "cooked %s -> %s, %zu meshes, %zu vertices, %zu triangles, %zu lods, %zu meshlets in %.1f ms\n",
+            argv[1], argv[2], meshes->size(), vertex_count, triangle_count, lod_count, meshlet_count, ms);
+    fprintf(stdout, "ACMR (%u entry FIFO) %.3f -> %.3f\n", cooker::VERTEX_CACHE_SIZE,
+            triangle_count != 0 ? misses_before / double(triangle_count) : 0.0,
+            triangle_count != 0 ? misses_after / double(triangle_count) : 0.0);
+}
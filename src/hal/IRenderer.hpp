@@ -14,6 +14,7 @@ public:
     IRenderer(Window* window) : _window(window) {}
 
     virtual void draw() = 0;
+    virtual void wait_idle() = 0;
 
 protected:
     Window *_window;
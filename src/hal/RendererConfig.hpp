@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+namespace venture {
+
+/** Swapchain present mode, falls back towards FIFO (always supported) when the surface lacks it */
+enum class PresentPolicy
+{
+    Immediate,   // no vsync, tears, lowest latency
+    Mailbox,     // no tearing, newest frame wins, falls back to FIFO
+    Fifo,        // vsync, throughput bound by the display
+    FifoRelaxed, // vsync unless a frame is late, then tears instead of waiting another refresh
+};
+
+/** Renderer startup options, forwarded by Engine from EngineConfig */
+struct RendererConfig
+{
+    bool gpu_profiling = false;           // timestamp scopes around every pass
+    bool pipeline_statistics = false;     // statistics queries on scopes that ask for them, needs gpu_profiling
+    const char *profile_csv = nullptr;    // per frame csv dump of profiler results, needs gpu_profiling
+    const char *pipeline_cache_path = "pipeline_cache.bin"; // relative to the working directory, nullptr keeps it in memory only
+    uint32_t worker_threads = 0;          // renderer worker pool size, 0 is one per hardware thread minus one
+    uint32_t frames_in_flight = 2;        // frames the cpu may record ahead of the gpu, fewer is lower latency
+    PresentPolicy present_policy = PresentPolicy::Mailbox;
+    uint32_t texture_budget_mb = 512;     // device memory streamed texture levels may occupy, mip tails always fit
+    const char *mesh_path = nullptr;      // cooked mesh file (VentureCooker output) drawn instead of the test triangle
+    const char *texture_path = nullptr;   // KTX2 texture streamed in and modulating the scene in screen space
+    float lod_error_pixels = 1.0f;        // pixels a mesh LOD's error bound may project to, larger switches to coarser LODs sooner
+    bool dynamic_resolution = false;      // scale the render resolution to hold gpu_budget_ms, upscaled to the output
+    float gpu_budget_ms = 14.0f;          // gpu time per frame dynamic resolution aims for, headroom under 60 Hz
+    float min_render_scale = 0.5f;        // per axis fraction of the output resolution dynamic resolution may drop to
+    float max_render_scale = 1.0f;        // and may rise to, also the fixed scale when the gpu has no timestamps
+    const char *gpu = nullptr;            // device index or part of its name, nullptr picks the best scored, VENTURE_GPU overrides
+};
+
+} // venture
@@ -0,0 +1,85 @@
+#include "AsyncCompute.hpp"
+#include "error_handling/Check.hpp"
+
+namespace venture::vulkan {
+
+AsyncCompute::AsyncCompute(vk::Device device, QueueTimeline *compute, const QueueTimeline *graphics, uint32_t frames_in_flight)
+        : _device(device),
+          _compute(compute)
+{
+    _sharing_families.push_back(graphics->family_index());
+    if (compute->family_index() != graphics->family_index())
+        _sharing_families.push_back(compute->family_index());
+
+    // transient pools reset whole once the frame's previous submission has completed, like the graphics frames
+    _frames.resize(frames_in_flight);
+    for (auto &frame : _frames)
+    {
+        vk::CommandPoolCreateInfo command_pool_create_info = {
+                .sType = vk::StructureType::eCommandPoolCreateInfo,
+                .flags = vk::CommandPoolCreateFlagBits::eTransient,
+                .queueFamilyIndex = compute->family_index(),
+        };
+        frame.command_pool = _device.createCommandPoolUnique(command_pool_create_info);
+
+        vk::CommandBufferAllocateInfo command_buffer_allocate_info = {
+                .sType = vk::StructureType::eCommandBufferAllocateInfo,
+                .commandPool = *frame.command_pool,
+                .level = vk::CommandBufferLevel::ePrimary,
+                .commandBufferCount = 1,
+        };
+        frame.command_buffer = std::move(_device.allocateCommandBuffersUnique(command_buffer_allocate_info).front());
+    }
+}
+
+AsyncCompute::~AsyncCompute()
+{
+    for (const auto &frame : _frames)
+        _compute->wait(frame.value);
+}
+
+vk::CommandBuffer AsyncCompute::begin(uint32_t frame_index)
+{
+    check(frame_index < _frames.size());
+    auto &frame = _frames[frame_index];
+
+    _compute->wait(frame.value);
+    _device.resetCommandPool(*frame.command_pool);
+
+    vk::CommandBufferBeginInfo command_buffer_begin_info = {
+            .sType = vk::StructureType::eCommandBufferBeginInfo,
+            .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+    };
+    frame.command_buffer->begin(command_buffer_begin_info);
+    return *frame.command_buffer;
+}
+
+uint64_t AsyncCompute::submit(
+        uint32_t frame_index,
+        vk::PipelineStageFlags2 graphics_stages,
+        std::span<const vk::SemaphoreSubmitInfo> waits)
+{
+    check(frame_index < _frames.size());
+    auto &frame = _frames[frame_index];
+
+    frame.command_buffer->end();
+    frame.value = _compute->submit(std::span(&frame.command_buffer.get(), 1), waits);
+
+    // a later value covers the earlier ones, one wait hands everything over
+    _handoff_value = frame.value;
+    _handoff_stages |= graphics_stages;
+    return frame.value;
+}
+
+std::optional<vk::SemaphoreSubmitInfo> AsyncCompute::take_handoff()
+{
+    if (_handoff_value == 0)
+        return std::nullopt;
+
+    auto wait_info = _compute->wait_info(_handoff_value, _handoff_stages);
+    _handoff_value = 0;
+    _handoff_stages = {};
+    return wait_info;
+}
+
+} // venture::vulkan
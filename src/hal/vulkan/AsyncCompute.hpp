@@ -0,0 +1,79 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <optional>
+#include <span>
+#include <vector>
+#include "QueueTimeline.hpp"
+
+namespace venture::vulkan {
+
+/**
+ * Compute work submitted on the async compute queue, overlapping the graphics queue
+ *
+ * Every frame in flight owns a command pool on the compute family. begin() hands out the frame's command buffer and
+ * submit() sends it, waiting for whatever graphics values the caller passes. take_handoff() then gives the next
+ * graphics submission the wait for the results, at the stages the work was submitted for. Without a dedicated
+ * compute family the work becomes its own submission on the graphics queue and the API stays the same.
+ *
+ * The queues run in different families, a resource both use has to be created with sharing_families() or have its
+ * ownership transferred by the caller. Not thread safe, driven by the render thread.
+ */
+class AsyncCompute
+{
+public:
+    /** compute may be the graphics timeline, when the device has no dedicated compute family */
+    AsyncCompute(vk::Device device, QueueTimeline *compute, const QueueTimeline *graphics, uint32_t frames_in_flight);
+    ~AsyncCompute();
+
+    AsyncCompute(const AsyncCompute&) = delete;
+    void operator=(const AsyncCompute&) = delete;
+
+    /** begins the frame's command buffer, waits for the compute work the frame index submitted last time */
+    [[nodiscard]]
+    vk::CommandBuffer begin(uint32_t frame_index);
+    /**
+     * ends and submits the frame's command buffer after waits (graphics->wait_info() for results flowing the other
+     * way), graphics_stages are the stages of the next graphics submission that read what it produces. Returns the
+     * compute timeline value the work reaches
+     */
+    uint64_t submit(
+            uint32_t frame_index,
+            vk::PipelineStageFlags2 graphics_stages,
+            std::span<const vk::SemaphoreSubmitInfo> waits = {});
+
+    /** the wait the next graphics submission needs for work submitted since the last call, nothing if none was */
+    [[nodiscard]]
+    std::optional<vk::SemaphoreSubmitInfo> take_handoff();
+
+    /** runs on its own queue */
+    [[nodiscard]]
+    inline bool is_async() const noexcept;
+    /** queue family indices for vk::SharingMode::eConcurrent, a single family when compute runs on graphics */
+    [[nodiscard]]
+    inline std::span<const uint32_t> sharing_families() const noexcept;
+    [[nodiscard]]
+    inline const QueueTimeline &timeline() const noexcept;
+
+private:
+    struct Frame
+    {
+        vk::UniqueCommandPool command_pool;
+        vk::UniqueCommandBuffer command_buffer;
+        uint64_t value = 0; // on the compute timeline, of the last submission
+    };
+
+    vk::Device _device;
+    QueueTimeline *_compute;
+    std::vector<Frame> _frames;
+    std::vector<uint32_t> _sharing_families;
+
+    uint64_t _handoff_value = 0; // compute timeline, 0 when nothing awaits a handoff
+    vk::PipelineStageFlags2 _handoff_stages;
+};
+
+bool AsyncCompute::is_async() const noexcept { return _sharing_families.size() > 1; }
+std::span<const uint32_t> AsyncCompute::sharing_families() const noexcept { return _sharing_families; }
+const QueueTimeline &AsyncCompute::timeline() const noexcept { return *_compute; }
+
+} // venture::vulkan
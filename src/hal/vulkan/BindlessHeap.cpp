@@ -0,0 +1,250 @@
+#include "BindlessHeap.hpp"
+#include <algorithm>
+#include "error_handling/Check.hpp"
+
+namespace venture::vulkan {
+
+namespace {
+
+constexpr auto STAGES =
+        vk::ShaderStageFlagBits::eVertex |
+        vk::ShaderStageFlagBits::eFragment |
+        vk::ShaderStageFlagBits::eCompute;
+
+// per stage limits count every set of a pipeline layout, leave room for the non bindless ones
+uint32_t with_headroom(uint32_t limit)
+{
+    constexpr uint32_t headroom = 16;
+    return limit > headroom ? limit - headroom : limit;
+}
+
+vk::UniqueSampler make_sampler(vk::Device device, vk::Filter filter, vk::SamplerAddressMode address_mode)
+{
+    vk::SamplerCreateInfo sampler_create_info = {
+            .sType = vk::StructureType::eSamplerCreateInfo,
+            .magFilter = filter,
+            .minFilter = filter,
+            .mipmapMode = filter == vk::Filter::eLinear ? vk::SamplerMipmapMode::eLinear : vk::SamplerMipmapMode::eNearest,
+            .addressModeU = address_mode,
+            .addressModeV = address_mode,
+            .addressModeW = address_mode,
+            .mipLodBias = 0.0f,
+            .anisotropyEnable = false,
+            .maxAnisotropy = 1.0f,
+            .compareEnable = false,
+            .compareOp = vk::CompareOp::eAlways,
+            .minLod = 0.0f,
+            .maxLod = VK_LOD_CLAMP_NONE,
+            .borderColor = vk::BorderColor::eFloatTransparentBlack,
+            .unnormalizedCoordinates = false,
+    };
+    return device.createSamplerUnique(sampler_create_info);
+}
+
+} // anonymous
+
+BindlessHeap::BindlessHeap(
+        vk::Device device,
+        const DeviceProfile &profile,
+        const QueueTimeline *graphics,
+        uint32_t max_images,
+        uint32_t max_buffers)
+        : _device(device),
+          _graphics(graphics)
+{
+    const auto &props_12 = profile.properties_12();
+
+    _images.capacity = std::min({
+            max_images,
+            props_12.maxDescriptorSetUpdateAfterBindSampledImages,
+            with_headroom(props_12.maxPerStageDescriptorUpdateAfterBindSampledImages),
+    });
+    _buffers.capacity = std::min({
+            max_buffers,
+            props_12.maxDescriptorSetUpdateAfterBindStorageBuffers,
+            with_headroom(props_12.maxPerStageDescriptorUpdateAfterBindStorageBuffers),
+    });
+
+    //--- Samplers
+    _samplers[SAMPLER_LINEAR_REPEAT] = make_sampler(_device, vk::Filter::eLinear, vk::SamplerAddressMode::eRepeat);
+    _samplers[SAMPLER_NEAREST_CLAMP] = make_sampler(_device, vk::Filter::eNearest, vk::SamplerAddressMode::eClampToEdge);
+
+    vk::Sampler immutable_samplers[SAMPLER_COUNT];
+    for (uint32_t i = 0; i < SAMPLER_COUNT; i++)
+    {
+        immutable_samplers[i] = *_samplers[i];
+    }
+
+    //--- Layout
+    vk::DescriptorSetLayoutBinding bindings[] = {
+            {
+                    .binding = 0,
+                    .descriptorType = vk::DescriptorType::eSampledImage,
+                    .descriptorCount = _images.capacity,
+                    .stageFlags = STAGES,
+            },
+            {
+                    .binding = 1,
+                    .descriptorType = vk::DescriptorType::eStorageBuffer,
+                    .descriptorCount = _buffers.capacity,
+                    .stageFlags = STAGES,
+            },
+            {
+                    .binding = 2,
+                    .descriptorType = vk::DescriptorType::eSampler,
+                    .descriptorCount = SAMPLER_COUNT,
+                    .stageFlags = STAGES,
+                    .pImmutableSamplers = immutable_samplers,
+            },
+    };
+
+    // slots may be empty and may be written while a command buffer using other slots is pending
+    constexpr vk::DescriptorBindingFlags indexed_flags =
+            vk::DescriptorBindingFlagBits::ePartiallyBound |
+            vk::DescriptorBindingFlagBits::eUpdateAfterBind |
+            vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending;
+
+    vk::DescriptorBindingFlags binding_flags[] = {
+            indexed_flags,
+            indexed_flags,
+            {},
+    };
+
+    vk::DescriptorSetLayoutBindingFlagsCreateInfo binding_flags_create_info = {
+            .sType = vk::StructureType::eDescriptorSetLayoutBindingFlagsCreateInfo,
+            .bindingCount = sizeof binding_flags / sizeof *binding_flags,
+            .pBindingFlags = binding_flags,
+    };
+
+    vk::DescriptorSetLayoutCreateInfo layout_create_info = {
+            .sType = vk::StructureType::eDescriptorSetLayoutCreateInfo,
+            .pNext = &binding_flags_create_info,
+            .flags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool,
+            .bindingCount = sizeof bindings / sizeof *bindings,
+            .pBindings = bindings,
+    };
+    _layout = _device.createDescriptorSetLayoutUnique(layout_create_info);
+
+    //--- Set
+    vk::DescriptorPoolSize pool_sizes[] = {
+            { .type = vk::DescriptorType::eSampledImage, .descriptorCount = _images.capacity },
+            { .type = vk::DescriptorType::eStorageBuffer, .descriptorCount = _buffers.capacity },
+            { .type = vk::DescriptorType::eSampler, .descriptorCount = SAMPLER_COUNT },
+    };
+
+    vk::DescriptorPoolCreateInfo pool_create_info = {
+            .sType = vk::StructureType::eDescriptorPoolCreateInfo,
+            .flags = vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind,
+            .maxSets = 1,
+            .poolSizeCount = sizeof pool_sizes / sizeof *pool_sizes,
+            .pPoolSizes = pool_sizes,
+    };
+    _descriptor_pool = _device.createDescriptorPoolUnique(pool_create_info);
+
+    vk::DescriptorSetAllocateInfo set_alloc_info = {
+            .sType = vk::StructureType::eDescriptorSetAllocateInfo,
+            .descriptorPool = *_descriptor_pool,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &_layout.get(),
+    };
+    _descriptor_set = _device.allocateDescriptorSets(set_alloc_info)[0];
+}
+
+uint32_t BindlessHeap::add_image(vk::ImageView view, vk::ImageLayout layout)
+{
+    auto index = allocate(_images);
+    update_image(index, view, layout);
+    return index;
+}
+
+uint32_t BindlessHeap::add_buffer(vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize range)
+{
+    auto index = allocate(_buffers);
+
+    vk::DescriptorBufferInfo buffer_info = {
+            .buffer = buffer,
+            .offset = offset,
+            .range = range,
+    };
+
+    vk::WriteDescriptorSet write = {
+            .sType = vk::StructureType::eWriteDescriptorSet,
+            .dstSet = _descriptor_set,
+            .dstBinding = 1,
+            .dstArrayElement = index,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .pBufferInfo = &buffer_info,
+    };
+    _device.updateDescriptorSets(write, nullptr);
+    return index;
+}
+
+void BindlessHeap::update_image(uint32_t index, vk::ImageView view, vk::ImageLayout layout)
+{
+    check_DEBUG(index < _images.next);
+
+    vk::DescriptorImageInfo image_info = {
+            .imageView = view,
+            .imageLayout = layout,
+    };
+
+    vk::WriteDescriptorSet write = {
+            .sType = vk::StructureType::eWriteDescriptorSet,
+            .dstSet = _descriptor_set,
+            .dstBinding = 0,
+            .dstArrayElement = index,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eSampledImage,
+            .pImageInfo = &image_info,
+    };
+    _device.updateDescriptorSets(write, nullptr);
+}
+
+void BindlessHeap::remove_image(uint32_t index)
+{
+    retire(_images, index);
+}
+
+void BindlessHeap::remove_buffer(uint32_t index)
+{
+    retire(_buffers, index);
+}
+
+void BindlessHeap::collect()
+{
+    collect(_images);
+    collect(_buffers);
+}
+
+uint32_t BindlessHeap::allocate(Slots &slots)
+{
+    if (!slots.free.empty())
+    {
+        auto index = slots.free.back();
+        slots.free.pop_back();
+        return index;
+    }
+
+    checkf(slots.next < slots.capacity, "bindless heap out of slots, capacity %u", slots.capacity);
+    return slots.next++;
+}
+
+void BindlessHeap::retire(Slots &slots, uint32_t index) const
+{
+    check_DEBUG(index < slots.next);
+
+    // anything submitted so far, and the frame being recorded, may still read the slot
+    slots.retired.emplace_back(_graphics->last_submitted() + 1, index);
+}
+
+void BindlessHeap::collect(Slots &slots) const
+{
+    while (!slots.retired.empty() && _graphics->completed(slots.retired.front().first))
+    {
+        slots.free.push_back(slots.retired.front().second);
+        slots.retired.pop_front();
+    }
+}
+
+} // venture::vulkan
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <deque>
+#include <utility>
+#include <vector>
+#include "DeviceProfile.hpp"
+#include "QueueTimeline.hpp"
+
+namespace venture::vulkan {
+
+/**
+ * One global descriptor set of sampled images and storage buffers addressed by index, see shaders/bindless.glsl
+ *
+ * Built on descriptor indexing with update after bind and partially bound arrays, so the set is bound once per
+ * command buffer and slots are written while it is bound. Shaders receive indices through push constants or data
+ * they read (ObjectData), nothing has to be rebound to draw with another resource. A removed slot is only handed out
+ * again once the graphics timeline has passed every submission that could still reference it.
+ * Not thread safe, owned and driven by the render thread.
+ */
+class BindlessHeap
+{
+public:
+    // immutable samplers at binding 2, mirrored by shaders/bindless.glsl
+    constexpr static uint32_t SAMPLER_LINEAR_REPEAT = 0;
+    constexpr static uint32_t SAMPLER_NEAREST_CLAMP = 1;
+    constexpr static uint32_t SAMPLER_COUNT = 2;
+
+    /** capacities are clamped to the device's update after bind limits */
+    BindlessHeap(
+            vk::Device device,
+            const DeviceProfile &profile,
+            const QueueTimeline *graphics,
+            uint32_t max_images = 16384,
+            uint32_t max_buffers = 4096);
+
+    BindlessHeap(const BindlessHeap&) = delete;
+    void operator=(const BindlessHeap&) = delete;
+
+    [[nodiscard]]
+    uint32_t add_image(vk::ImageView view, vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+    [[nodiscard]]
+    uint32_t add_buffer(vk::Buffer buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE);
+    /**
+     * point an existing slot at another view, only valid while no submitted frame reads the slot. Swapping what a live
+     * slot shows is add_image() followed by remove_image() of the old one
+     */
+    void update_image(uint32_t index, vk::ImageView view, vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+
+    void remove_image(uint32_t index);
+    void remove_buffer(uint32_t index);
+    /** non blocking, recycle removed slots the GPU is done with, call once a frame */
+    void collect();
+
+    [[nodiscard]]
+    inline vk::DescriptorSetLayout layout() const noexcept;
+    [[nodiscard]]
+    inline vk::DescriptorSet descriptor_set() const noexcept;
+    [[nodiscard]]
+    inline uint32_t image_capacity() const noexcept;
+    [[nodiscard]]
+    inline uint32_t buffer_capacity() const noexcept;
+
+private:
+    struct Slots
+    {
+        uint32_t capacity = 0;
+        uint32_t next = 0; // never used past this
+        std::vector<uint32_t> free;
+        std::deque<std::pair<uint64_t, uint32_t>> retired; // graphics timeline value, slot
+    };
+
+    [[nodiscard]]
+    static uint32_t allocate(Slots &slots);
+    void retire(Slots &slots, uint32_t index) const;
+    void collect(Slots &slots) const;
+
+private:
+    vk::Device _device;
+    const QueueTimeline *_graphics;
+
+    vk::UniqueSampler _samplers[SAMPLER_COUNT];
+    vk::UniqueDescriptorSetLayout _layout;
+    vk::UniqueDescriptorPool _descriptor_pool;
+    vk::DescriptorSet _descriptor_set; // freed with the pool
+
+    Slots _images;
+    Slots _buffers;
+};
+
+vk::DescriptorSetLayout BindlessHeap::layout() const noexcept { return *_layout; }
+vk::DescriptorSet BindlessHeap::descriptor_set() const noexcept { return _descriptor_set; }
+uint32_t BindlessHeap::image_capacity() const noexcept { return _images.capacity; }
+uint32_t BindlessHeap::buffer_capacity() const noexcept { return _buffers.capacity; }
+
+} // venture::vulkan
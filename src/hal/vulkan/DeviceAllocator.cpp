@@ -0,0 +1,488 @@
+#include "DeviceAllocator.hpp"
+#include <algorithm>
+#include <bit>
+#include <set>
+#include <utility>
+#include "error_handling/Check.hpp"
+#include "error_handling/Log.hpp"
+
+namespace venture::vulkan {
+
+/** One vk::DeviceMemory managed as a buddy heap */
+struct MemoryBlock
+{
+    vk::DeviceMemory memory;
+    vk::DeviceSize size = 0;
+    void *mapped = nullptr;
+    uint32_t memory_type = 0;
+    uint32_t max_order = 0;
+    bool optimal_tiling = false;
+
+    std::vector<std::set<vk::DeviceSize>> free_lists; // free offsets, indexed by order - MIN_ORDER
+    vk::DeviceSize allocated = 0;
+    uint32_t allocation_count = 0;
+};
+
+namespace {
+
+constexpr uint32_t MIN_ORDER = 8; // 256 byte smallest allocation
+
+uint32_t order_for(vk::DeviceSize size)
+{
+    return std::max(MIN_ORDER, static_cast<uint32_t>(std::bit_width(size - 1)));
+}
+
+bool buddy_allocate(MemoryBlock &block, uint32_t order, vk::DeviceSize &offset)
+{
+    for (uint32_t o = order; o <= block.max_order; o++)
+    {
+        auto &free_list = block.free_lists[o - MIN_ORDER];
+        if (free_list.empty())
+            continue;
+
+        offset = *free_list.begin();
+        free_list.erase(free_list.begin());
+
+        // split down, the upper half of every split goes back on the free list
+        while (o > order)
+        {
+            o--;
+            block.free_lists[o - MIN_ORDER].insert(offset + (vk::DeviceSize(1) << o));
+        }
+        return true;
+    }
+    return false;
+}
+
+void buddy_free(MemoryBlock &block, vk::DeviceSize offset, uint32_t order)
+{
+    // coalesce with the buddy for as long as it is free
+    while (order < block.max_order)
+    {
+        auto &free_list = block.free_lists[order - MIN_ORDER];
+        auto buddy = free_list.find(offset ^ (vk::DeviceSize(1) << order));
+        if (buddy == free_list.end())
+            break;
+
+        offset = std::min(offset, *buddy);
+        free_list.erase(buddy);
+        order++;
+    }
+    block.free_lists[order - MIN_ORDER].insert(offset);
+}
+
+} // anonymous
+
+//--- AllocatorStats
+
+double AllocatorStats::internal_fragmentation() const noexcept
+{
+    auto block_requested = requested_bytes - dedicated_bytes;
+    return allocated_bytes > 0 ? 1.0 - double(block_requested) / double(allocated_bytes) : 0.0;
+}
+
+double AllocatorStats::external_fragmentation() const noexcept
+{
+    auto free_bytes = block_bytes - allocated_bytes;
+    return free_bytes > 0 ? 1.0 - double(largest_free_range) / double(free_bytes) : 0.0;
+}
+
+//--- UniqueAllocation
+
+UniqueAllocation::UniqueAllocation(DeviceAllocator *allocator, const Allocation &allocation)
+        : _allocator(allocator),
+          _allocation(allocation)
+{}
+
+UniqueAllocation::~UniqueAllocation()
+{
+    reset();
+}
+
+UniqueAllocation::UniqueAllocation(UniqueAllocation &&other) noexcept
+        : _allocator(std::exchange(other._allocator, nullptr)),
+          _allocation(std::exchange(other._allocation, {}))
+{}
+
+UniqueAllocation &UniqueAllocation::operator=(UniqueAllocation &&other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        _allocator = std::exchange(other._allocator, nullptr);
+        _allocation = std::exchange(other._allocation, {});
+    }
+    return *this;
+}
+
+void UniqueAllocation::reset()
+{
+    if (_allocator && _allocation.valid())
+        _allocator->free(_allocation);
+
+    _allocator = nullptr;
+    _allocation = {};
+}
+
+//--- DeviceAllocator
+
+DeviceAllocator::DeviceAllocator(vk::Device device, const DeviceProfile &profile, vk::DeviceSize preferred_block_size)
+        : _device(device),
+          _memory_props(profile.memory_properties()),
+          _max_allocation_count(profile.limits().maxMemoryAllocationCount)
+{
+    // small heaps (integrated or bar memory) get proportionally smaller blocks, buddy blocks must be a power of two
+    for (uint32_t i = 0; i < _memory_props.memoryTypeCount; i++)
+    {
+        auto heap_size = _memory_props.memoryHeaps[_memory_props.memoryTypes[i].heapIndex].size;
+        auto block_size = heap_size <= (vk::DeviceSize(1) << 30) ? heap_size / 8 : preferred_block_size;
+        _block_sizes[i] = std::bit_floor(std::max(block_size, vk::DeviceSize(1) << MIN_ORDER));
+    }
+}
+
+DeviceAllocator::~DeviceAllocator()
+{
+    for (auto &pools : _blocks)
+    {
+        for (auto &pool : pools)
+        {
+            for (auto &block : pool)
+            {
+                if (block->allocation_count > 0)
+                    log(Warning, "device allocator destroyed with " << block->allocation_count << " live allocations");
+                _device.freeMemory(block->memory);
+            }
+        }
+    }
+
+    if (_dedicated_count > 0)
+        log(Warning, "device allocator destroyed with " << _dedicated_count << " live dedicated allocations");
+}
+
+Allocation DeviceAllocator::allocate(
+        const vk::MemoryRequirements &requirements,
+        MemoryUsage usage,
+        bool optimal_tiling,
+        bool dedicated)
+{
+    std::lock_guard lock(_mutex);
+    return allocate_locked(requirements, usage, optimal_tiling, dedicated, nullptr);
+}
+
+void DeviceAllocator::free(const Allocation &allocation)
+{
+    if (!allocation.valid())
+        return;
+
+    std::lock_guard lock(_mutex);
+    _requested_bytes -= allocation.size;
+
+    if (allocation.dedicated)
+    {
+        free_memory(allocation.memory, allocation.memory_type, allocation.size);
+        _dedicated_count--;
+        _dedicated_bytes -= allocation.size;
+        return;
+    }
+
+    // linear allocations are released wholesale by their LinearAllocator
+    check_DEBUG(allocation.block != nullptr);
+
+    auto *block = allocation.block;
+    buddy_free(*block, allocation.offset, allocation.order);
+    block->allocated -= vk::DeviceSize(1) << allocation.order;
+    block->allocation_count--;
+
+    // keep one block per pool around so a single resource churning does not thrash vkAllocateMemory
+    auto &pool = _blocks[block->memory_type][block->optimal_tiling];
+    if (block->allocation_count == 0 && pool.size() > 1)
+        destroy_block(block);
+}
+
+AllocatedBuffer DeviceAllocator::create_buffer(const vk::BufferCreateInfo &buffer_create_info, MemoryUsage usage)
+{
+    AllocatedBuffer result;
+    result.buffer = _device.createBufferUnique(buffer_create_info);
+
+    vk::BufferMemoryRequirementsInfo2 requirements_info = {
+            .sType = vk::StructureType::eBufferMemoryRequirementsInfo2,
+            .buffer = *result.buffer,
+    };
+    auto chain = _device.getBufferMemoryRequirements2<vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(requirements_info);
+    auto requirements = chain.get<vk::MemoryRequirements2>().memoryRequirements;
+    auto dedicated = chain.get<vk::MemoryDedicatedRequirements>();
+
+    vk::MemoryDedicatedAllocateInfo dedicated_info = {
+            .sType = vk::StructureType::eMemoryDedicatedAllocateInfo,
+            .buffer = *result.buffer,
+    };
+
+    bool use_dedicated = dedicated.prefersDedicatedAllocation || dedicated.requiresDedicatedAllocation;
+    {
+        std::lock_guard lock(_mutex);
+        result.allocation = UniqueAllocation(this, allocate_locked(requirements, usage, false, use_dedicated, &dedicated_info));
+    }
+
+    _device.bindBufferMemory(*result.buffer, result.allocation->memory, result.allocation->offset);
+    return result;
+}
+
+AllocatedImage DeviceAllocator::create_image(const vk::ImageCreateInfo &image_create_info, MemoryUsage usage)
+{
+    AllocatedImage result;
+    result.image = _device.createImageUnique(image_create_info);
+
+    vk::ImageMemoryRequirementsInfo2 requirements_info = {
+            .sType = vk::StructureType::eImageMemoryRequirementsInfo2,
+            .image = *result.image,
+    };
+    auto chain = _device.getImageMemoryRequirements2<vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(requirements_info);
+    auto requirements = chain.get<vk::MemoryRequirements2>().memoryRequirements;
+    auto dedicated = chain.get<vk::MemoryDedicatedRequirements>();
+
+    vk::MemoryDedicatedAllocateInfo dedicated_info = {
+            .sType = vk::StructureType::eMemoryDedicatedAllocateInfo,
+            .image = *result.image,
+    };
+
+    bool use_dedicated = dedicated.prefersDedicatedAllocation || dedicated.requiresDedicatedAllocation;
+    bool optimal_tiling = image_create_info.tiling == vk::ImageTiling::eOptimal;
+    {
+        std::lock_guard lock(_mutex);
+        result.allocation = UniqueAllocation(this, allocate_locked(requirements, usage, optimal_tiling, use_dedicated, &dedicated_info));
+    }
+
+    _device.bindImageMemory(*result.image, result.allocation->memory, result.allocation->offset);
+    return result;
+}
+
+uint32_t DeviceAllocator::find_memory_type(
+        uint32_t type_filter,
+        vk::MemoryPropertyFlags required,
+        vk::MemoryPropertyFlags preferred) const
+{
+    // first pass takes required and preferred, second settles for required
+    for (auto flags : { required | preferred, required })
+    {
+        for (uint32_t i = 0; i < _memory_props.memoryTypeCount; i++)
+        {
+            if ((type_filter & (1U << i)) && (_memory_props.memoryTypes[i].propertyFlags & flags) == flags)
+                return i;
+        }
+    }
+
+    throw std::runtime_error("no suitable memory type");
+}
+
+AllocatorStats DeviceAllocator::stats()
+{
+    std::lock_guard lock(_mutex);
+
+    AllocatorStats result = {
+            .device_memory_count = _device_memory_count,
+            .dedicated_count = _dedicated_count,
+            .requested_bytes = _requested_bytes,
+            .dedicated_bytes = _dedicated_bytes,
+            .heap_usage = _heap_usage,
+    };
+
+    for (const auto &pools : _blocks)
+    {
+        for (const auto &pool : pools)
+        {
+            for (const auto &block : pool)
+            {
+                result.block_count++;
+                result.allocation_count += block->allocation_count;
+                result.block_bytes += block->size;
+                result.allocated_bytes += block->allocated;
+
+                for (uint32_t o = block->max_order; o >= MIN_ORDER; o--)
+                {
+                    if (!block->free_lists[o - MIN_ORDER].empty())
+                    {
+                        result.largest_free_range = std::max(result.largest_free_range, vk::DeviceSize(1) << o);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    result.allocation_count += _dedicated_count;
+    return result;
+}
+
+Allocation DeviceAllocator::allocate_locked(
+        const vk::MemoryRequirements &requirements,
+        MemoryUsage usage,
+        bool optimal_tiling,
+        bool dedicated,
+        const vk::MemoryDedicatedAllocateInfo *dedicated_info)
+{
+    vk::MemoryPropertyFlags required;
+    vk::MemoryPropertyFlags preferred;
+    switch (usage)
+    {
+        case MemoryUsage::eGpuOnly:
+            required = vk::MemoryPropertyFlagBits::eDeviceLocal;
+            break;
+        case MemoryUsage::eCpuToGpu:
+            required = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+            preferred = vk::MemoryPropertyFlagBits::eDeviceLocal;
+            break;
+        case MemoryUsage::eGpuToCpu:
+            required = vk::MemoryPropertyFlagBits::eHostVisible;
+            preferred = vk::MemoryPropertyFlagBits::eHostCached | vk::MemoryPropertyFlagBits::eHostCoherent;
+            break;
+        case MemoryUsage::eCpuOnly:
+            required = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+            break;
+    }
+
+    uint32_t memory_type = find_memory_type(requirements.memoryTypeBits, required, preferred);
+    auto block_size = _block_sizes[memory_type];
+    auto order = order_for(std::max(requirements.size, requirements.alignment));
+
+    _requested_bytes += requirements.size;
+
+    //--- Dedicated
+    // anything over half a block would waste most of a block to rounding
+    if (dedicated || requirements.size > block_size / 2)
+    {
+        auto memory = allocate_memory(requirements.size, memory_type, dedicated ? dedicated_info : nullptr);
+        _dedicated_count++;
+        _dedicated_bytes += requirements.size;
+
+        return {
+                .memory = memory,
+                .offset = 0,
+                .size = requirements.size,
+                .mapped = map_if_host_visible(memory, memory_type),
+                .memory_type = memory_type,
+                .dedicated = true,
+        };
+    }
+
+    //--- Block
+    auto &pool = _blocks[memory_type][optimal_tiling];
+    vk::DeviceSize offset = 0;
+    MemoryBlock *block = nullptr;
+
+    for (auto &candidate : pool)
+    {
+        if (buddy_allocate(*candidate, order, offset))
+        {
+            block = candidate.get();
+            break;
+        }
+    }
+
+    if (block == nullptr)
+    {
+        block = create_block(memory_type, optimal_tiling);
+        check(buddy_allocate(*block, order, offset));
+    }
+
+    block->allocated += vk::DeviceSize(1) << order;
+    block->allocation_count++;
+
+    return {
+            .memory = block->memory,
+            .offset = offset,
+            .size = requirements.size,
+            .mapped = block->mapped ? static_cast<char *>(block->mapped) + offset : nullptr,
+            .memory_type = memory_type,
+            .block = block,
+            .order = order,
+    };
+}
+
+MemoryBlock *DeviceAllocator::create_block(uint32_t memory_type, bool optimal_tiling)
+{
+    auto block = std::make_unique<MemoryBlock>();
+    block->size = _block_sizes[memory_type];
+    block->memory = allocate_memory(block->size, memory_type, nullptr);
+    block->mapped = map_if_host_visible(block->memory, memory_type);
+    block->memory_type = memory_type;
+    block->max_order = static_cast<uint32_t>(std::countr_zero(block->size));
+    block->optimal_tiling = optimal_tiling;
+    block->free_lists.resize(block->max_order - MIN_ORDER + 1);
+    block->free_lists.back().insert(0);
+
+    auto &pool = _blocks[memory_type][optimal_tiling];
+    pool.emplace_back(std::move(block));
+    return pool.back().get();
+}
+
+void DeviceAllocator::destroy_block(MemoryBlock *block)
+{
+    auto &pool = _blocks[block->memory_type][block->optimal_tiling];
+    free_memory(block->memory, block->memory_type, block->size);
+    std::erase_if(pool, [=](const std::unique_ptr<MemoryBlock> &candidate) { return candidate.get() == block; });
+}
+
+vk::DeviceMemory DeviceAllocator::allocate_memory(vk::DeviceSize size, uint32_t memory_type, const void *next)
+{
+    checkf(_device_memory_count < _max_allocation_count, "maxMemoryAllocationCount (%u) reached", _max_allocation_count);
+
+    vk::MemoryAllocateInfo memory_alloc_info = {
+            .sType = vk::StructureType::eMemoryAllocateInfo,
+            .pNext = next,
+            .allocationSize = size,
+            .memoryTypeIndex = memory_type,
+    };
+
+    auto memory = _device.allocateMemory(memory_alloc_info);
+    _device_memory_count++;
+    _heap_usage[_memory_props.memoryTypes[memory_type].heapIndex] += size;
+    return memory;
+}
+
+void DeviceAllocator::free_memory(vk::DeviceMemory memory, uint32_t memory_type, vk::DeviceSize size)
+{
+    // freeing implicitly unmaps
+    _device.freeMemory(memory);
+    _device_memory_count--;
+    _heap_usage[_memory_props.memoryTypes[memory_type].heapIndex] -= size;
+}
+
+void *DeviceAllocator::map_if_host_visible(vk::DeviceMemory memory, uint32_t memory_type) const
+{
+    if (!(_memory_props.memoryTypes[memory_type].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible))
+        return nullptr;
+
+    return _device.mapMemory(memory, 0, VK_WHOLE_SIZE);
+}
+
+//--- LinearAllocator
+
+LinearAllocator::LinearAllocator(DeviceAllocator *allocator, vk::DeviceSize size, uint32_t memory_type_bits, MemoryUsage usage)
+{
+    vk::MemoryRequirements requirements = {
+            .size = size,
+            .alignment = 256,
+            .memoryTypeBits = memory_type_bits,
+    };
+
+    _backing = UniqueAllocation(allocator, allocator->allocate(requirements, usage, false));
+}
+
+Allocation LinearAllocator::allocate(vk::DeviceSize size, vk::DeviceSize alignment)
+{
+    auto offset = (_head + alignment - 1) & ~(alignment - 1);
+    if (offset + size > _backing->size)
+        return {};
+
+    _head = offset + size;
+
+    return {
+            .memory = _backing->memory,
+            .offset = _backing->offset + offset,
+            .size = size,
+            .mapped = _backing->mapped ? static_cast<char *>(_backing->mapped) + offset : nullptr,
+            .memory_type = _backing->memory_type,
+    };
+}
+
+} // venture::vulkan
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "DeviceProfile.hpp"
+
+namespace venture::vulkan {
+
+class DeviceAllocator;
+struct MemoryBlock;
+
+/** Where a resource lives and who touches it, mapped to memory property flags by DeviceAllocator */
+enum class MemoryUsage
+{
+    eGpuOnly,   // device local, never mapped
+    eCpuToGpu,  // host visible, written every frame, device local if the device has such a type (resizable bar)
+    eGpuToCpu,  // host visible and cached, read back
+    eCpuOnly,   // host visible staging
+};
+
+/** A range of device memory, either suballocated from a block or a dedicated vk::DeviceMemory */
+struct Allocation
+{
+    vk::DeviceMemory memory;
+    vk::DeviceSize offset = 0;
+    vk::DeviceSize size = 0;
+    void *mapped = nullptr; // persistently mapped pointer to offset when the memory is host visible
+    uint32_t memory_type = 0;
+
+    MemoryBlock *block = nullptr; // null for dedicated and linear allocations
+    uint32_t order = 0;           // buddy order inside block
+    bool dedicated = false;       // owns memory outright
+
+    [[nodiscard]]
+    inline bool valid() const noexcept;
+};
+
+/** Move only owner of an Allocation, frees it on destruction */
+class UniqueAllocation
+{
+public:
+    UniqueAllocation() = default;
+    UniqueAllocation(DeviceAllocator *allocator, const Allocation &allocation);
+    ~UniqueAllocation();
+
+    UniqueAllocation(UniqueAllocation &&other) noexcept;
+    UniqueAllocation &operator=(UniqueAllocation &&other) noexcept;
+    UniqueAllocation(const UniqueAllocation&) = delete;
+    void operator=(const UniqueAllocation&) = delete;
+
+    void reset();
+
+    [[nodiscard]]
+    inline const Allocation &get() const noexcept;
+    inline const Allocation *operator->() const noexcept;
+
+private:
+    DeviceAllocator *_allocator = nullptr;
+    Allocation _allocation;
+};
+
+/** Buffer and the memory bound to it, the buffer is destroyed before its memory is freed */
+struct AllocatedBuffer
+{
+    UniqueAllocation allocation;
+    vk::UniqueBuffer buffer;
+};
+
+/** Image and the memory bound to it, the image is destroyed before its memory is freed */
+struct AllocatedImage
+{
+    UniqueAllocation allocation;
+    vk::UniqueImage image;
+};
+
+struct AllocatorStats
+{
+    uint32_t device_memory_count = 0;  // live vkAllocateMemory calls, bounded by maxMemoryAllocationCount
+    uint32_t block_count = 0;
+    uint32_t allocation_count = 0;
+    uint32_t dedicated_count = 0;
+    vk::DeviceSize block_bytes = 0;     // reserved by blocks
+    vk::DeviceSize allocated_bytes = 0; // handed out of blocks including buddy rounding
+    vk::DeviceSize requested_bytes = 0; // asked for by callers, blocks and dedicated
+    vk::DeviceSize dedicated_bytes = 0;
+    vk::DeviceSize largest_free_range = 0;
+    std::array<vk::DeviceSize, VK_MAX_MEMORY_HEAPS> heap_usage = {};
+
+    /** memory lost to power of two rounding */
+    [[nodiscard]]
+    double internal_fragmentation() const noexcept;
+    /** 1 - largest free range / free bytes, 0 means all free block memory is one range */
+    [[nodiscard]]
+    double external_fragmentation() const noexcept;
+};
+
+/**
+ * Device memory suballocator
+ *
+ * Memory is reserved in large blocks per memory type, each block is a buddy heap so allocations are aligned to their
+ * own rounded size and free ranges coalesce on release. Linear (buffer) and optimal (image) resources never share a
+ * block which keeps bufferImageGranularity out of the picture. Large resources, and ones the driver asks to be
+ * dedicated, get their own vk::DeviceMemory. Host visible blocks are persistently mapped. Thread safe.
+ */
+class DeviceAllocator
+{
+public:
+    DeviceAllocator(vk::Device device, const DeviceProfile &profile, vk::DeviceSize preferred_block_size = 64 << 20);
+    ~DeviceAllocator();
+
+    DeviceAllocator(const DeviceAllocator&) = delete;
+    void operator=(const DeviceAllocator&) = delete;
+
+    [[nodiscard]]
+    Allocation allocate(const vk::MemoryRequirements &requirements, MemoryUsage usage, bool optimal_tiling, bool dedicated = false);
+    void free(const Allocation &allocation);
+
+    /** create and bind, dedicated memory is used when the driver prefers it */
+    [[nodiscard]]
+    AllocatedBuffer create_buffer(const vk::BufferCreateInfo &buffer_create_info, MemoryUsage usage);
+    [[nodiscard]]
+    AllocatedImage create_image(const vk::ImageCreateInfo &image_create_info, MemoryUsage usage);
+
+    [[nodiscard]]
+    uint32_t find_memory_type(uint32_t type_filter, vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred = {}) const;
+    [[nodiscard]]
+    AllocatorStats stats();
+
+    [[nodiscard]]
+    inline vk::Device device() const noexcept;
+
+private:
+    // callers hold _mutex
+    [[nodiscard]]
+    Allocation allocate_locked(
+            const vk::MemoryRequirements &requirements,
+            MemoryUsage usage,
+            bool optimal_tiling,
+            bool dedicated,
+            const vk::MemoryDedicatedAllocateInfo *dedicated_info);
+    [[nodiscard]]
+    MemoryBlock *create_block(uint32_t memory_type, bool optimal_tiling);
+    void destroy_block(MemoryBlock *block);
+    [[nodiscard]]
+    vk::DeviceMemory allocate_memory(vk::DeviceSize size, uint32_t memory_type, const void *next);
+    void free_memory(vk::DeviceMemory memory, uint32_t memory_type, vk::DeviceSize size);
+    [[nodiscard]]
+    void *map_if_host_visible(vk::DeviceMemory memory, uint32_t memory_type) const;
+
+private:
+    vk::Device _device;
+    vk::PhysicalDeviceMemoryProperties _memory_props;
+    uint32_t _max_allocation_count;
+    std::array<vk::DeviceSize, VK_MAX_MEMORY_TYPES> _block_sizes = {};
+
+    std::mutex _mutex;
+    // [memory type][linear = 0, optimal = 1]
+    std::array<std::array<std::vector<std::unique_ptr<MemoryBlock>>, 2>, VK_MAX_MEMORY_TYPES> _blocks;
+    uint32_t _device_memory_count = 0;
+    uint32_t _dedicated_count = 0;
+    vk::DeviceSize _dedicated_bytes = 0;
+    vk::DeviceSize _requested_bytes = 0;
+    std::array<vk::DeviceSize, VK_MAX_MEMORY_HEAPS> _heap_usage = {};
+};
+
+/**
+ * Bump allocator over a single allocation, meant for data that lives exactly one frame. Nothing is freed
+ * individually, reset() releases everything once the GPU is done with the frame.
+ */
+class LinearAllocator
+{
+public:
+    LinearAllocator(DeviceAllocator *allocator, vk::DeviceSize size, uint32_t memory_type_bits, MemoryUsage usage);
+
+    /** returns an invalid Allocation when out of space */
+    [[nodiscard]]
+    Allocation allocate(vk::DeviceSize size, vk::DeviceSize alignment);
+    inline void reset() noexcept;
+
+    [[nodiscard]]
+    inline vk::DeviceSize used() const noexcept;
+    [[nodiscard]]
+    inline vk::DeviceSize capacity() const noexcept;
+
+private:
+    UniqueAllocation _backing;
+    vk::DeviceSize _head = 0;
+};
+
+bool Allocation::valid() const noexcept { return static_cast<bool>(memory); }
+
+const Allocation &UniqueAllocation::get() const noexcept { return _allocation; }
+const Allocation *UniqueAllocation::operator->() const noexcept { return &_allocation; }
+
+vk::Device DeviceAllocator::device() const noexcept { return _device; }
+
+void LinearAllocator::reset() noexcept { _head = 0; }
+vk::DeviceSize LinearAllocator::used() const noexcept { return _head; }
+vk::DeviceSize LinearAllocator::capacity() const noexcept { return _backing->size; }
+
+} // venture::vulkan
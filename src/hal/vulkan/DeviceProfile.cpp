@@ -0,0 +1,151 @@
+#include "DeviceProfile.hpp"
+#include <algorithm>
+
+namespace venture::vulkan {
+
+namespace {
+
+int64_t device_type_score(vk::PhysicalDeviceType type)
+{
+    // apart far enough that nothing else can make up for a slower class of device
+    switch (type)
+    {
+        case vk::PhysicalDeviceType::eDiscreteGpu:
+            return 1'000'000;
+        case vk::PhysicalDeviceType::eIntegratedGpu:
+            return 500'000;
+        case vk::PhysicalDeviceType::eVirtualGpu:
+            return 250'000;
+        case vk::PhysicalDeviceType::eOther:
+            return 100'000;
+        case vk::PhysicalDeviceType::eCpu: // software rasterizer, last resort
+        default:
+            return 0;
+    }
+}
+
+} // anonymous
+
+DeviceProfile DeviceProfile::query(vk::PhysicalDevice physical_device, vk::SurfaceKHR surface)
+{
+    DeviceProfile profile;
+    profile._physical_device = physical_device;
+
+    auto properties = physical_device.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan12Properties>();
+    profile._properties = properties.get<vk::PhysicalDeviceProperties2>().properties;
+    profile._properties_12 = properties.get<vk::PhysicalDeviceVulkan12Properties>();
+    profile._properties_12.pNext = nullptr;
+
+    // the 1.2 and 1.3 feature structs only exist on 1.3 devices, older ones are rejected by missing_requirement
+    profile._features = physical_device.getFeatures();
+    if (profile._properties.apiVersion >= VK_API_VERSION_1_3)
+    {
+        auto features = physical_device.getFeatures2<
+                vk::PhysicalDeviceFeatures2,
+                vk::PhysicalDeviceVulkan12Features,
+                vk::PhysicalDeviceVulkan13Features>();
+        profile._features_12 = features.get<vk::PhysicalDeviceVulkan12Features>();
+        profile._features_12.pNext = nullptr;
+        profile._features_13 = features.get<vk::PhysicalDeviceVulkan13Features>();
+        profile._features_13.pNext = nullptr;
+    }
+
+    for (const auto &extension : physical_device.enumerateDeviceExtensionProperties())
+        profile._extensions.emplace_back(extension.extensionName.data());
+    std::ranges::sort(profile._extensions);
+
+    profile._memory_properties = physical_device.getMemoryProperties();
+    for (uint32_t i = 0; i < profile._memory_properties.memoryHeapCount; i++)
+    {
+        const auto &heap = profile._memory_properties.memoryHeaps[i];
+        if (heap.flags & vk::MemoryHeapFlagBits::eDeviceLocal)
+            profile._device_local_bytes += heap.size;
+    }
+
+    profile._queue_family_properties = physical_device.getQueueFamilyProperties();
+    profile._queue_families = QueueFamilyInfo::get_info(physical_device, surface);
+
+    // feature structs of extensions the device lacks must not be chained
+    if (profile.has_extension(VK_KHR_PRESENT_ID_EXTENSION_NAME) && profile.has_extension(VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+    {
+        auto features = physical_device.getFeatures2<
+                vk::PhysicalDeviceFeatures2,
+                vk::PhysicalDevicePresentIdFeaturesKHR,
+                vk::PhysicalDevicePresentWaitFeaturesKHR>();
+        profile._present_wait = features.get<vk::PhysicalDevicePresentIdFeaturesKHR>().presentId &&
+                                features.get<vk::PhysicalDevicePresentWaitFeaturesKHR>().presentWait;
+    }
+
+    return profile;
+}
+
+const char *DeviceProfile::missing_requirement(std::span<const char *const> required_extensions) const
+{
+    // rendering goes through vkCmdBeginRendering, core and required from 1.3 on
+    if (_properties.apiVersion < VK_API_VERSION_1_3)
+        return "Vulkan 1.3";
+    if (!_queue_families.is_valid())
+        return "graphics and presentation queues";
+    if (!_features_13.dynamicRendering)
+        return "dynamicRendering";
+
+    // frames and uploads are tracked on per queue timelines, recorded and submitted through the sync2 entry points
+    if (!_features_12.timelineSemaphore || !_features_13.synchronization2)
+        return "timelineSemaphore and synchronization2";
+
+    // the scene is drawn through compute culled indirect draws, see GpuScene
+    if (!_features.multiDrawIndirect || !_features.drawIndirectFirstInstance || !_features_12.drawIndirectCount)
+        return "multiDrawIndirect, drawIndirectFirstInstance and drawIndirectCount";
+
+    // buffers and textures are reached through one update after bind descriptor set, see BindlessHeap. Shaders index
+    // its arrays with push constant and uniform values, which takes the core dynamic indexing features
+    bool descriptor_indexing = _features.shaderSampledImageArrayDynamicIndexing &&
+                               _features.shaderStorageBufferArrayDynamicIndexing &&
+                               _features_12.descriptorIndexing &&
+                               _features_12.shaderSampledImageArrayNonUniformIndexing &&
+                               _features_12.descriptorBindingSampledImageUpdateAfterBind &&
+                               _features_12.descriptorBindingStorageBufferUpdateAfterBind &&
+                               _features_12.descriptorBindingUpdateUnusedWhilePending &&
+                               _features_12.descriptorBindingPartiallyBound &&
+                               _features_12.runtimeDescriptorArray;
+    if (!descriptor_indexing)
+        return "dynamic and update after bind descriptor indexing with partially bound arrays";
+
+    for (const char *extension : required_extensions)
+    {
+        if (!has_extension(extension))
+            return extension;
+    }
+    return nullptr;
+}
+
+int64_t DeviceProfile::score() const
+{
+    int64_t score = device_type_score(_properties.deviceType);
+
+    // engines running alongside graphics, see StagingUploader and AsyncCompute
+    if (_queue_families.has_dedicated_compute())
+        score += 40'000;
+    if (_queue_families.has_dedicated_transfer())
+        score += 40'000;
+    if (_queue_families.graphics_family_index == _queue_families.presentation_family_index)
+        score += 10'000;
+
+    // room for resident textures and meshes, a MiB a point up to 64 GiB
+    score += static_cast<int64_t>(std::min<vk::DeviceSize>(_device_local_bytes >> 20, 64 << 10));
+
+    // optional features the renderer uses when they are there
+    if (_present_wait)
+        score += 5'000;
+    if (_features.pipelineStatisticsQuery && _features.inheritedQueries)
+        score += 1'000;
+
+    return score;
+}
+
+bool DeviceProfile::has_extension(std::string_view name) const
+{
+    return std::ranges::binary_search(_extensions, name, std::less<>());
+}
+
+} // venture::vulkan
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "QueueFamilyInfo.hpp"
+
+namespace venture::vulkan {
+
+/**
+ * What a physical device offers, queried once while devices are enumerated
+ *
+ * Device selection scores it and subsystems size themselves from it (limits, memory heaps, timestamp support), so
+ * nothing goes back to the driver for properties after startup. Plain data, copied freely.
+ */
+class DeviceProfile
+{
+public:
+    [[nodiscard]]
+    static DeviceProfile query(vk::PhysicalDevice physical_device, vk::SurfaceKHR surface);
+
+    /** nullptr when the renderer can run on the device, otherwise the first thing it lacks */
+    [[nodiscard]]
+    const char *missing_requirement(std::span<const char *const> required_extensions) const;
+    /**
+     * higher is better, compares devices without a missing requirement. Device type dominates, then queue topology,
+     * device local memory and optional features break ties between devices of a type
+     */
+    [[nodiscard]]
+    int64_t score() const;
+
+    [[nodiscard]]
+    bool has_extension(std::string_view name) const;
+
+    [[nodiscard]]
+    inline vk::PhysicalDevice physical_device() const noexcept;
+    [[nodiscard]]
+    inline std::string_view name() const noexcept;
+    [[nodiscard]]
+    inline const vk::PhysicalDeviceProperties &properties() const noexcept;
+    [[nodiscard]]
+    inline const vk::PhysicalDeviceLimits &limits() const noexcept;
+    [[nodiscard]]
+    inline const vk::PhysicalDeviceVulkan12Properties &properties_12() const noexcept;
+    [[nodiscard]]
+    inline const vk::PhysicalDeviceMemoryProperties &memory_properties() const noexcept;
+    [[nodiscard]]
+    inline const vk::PhysicalDeviceFeatures &features() const noexcept;
+    [[nodiscard]]
+    inline const vk::PhysicalDeviceVulkan12Features &features_12() const noexcept;
+    [[nodiscard]]
+    inline const vk::PhysicalDeviceVulkan13Features &features_13() const noexcept;
+    [[nodiscard]]
+    inline std::span<const vk::QueueFamilyProperties> queue_family_properties() const noexcept;
+    [[nodiscard]]
+    inline const QueueFamilyInfo &queue_families() const noexcept;
+    /** sum of the device local heaps */
+    [[nodiscard]]
+    inline vk::DeviceSize device_local_bytes() const noexcept;
+    /** VK_KHR_present_id and VK_KHR_present_wait with their features */
+    [[nodiscard]]
+    inline bool supports_present_wait() const noexcept;
+
+private:
+    vk::PhysicalDevice _physical_device;
+    vk::PhysicalDeviceProperties _properties;
+    vk::PhysicalDeviceVulkan12Properties _properties_12; // pNext cleared, the chain it was queried with is gone
+    vk::PhysicalDeviceMemoryProperties _memory_properties;
+    vk::PhysicalDeviceFeatures _features;
+    vk::PhysicalDeviceVulkan12Features _features_12;
+    vk::PhysicalDeviceVulkan13Features _features_13;
+    std::vector<std::string> _extensions; // sorted
+    std::vector<vk::QueueFamilyProperties> _queue_family_properties;
+    QueueFamilyInfo _queue_families;
+    vk::DeviceSize _device_local_bytes = 0;
+    bool _present_wait = false;
+};
+
+vk::PhysicalDevice DeviceProfile::physical_device() const noexcept { return _physical_device; }
+std::string_view DeviceProfile::name() const noexcept { return _properties.deviceName.data(); }
+const vk::PhysicalDeviceProperties &DeviceProfile::properties() const noexcept { return _properties; }
+const vk::PhysicalDeviceLimits &DeviceProfile::limits() const noexcept { return _properties.limits; }
+const vk::PhysicalDeviceVulkan12Properties &DeviceProfile::properties_12() const noexcept { return _properties_12; }
+const vk::PhysicalDeviceMemoryProperties &DeviceProfile::memory_properties() const noexcept { return _memory_properties; }
+const vk::PhysicalDeviceFeatures &DeviceProfile::features() const noexcept { return _features; }
+const vk::PhysicalDeviceVulkan12Features &DeviceProfile::features_12() const noexcept { return _features_12; }
+const vk::PhysicalDeviceVulkan13Features &DeviceProfile::features_13() const noexcept { return _features_13; }
+std::span<const vk::QueueFamilyProperties> DeviceProfile::queue_family_properties() const noexcept { return _queue_family_properties; }
+const QueueFamilyInfo &DeviceProfile::queue_families() const noexcept { return _queue_families; }
+vk::DeviceSize DeviceProfile::device_local_bytes() const noexcept { return _device_local_bytes; }
+bool DeviceProfile::supports_present_wait() const noexcept { return _present_wait; }
+
+} // venture::vulkan
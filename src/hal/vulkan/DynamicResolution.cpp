@@ -0,0 +1,120 @@
+#include "DynamicResolution.hpp"
+#include <algorithm>
+#include <cmath>
+#include "error_handling/Check.hpp"
+#include "error_handling/Log.hpp"
+
+namespace venture::vulkan {
+
+DynamicResolution::DynamicResolution(
+        vk::Device device,
+        const DeviceProfile &profile,
+        uint32_t queue_family_index,
+        uint32_t slot_count,
+        float budget_ms,
+        float min_scale,
+        float max_scale)
+        : _device(device),
+          _slots(slot_count),
+          _budget_ms(budget_ms)
+{
+    _max_scale = std::clamp(max_scale, 0.1f, 1.0f);
+    _min_scale = std::clamp(min_scale, 0.1f, _max_scale);
+    _scale = _max_scale;
+
+    auto queue_family_props = profile.queue_family_properties();
+    check(queue_family_index < queue_family_props.size());
+    uint32_t valid_bits = queue_family_props[queue_family_index].timestampValidBits;
+
+    _enabled = valid_bits > 0 && profile.limits().timestampPeriod > 0.0f && budget_ms > 0.0f && _min_scale < _max_scale;
+    if (!_enabled)
+    {
+        log(Warning, "dynamic resolution fixed at " << _max_scale << ", no timestamps on queue family "
+                     << queue_family_index << " or no range to scale in");
+        return;
+    }
+
+    _timestamp_period = profile.limits().timestampPeriod;
+    _timestamp_mask = valid_bits >= 64 ? ~0ULL : (1ULL << valid_bits) - 1;
+
+    vk::QueryPoolCreateInfo timestamp_pool_create_info = {
+            .sType = vk::StructureType::eQueryPoolCreateInfo,
+            .queryType = vk::QueryType::eTimestamp,
+            .queryCount = slot_count * 2,
+    };
+    _timestamp_pool = _device.createQueryPoolUnique(timestamp_pool_create_info);
+
+    log(Info, "dynamic resolution between " << _min_scale << " and " << _max_scale << " for " << budget_ms << " ms");
+}
+
+void DynamicResolution::begin(vk::CommandBuffer command_buffer, uint32_t slot)
+{
+    auto &s = _slots.at(slot);
+    s.scale = _scale;
+    if (!_enabled)
+        return;
+
+    command_buffer.resetQueryPool(*_timestamp_pool, slot * 2, 2);
+    command_buffer.writeTimestamp2(vk::PipelineStageFlagBits2::eNone, *_timestamp_pool, slot * 2);
+    s.recorded = true;
+}
+
+void DynamicResolution::end(vk::CommandBuffer command_buffer, uint32_t slot)
+{
+    if (!_enabled)
+        return;
+
+    command_buffer.writeTimestamp2(vk::PipelineStageFlagBits2::eAllCommands, *_timestamp_pool, slot * 2 + 1);
+}
+
+void DynamicResolution::collect(uint32_t slot)
+{
+    auto &s = _slots.at(slot);
+    if (!_enabled || !s.recorded)
+        return;
+    s.recorded = false;
+
+    // [value, availability] per query, eNotReady is expected for unavailable queries and never waited on
+    constexpr auto flags = vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability;
+    auto timestamps = _device.getQueryPoolResults<uint64_t>(
+            *_timestamp_pool, slot * 2, 2, 4 * sizeof(uint64_t), 2 * sizeof(uint64_t), flags).value;
+
+    uint64_t begin = timestamps[0] & _timestamp_mask;
+    uint64_t end = timestamps[2] & _timestamp_mask;
+    if (timestamps[1] == 0 || timestamps[3] == 0 || end <= begin)
+        return;
+
+    double ms = double(end - begin) * _timestamp_period / 1e6;
+    _gpu_ms = _gpu_ms > 0.0 ? std::lerp(_gpu_ms, ms, SMOOTHING) : ms;
+
+    // the sampled frame may predate changes made since, predict from the scale it was recorded with. Raising aims
+    // below the budget, aiming at it would climb straight back into the next drop
+    double raise_to_ms = _budget_ms * RAISE_BELOW;
+    if (ms > _budget_ms)
+        _scale = std::min(_scale, static_cast<float>(s.scale * std::sqrt(_budget_ms / ms)));
+    else if (_gpu_ms < raise_to_ms)
+        _scale = std::min(_scale + RAISE_STEP, std::max(_scale, static_cast<float>(s.scale * std::sqrt(raise_to_ms / _gpu_ms))));
+
+    _scale = std::clamp(_scale, _min_scale, _max_scale);
+}
+
+vk::Extent2D DynamicResolution::render_extent(vk::Extent2D output) const
+{
+    auto scaled = [this](uint32_t size) {
+        return std::max(static_cast<uint32_t>(std::lround(float(size) * _scale)), 1U);
+    };
+
+    auto target = target_extent(output);
+    return { std::min(scaled(output.width), target.width), std::min(scaled(output.height), target.height) };
+}
+
+vk::Extent2D DynamicResolution::target_extent(vk::Extent2D output) const
+{
+    auto scaled = [this](uint32_t size) {
+        return std::max(static_cast<uint32_t>(std::lround(float(size) * _max_scale)), 1U);
+    };
+
+    return { scaled(output.width), scaled(output.height) };
+}
+
+} // venture::vulkan
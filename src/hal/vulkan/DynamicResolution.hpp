@@ -0,0 +1,88 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <vector>
+#include "DeviceProfile.hpp"
+
+namespace venture::vulkan {
+
+/**
+ * Picks the fraction of the output resolution the scene is rendered at from measured GPU frame time
+ *
+ * Every slot (one per command buffer) brackets its submission with two timestamps, read back by collect() once the
+ * submission has completed, like GpuProfiler but independent of whether profiling is on. Cost is taken to follow
+ * the pixel count, so the scale that would have fit the budget is the sampled frame's scale times
+ * sqrt(budget / measured). Going over the budget drops to that scale at once, a load spike costs resolution rather
+ * than frames; coming back up waits for smoothed time to be comfortably under the budget and climbs in small steps,
+ * so the scale does not oscillate around the budget. Without timestamp support the scale stays at its maximum.
+ */
+class DynamicResolution
+{
+public:
+    /** scales are fractions of the output extent per axis, clamped to (0, 1] */
+    DynamicResolution(
+            vk::Device device,
+            const DeviceProfile &profile,
+            uint32_t queue_family_index,
+            uint32_t slot_count,
+            float budget_ms,
+            float min_scale,
+            float max_scale);
+
+    /** reset the slot's queries and timestamp the start, must be recorded first and outside a render pass */
+    void begin(vk::CommandBuffer command_buffer, uint32_t slot);
+    /** timestamp the end, recorded last */
+    void end(vk::CommandBuffer command_buffer, uint32_t slot);
+
+    /** read back a slot whose submission has completed and adjust the scale, non blocking */
+    void collect(uint32_t slot);
+
+    /** the part of a target of output * max_scale() the scene is rendered to this frame, at least one pixel */
+    [[nodiscard]]
+    vk::Extent2D render_extent(vk::Extent2D output) const;
+    /** the render target size covering every scale, output * max_scale() */
+    [[nodiscard]]
+    vk::Extent2D target_extent(vk::Extent2D output) const;
+
+    [[nodiscard]]
+    inline bool enabled() const noexcept;
+    [[nodiscard]]
+    inline float scale() const noexcept;
+    [[nodiscard]]
+    inline float max_scale() const noexcept;
+    /** smoothed over recent frames, zero until the first frame is collected */
+    [[nodiscard]]
+    inline double gpu_ms() const noexcept;
+
+private:
+    struct Slot
+    {
+        float scale = 1.0f; // what the slot was recorded with
+        bool recorded = false;
+    };
+
+private:
+    vk::Device _device;
+    vk::UniqueQueryPool _timestamp_pool; // two per slot
+    std::vector<Slot> _slots;
+    double _timestamp_period = 0.0; // nanoseconds per tick
+    uint64_t _timestamp_mask = ~0ULL;
+    bool _enabled = false;
+
+    double _budget_ms;
+    float _min_scale;
+    float _max_scale;
+    float _scale;
+    double _gpu_ms = 0.0;
+
+    constexpr static double SMOOTHING = 0.1;    // weight of the newest frame in gpu_ms()
+    constexpr static double RAISE_BELOW = 0.85; // fraction of the budget smoothed time must be under to raise
+    constexpr static float RAISE_STEP = 0.02f;  // largest raise per frame
+};
+
+bool DynamicResolution::enabled() const noexcept { return _enabled; }
+float DynamicResolution::scale() const noexcept { return _scale; }
+float DynamicResolution::max_scale() const noexcept { return _max_scale; }
+double DynamicResolution::gpu_ms() const noexcept { return _gpu_ms; }
+
+} // venture::vulkan
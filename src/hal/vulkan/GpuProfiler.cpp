@@ -0,0 +1,199 @@
+#include "GpuProfiler.hpp"
+#include <algorithm>
+#include <limits>
+#include "error_handling/Check.hpp"
+#include "error_handling/Log.hpp"
+
+namespace venture::vulkan {
+
+GpuProfiler::GpuProfiler(
+        vk::Device device,
+        const DeviceProfile &profile,
+        uint32_t queue_family_index,
+        uint32_t slot_count,
+        bool pipeline_statistics)
+        : _device(device)
+{
+    const auto &limits = profile.limits();
+    auto queue_family_props = profile.queue_family_properties();
+    check(queue_family_index < queue_family_props.size());
+    uint32_t valid_bits = queue_family_props[queue_family_index].timestampValidBits;
+
+    // a zero valid bit count means the queue cannot write timestamps at all
+    _enabled = valid_bits > 0 && limits.timestampPeriod > 0.0f;
+    if (!_enabled)
+    {
+        log(Warning, "gpu profiler disabled, queue family " << queue_family_index << " has no timestamp support");
+        return;
+    }
+
+    _timestamp_period = limits.timestampPeriod;
+    _timestamp_mask = valid_bits >= 64 ? ~0ULL : (1ULL << valid_bits) - 1;
+    // statistics scopes span render passes recorded into secondaries, which needs inheritedQueries
+    const auto &features = profile.features();
+    _pipeline_statistics = pipeline_statistics && features.pipelineStatisticsQuery && features.inheritedQueries;
+
+    vk::QueryPoolCreateInfo timestamp_pool_create_info = {
+            .sType = vk::StructureType::eQueryPoolCreateInfo,
+            .queryType = vk::QueryType::eTimestamp,
+            .queryCount = MAX_SCOPES * 2,
+    };
+
+    vk::QueryPoolCreateInfo statistics_pool_create_info = {
+            .sType = vk::StructureType::eQueryPoolCreateInfo,
+            .queryType = vk::QueryType::ePipelineStatistics,
+            .queryCount = MAX_SCOPES,
+            .pipelineStatistics = STATISTIC_FLAGS,
+    };
+
+    _slots.resize(slot_count);
+    for (auto &slot : _slots)
+    {
+        slot.timestamp_pool = _device.createQueryPoolUnique(timestamp_pool_create_info);
+        if (_pipeline_statistics)
+            slot.statistics_pool = _device.createQueryPoolUnique(statistics_pool_create_info);
+    }
+}
+
+void GpuProfiler::begin(vk::CommandBuffer command_buffer, uint32_t slot)
+{
+    if (!_enabled)
+        return;
+
+    auto &s = _slots.at(slot);
+    s.scopes.clear();
+    s.statistics_count = 0;
+
+    command_buffer.resetQueryPool(*s.timestamp_pool, 0, MAX_SCOPES * 2);
+    if (_pipeline_statistics)
+        command_buffer.resetQueryPool(*s.statistics_pool, 0, MAX_SCOPES);
+}
+
+uint32_t GpuProfiler::begin_scope(vk::CommandBuffer command_buffer, uint32_t slot, std::string_view name, bool statistics)
+{
+    if (!_enabled)
+        return 0;
+
+    auto &s = _slots.at(slot);
+    checkf_DEBUG(s.scopes.size() < MAX_SCOPES, "gpu profiler out of scopes");
+
+    auto scope = static_cast<uint32_t>(s.scopes.size());
+    int32_t statistics_query = -1;
+
+    if (statistics && _pipeline_statistics)
+    {
+        statistics_query = static_cast<int32_t>(s.statistics_count++);
+        command_buffer.beginQuery(*s.statistics_pool, statistics_query, {});
+    }
+
+    command_buffer.writeTimestamp2(vk::PipelineStageFlagBits2::eNone, *s.timestamp_pool, scope * 2);
+    s.scopes.push_back({ std::string(name), statistics_query });
+    return scope;
+}
+
+void GpuProfiler::end_scope(vk::CommandBuffer command_buffer, uint32_t slot, uint32_t scope)
+{
+    if (!_enabled)
+        return;
+
+    auto &s = _slots.at(slot);
+    command_buffer.writeTimestamp2(vk::PipelineStageFlagBits2::eAllCommands, *s.timestamp_pool, scope * 2 + 1);
+
+    if (s.scopes[scope].statistics_query >= 0)
+        command_buffer.endQuery(*s.statistics_pool, s.scopes[scope].statistics_query);
+}
+
+void GpuProfiler::collect(uint32_t slot, uint64_t frame, double cpu_ms)
+{
+    if (!_enabled)
+        return;
+
+    auto &s = _slots.at(slot);
+    if (s.scopes.empty())
+        return;
+
+    auto query_count = static_cast<uint32_t>(s.scopes.size() * 2);
+    constexpr auto flags = vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability;
+
+    // [value, availability] per query, eNotReady is expected for unavailable queries and never waited on
+    auto timestamps = _device.getQueryPoolResults<uint64_t>(
+            *s.timestamp_pool, 0, query_count, query_count * 2 * sizeof(uint64_t), 2 * sizeof(uint64_t), flags).value;
+
+    std::vector<uint64_t> statistics;
+    constexpr auto stat_stride = GPU_STATISTIC_NAMES.size() + 1;
+    if (s.statistics_count > 0)
+    {
+        statistics = _device.getQueryPoolResults<uint64_t>(
+                *s.statistics_pool, 0, s.statistics_count,
+                s.statistics_count * stat_stride * sizeof(uint64_t), stat_stride * sizeof(uint64_t), flags).value;
+    }
+
+    _results.clear();
+    uint64_t first = std::numeric_limits<uint64_t>::max();
+    uint64_t last = 0;
+
+    for (uint32_t i = 0; i < s.scopes.size(); i++)
+    {
+        uint64_t begin = timestamps[i * 4 + 0] & _timestamp_mask;
+        uint64_t end = timestamps[i * 4 + 2] & _timestamp_mask;
+        bool available = timestamps[i * 4 + 1] != 0 && timestamps[i * 4 + 3] != 0;
+        if (!available || end < begin)
+            continue;
+
+        first = std::min(first, begin);
+        last = std::max(last, end);
+
+        GpuScopeResult result = {
+                .name = s.scopes[i].name,
+                .gpu_ms = double(end - begin) * _timestamp_period / 1e6,
+        };
+
+        auto query = s.scopes[i].statistics_query;
+        if (query >= 0 && statistics[query * stat_stride + GPU_STATISTIC_NAMES.size()] != 0)
+        {
+            result.has_statistics = true;
+            std::copy_n(statistics.begin() + query * stat_stride, GPU_STATISTIC_NAMES.size(), result.statistics.begin());
+        }
+
+        _results.emplace_back(std::move(result));
+    }
+
+    _results_frame = frame;
+    _frame_cpu_ms = cpu_ms;
+    _frame_gpu_ms = last > first ? double(last - first) * _timestamp_period / 1e6 : 0.0;
+
+    if (_csv.is_open())
+        write_csv();
+}
+
+void GpuProfiler::open_csv(const char *path)
+{
+    _csv.open(path, std::ios::trunc);
+    checkf(_csv.is_open(), "gpu profiler cannot open '%s'", path);
+
+    _csv << "frame,scope,cpu_ms,gpu_ms";
+    for (const auto *stat_name : GPU_STATISTIC_NAMES)
+        _csv << ',' << stat_name;
+    _csv << '\n';
+}
+
+void GpuProfiler::write_csv()
+{
+    // whole frame row first so cpu and gpu time line up, then one row per scope
+    _csv << _results_frame << ",frame," << _frame_cpu_ms << ',' << _frame_gpu_ms
+         << std::string(GPU_STATISTIC_NAMES.size(), ',') << '\n';
+
+    for (const auto &result : _results)
+    {
+        _csv << _results_frame << ',' << result.name << ",," << result.gpu_ms;
+        for (auto stat : result.statistics)
+        {
+            _csv << ',';
+            if (result.has_statistics)
+                _csv << stat;
+        }
+        _csv << '\n';
+    }
+}
+
+} // venture::vulkan
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <array>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DeviceProfile.hpp"
+
+namespace venture::vulkan {
+
+/** Pipeline statistics gathered by statistics scopes, in result order */
+constexpr static std::array<const char *, 6> GPU_STATISTIC_NAMES = {
+        "ia_vertices",
+        "ia_primitives",
+        "vs_invocations",
+        "clip_invocations",
+        "clip_primitives",
+        "fs_invocations",
+};
+
+/** Resolved timing of a single named scope */
+struct GpuScopeResult
+{
+    std::string name;
+    double gpu_ms = 0.0;
+    bool has_statistics = false;
+    std::array<uint64_t, GPU_STATISTIC_NAMES.size()> statistics = {};
+};
+
+/**
+ * Query pool based GPU profiler
+ *
+ * Every slot (one per command buffer) owns its own query pools. Scopes are written when the command buffer is
+ * recorded and read back with collect() once the submission has completed, so results are as many frames
+ * latent as there are frames in flight and reading never stalls the GPU.
+ */
+class GpuProfiler
+{
+public:
+    GpuProfiler(
+            vk::Device device,
+            const DeviceProfile &profile,
+            uint32_t queue_family_index,
+            uint32_t slot_count,
+            bool pipeline_statistics);
+
+    /** reset the slot's queries, must be recorded before any scope and outside a render pass */
+    void begin(vk::CommandBuffer command_buffer, uint32_t slot);
+    [[nodiscard]]
+    uint32_t begin_scope(vk::CommandBuffer command_buffer, uint32_t slot, std::string_view name, bool statistics = false);
+    void end_scope(vk::CommandBuffer command_buffer, uint32_t slot, uint32_t scope);
+
+    /** read back a slot whose submission has completed, scopes that are not yet available are dropped */
+    void collect(uint32_t slot, uint64_t frame, double cpu_ms);
+
+    /** append every collected frame to a csv file */
+    void open_csv(const char *path);
+
+    [[nodiscard]]
+    inline bool enabled() const noexcept;
+    /** what secondaries executed inside a statistics scope must inherit, empty when statistics are off */
+    [[nodiscard]]
+    inline vk::QueryPipelineStatisticFlags statistics_flags() const noexcept;
+    [[nodiscard]]
+    inline const std::vector<GpuScopeResult> &results() const noexcept;
+    [[nodiscard]]
+    inline uint64_t results_frame() const noexcept;
+    [[nodiscard]]
+    inline double frame_gpu_ms() const noexcept;
+    [[nodiscard]]
+    inline double frame_cpu_ms() const noexcept;
+
+private:
+    struct Scope
+    {
+        std::string name;
+        int32_t statistics_query = -1;
+    };
+
+    struct Slot
+    {
+        vk::UniqueQueryPool timestamp_pool;
+        vk::UniqueQueryPool statistics_pool;
+        std::vector<Scope> scopes;
+        uint32_t statistics_count = 0;
+    };
+
+    void write_csv();
+
+private:
+    vk::Device _device;
+    std::vector<Slot> _slots;
+    double _timestamp_period = 0.0; // nanoseconds per tick
+    uint64_t _timestamp_mask = ~0ULL;
+    bool _enabled = false;
+    bool _pipeline_statistics = false;
+
+    std::vector<GpuScopeResult> _results;
+    uint64_t _results_frame = 0;
+    double _frame_gpu_ms = 0.0;
+    double _frame_cpu_ms = 0.0;
+    std::ofstream _csv;
+
+    constexpr static uint32_t MAX_SCOPES = 32;
+    // must list GPU_STATISTIC_NAMES in order
+    constexpr static vk::QueryPipelineStatisticFlags STATISTIC_FLAGS =
+            vk::QueryPipelineStatisticFlagBits::eInputAssemblyVertices |
+            vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives |
+            vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+            vk::QueryPipelineStatisticFlagBits::eClippingInvocations |
+            vk::QueryPipelineStatisticFlagBits::eClippingPrimitives |
+            vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations;
+};
+
+bool GpuProfiler::enabled() const noexcept { return _enabled; }
+vk::QueryPipelineStatisticFlags GpuProfiler::statistics_flags() const noexcept
+{
+    return _pipeline_statistics ? STATISTIC_FLAGS : vk::QueryPipelineStatisticFlags();
+}
+const std::vector<GpuScopeResult> &GpuProfiler::results() const noexcept { return _results; }
+uint64_t GpuProfiler::results_frame() const noexcept { return _results_frame; }
+double GpuProfiler::frame_gpu_ms() const noexcept { return _frame_gpu_ms; }
+double GpuProfiler::frame_cpu_ms() const noexcept { return _frame_cpu_ms; }
+
+} // venture::vulkan
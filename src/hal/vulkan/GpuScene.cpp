@@ -0,0 +1,192 @@
+#include "GpuScene.hpp"
+#include <algorithm>
+#include "error_handling/Check.hpp"
+
+namespace venture::vulkan {
+
+GpuScene::GpuScene(DeviceAllocator *allocator, StagingUploader *uploader, BindlessHeap *heap)
+        : _allocator(allocator),
+          _uploader(uploader),
+          _heap(heap)
+{
+}
+
+GpuScene::~GpuScene()
+{
+    remove_from_heap();
+}
+
+uint32_t GpuScene::add_object(uint32_t mesh, const glm::mat4 &model)
+{
+    _objects.push_back({ .model = model, .mesh = mesh });
+    return static_cast<uint32_t>(_objects.size() - 1);
+}
+
+void GpuScene::build(std::span<const Mesh> meshes)
+{
+    //--- Regions
+    // a mesh's region holds every one of its objects, the worst case of nothing being culled
+    _mesh_capacities.assign(meshes.size(), 0);
+    for (auto &object : _objects)
+    {
+        check(object.mesh < meshes.size());
+        object.bounds = meshes[object.mesh].bounds;
+        _mesh_capacities[object.mesh]++;
+    }
+
+    _mesh_draws.clear();
+    uint32_t command_offset = 0;
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        const auto &lods = meshes[i].lods;
+        check(!lods.empty() && lods.size() <= MAX_MESH_LODS);
+
+        auto &draw = _mesh_draws.emplace_back();
+        draw.vertex_offset = 0;
+        draw.command_offset = command_offset;
+        draw.lod_count = static_cast<uint32_t>(lods.size());
+        for (size_t l = 0; l < lods.size(); l++)
+        {
+            draw.lods[l] = {
+                    .index_count = lods[l].index_count,
+                    .first_index = lods[l].first_index,
+                    .error = lods[l].error,
+                    .padding = 0,
+            };
+        }
+        command_offset += _mesh_capacities[i];
+    }
+
+    //--- Buffers
+    // never zero sized so the descriptors stay valid for an empty scene
+    auto make_buffer = [this](vk::DeviceSize size, vk::BufferUsageFlags usage) {
+        vk::BufferCreateInfo buffer_create_info = {
+                .sType = vk::StructureType::eBufferCreateInfo,
+                .size = std::max<vk::DeviceSize>(size, 16),
+                .usage = usage | vk::BufferUsageFlagBits::eStorageBuffer,
+                .sharingMode = vk::SharingMode::eExclusive,
+        };
+        return _allocator->create_buffer(buffer_create_info, MemoryUsage::eGpuOnly);
+    };
+
+    _object_buffer = make_buffer(
+            _objects.size() * sizeof(ObjectData),
+            vk::BufferUsageFlagBits::eTransferDst);
+    _mesh_draw_buffer = make_buffer(
+            _mesh_draws.size() * sizeof(MeshDrawData),
+            vk::BufferUsageFlagBits::eTransferDst);
+    _command_buffer = make_buffer(
+            command_offset * sizeof(vk::DrawIndexedIndirectCommand),
+            vk::BufferUsageFlagBits::eIndirectBuffer);
+    _count_buffer = make_buffer(
+            meshes.size() * sizeof(uint32_t),
+            vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst);
+
+    if (!_objects.empty())
+    {
+        _uploader->upload(
+                *_object_buffer.buffer, 0, std::as_bytes(std::span(_objects)),
+                vk::PipelineStageFlagBits2::eComputeShader | vk::PipelineStageFlagBits2::eVertexShader,
+                vk::AccessFlagBits2::eShaderStorageRead);
+    }
+    if (!_mesh_draws.empty())
+    {
+        _uploader->upload(
+                *_mesh_draw_buffer.buffer, 0, std::as_bytes(std::span(_mesh_draws)),
+                vk::PipelineStageFlagBits2::eComputeShader,
+                vk::AccessFlagBits2::eShaderStorageRead);
+    }
+    _ticket = _uploader->pending_ticket();
+
+    //--- Bindless slots
+    // the previous build's slots are recycled once the frames still using them have completed
+    remove_from_heap();
+    _push_constants = {
+            .objects = _heap->add_buffer(*_object_buffer.buffer),
+            .mesh_draws = _heap->add_buffer(*_mesh_draw_buffer.buffer),
+            .draw_commands = _heap->add_buffer(*_command_buffer.buffer),
+            .draw_counts = _heap->add_buffer(*_count_buffer.buffer),
+    };
+    _in_heap = true;
+}
+
+void GpuScene::record_cull(vk::CommandBuffer command_buffer) const
+{
+    if (!is_ready())
+        return;
+
+    // the previous frame's indirect draws still read the commands and counts, an execution dependency covers it
+    vk::MemoryBarrier2 reuse_barrier = {
+            .sType = vk::StructureType::eMemoryBarrier2,
+            .srcStageMask = vk::PipelineStageFlagBits2::eDrawIndirect,
+            .dstStageMask = vk::PipelineStageFlagBits2::eClear | vk::PipelineStageFlagBits2::eComputeShader,
+    };
+    command_buffer.pipelineBarrier2({
+            .sType = vk::StructureType::eDependencyInfo,
+            .memoryBarrierCount = 1,
+            .pMemoryBarriers = &reuse_barrier,
+    });
+
+    command_buffer.fillBuffer(*_count_buffer.buffer, 0, VK_WHOLE_SIZE, 0);
+
+    vk::MemoryBarrier2 clear_barrier = {
+            .sType = vk::StructureType::eMemoryBarrier2,
+            .srcStageMask = vk::PipelineStageFlagBits2::eClear,
+            .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+            .dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+            .dstAccessMask = vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite,
+    };
+    command_buffer.pipelineBarrier2({
+            .sType = vk::StructureType::eDependencyInfo,
+            .memoryBarrierCount = 1,
+            .pMemoryBarriers = &clear_barrier,
+    });
+
+    auto group_count = (object_count() + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE;
+    if (group_count > 0)
+        command_buffer.dispatch(group_count, 1, 1);
+}
+
+void GpuScene::record_draws(
+        vk::CommandBuffer command_buffer,
+        std::span<const Mesh> meshes,
+        uint32_t first_mesh,
+        uint32_t last_mesh) const
+{
+    constexpr uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand);
+
+    // the counts are only written by a culling pass that ran
+    if (!is_ready())
+        return;
+
+    last_mesh = std::min({ last_mesh, static_cast<uint32_t>(meshes.size()), static_cast<uint32_t>(_mesh_draws.size()) });
+    for (uint32_t i = first_mesh; i < last_mesh; i++)
+    {
+        // uploads of a mesh added after the scene was built may still be in flight
+        if (_mesh_capacities[i] == 0 || !_uploader->is_ready(meshes[i].ticket))
+            continue;
+
+        meshes[i].bind(command_buffer);
+        command_buffer.drawIndexedIndirectCount(
+                *_command_buffer.buffer,
+                _mesh_draws[i].command_offset * stride,
+                *_count_buffer.buffer,
+                i * sizeof(uint32_t),
+                _mesh_capacities[i],
+                stride);
+    }
+}
+
+void GpuScene::remove_from_heap()
+{
+    if (!_in_heap)
+        return;
+
+    _heap->remove_buffer(_push_constants.objects);
+    _heap->remove_buffer(_push_constants.mesh_draws);
+    _heap->remove_buffer(_push_constants.draw_commands);
+    _heap->remove_buffer(_push_constants.draw_counts);
+    _in_heap = false;
+}
+
+} // venture::vulkan
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include "BindlessHeap.hpp"
+#include "DeviceAllocator.hpp"
+#include "Mesh.hpp"
+#include "ShaderInterface.hpp"
+#include "StagingUploader.hpp"
+
+namespace venture::vulkan {
+
+/**
+ * Object and draw records resident on the GPU, culled and turned into indirect draws by shaders/cull.comp
+ *
+ * Every mesh owns a region of the indirect command buffer sized for all of its objects, the culling pass appends the
+ * visible ones to that region and bumps the mesh's count, so drawing the scene costs one drawIndexedIndirectCount per
+ * mesh no matter how many objects there are. The same pass picks each visible object's LOD from its projected error,
+ * LODs share the mesh's buffers so the pick only changes the index range of the command. The buffers are reached through the bindless heap, push_constants()
+ * holds their slots.
+ */
+class GpuScene
+{
+public:
+    constexpr static uint32_t CULL_GROUP_SIZE = 64; // local_size_x of shaders/cull.comp
+
+    GpuScene(DeviceAllocator *allocator, StagingUploader *uploader, BindlessHeap *heap);
+    ~GpuScene();
+
+    GpuScene(const GpuScene&) = delete;
+    void operator=(const GpuScene&) = delete;
+
+    /** returns the object index, nothing reaches the GPU until build() */
+    uint32_t add_object(uint32_t mesh, const glm::mat4 &model);
+
+    /** (re)create the buffers and queue their upload, culling and drawing skip the scene until is_ready() */
+    void build(std::span<const Mesh> meshes);
+
+    /**
+     * clear counts and cull, cull pipeline, sets and push_constants() must be bound. Making the results visible to
+     * indirect draws is up to the caller, the render graph does it from the pass declaring draw_commands() and
+     * draw_counts() written. Records nothing until is_ready().
+     */
+    void record_cull(vk::CommandBuffer command_buffer) const;
+    /**
+     * one indirect draw per mesh in [first_mesh, last_mesh), graphics pipeline, sets and push constants must be bound.
+     * Meshes whose upload ticket is not ready yet are skipped, nothing is drawn until is_ready()
+     */
+    void record_draws(
+            vk::CommandBuffer command_buffer,
+            std::span<const Mesh> meshes,
+            uint32_t first_mesh = 0,
+            uint32_t last_mesh = UINT32_MAX) const;
+
+    /** the buffers queued by the last build() have reached graphics */
+    [[nodiscard]]
+    inline bool is_ready() const noexcept;
+    /** slots of the scene's buffers in the bindless heap, valid after build() */
+    [[nodiscard]]
+    inline const PushConstants &push_constants() const noexcept;
+    [[nodiscard]]
+    inline uint32_t object_count() const noexcept;
+    /** written by the culling pass, read by indirect draws */
+    [[nodiscard]]
+    inline vk::Buffer draw_commands() const noexcept;
+    [[nodiscard]]
+    inline vk::Buffer draw_counts() const noexcept;
+
+private:
+    void remove_from_heap();
+
+private:
+    DeviceAllocator *_allocator;
+    StagingUploader *_uploader;
+    BindlessHeap *_heap;
+
+    PushConstants _push_constants = {};
+    bool _in_heap = false;
+    UploadTicket _ticket = 0; // of the last build()
+
+    std::vector<ObjectData> _objects;
+    std::vector<MeshDrawData> _mesh_draws;
+    std::vector<uint32_t> _mesh_capacities;
+
+    AllocatedBuffer _object_buffer;
+    AllocatedBuffer _mesh_draw_buffer;
+    AllocatedBuffer _command_buffer;
+    AllocatedBuffer _count_buffer;
+};
+
+bool GpuScene::is_ready() const noexcept { return _in_heap && _uploader->is_ready(_ticket); }
+const PushConstants &GpuScene::push_constants() const noexcept { return _push_constants; }
+uint32_t GpuScene::object_count() const noexcept { return static_cast<uint32_t>(_objects.size()); }
+vk::Buffer GpuScene::draw_commands() const noexcept { return *_command_buffer.buffer; }
+vk::Buffer GpuScene::draw_counts() const noexcept { return *_count_buffer.buffer; }
+
+} // venture::vulkan
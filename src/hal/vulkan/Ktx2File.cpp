@@ -0,0 +1,171 @@
+#include "Ktx2File.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include "error_handling/Check.hpp"
+
+namespace venture::vulkan {
+
+namespace {
+
+constexpr uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+struct BlockInfo
+{
+    uint32_t extent = 0; // square blocks, 0 for formats we can't upload
+    uint32_t bytes = 0;
+};
+
+// block sizes all divide the staging ring's 16 byte alignment, copies need offsets aligned to them
+BlockInfo block_info(vk::Format format)
+{
+    switch (format)
+    {
+        case vk::Format::eR8Unorm:
+            return { 1, 1 };
+        case vk::Format::eR8G8Unorm:
+            return { 1, 2 };
+        case vk::Format::eR8G8B8A8Unorm:
+        case vk::Format::eR8G8B8A8Srgb:
+        case vk::Format::eB8G8R8A8Unorm:
+        case vk::Format::eB8G8R8A8Srgb:
+            return { 1, 4 };
+        case vk::Format::eR16G16B16A16Sfloat:
+            return { 1, 8 };
+        case vk::Format::eR32G32B32A32Sfloat:
+            return { 1, 16 };
+        case vk::Format::eBc1RgbUnormBlock:
+        case vk::Format::eBc1RgbSrgbBlock:
+        case vk::Format::eBc1RgbaUnormBlock:
+        case vk::Format::eBc1RgbaSrgbBlock:
+        case vk::Format::eBc4UnormBlock:
+        case vk::Format::eBc4SnormBlock:
+            return { 4, 8 };
+        case vk::Format::eBc2UnormBlock:
+        case vk::Format::eBc2SrgbBlock:
+        case vk::Format::eBc3UnormBlock:
+        case vk::Format::eBc3SrgbBlock:
+        case vk::Format::eBc5UnormBlock:
+        case vk::Format::eBc5SnormBlock:
+        case vk::Format::eBc6HUfloatBlock:
+        case vk::Format::eBc6HSfloatBlock:
+        case vk::Format::eBc7UnormBlock:
+        case vk::Format::eBc7SrgbBlock:
+            return { 4, 16 };
+        default:
+            return {};
+    }
+}
+
+} // anonymous
+
+Result<Ktx2File> Ktx2File::open(const std::filesystem::path &path)
+{
+    std::ifstream ifs(path, std::ios::binary); // raii
+    if (!ifs.is_open())
+        return Error(error_view("ktx2 file cannot be opened"));
+
+    FileHeader header = {};
+    ifs.read(reinterpret_cast<char *>(&header), sizeof header);
+    if (!ifs || std::memcmp(header.identifier, KTX2_IDENTIFIER, sizeof KTX2_IDENTIFIER) != 0)
+        return Error(error_view("ktx2 identifier mismatch"));
+
+    if (header.supercompression_scheme != 0)
+        return Error(error_view("ktx2 supercompression is not supported"));
+    if (header.pixel_depth > 1 || header.layer_count > 1 || header.face_count != 1)
+        return Error(error_view("ktx2 only single 2D images are supported"));
+
+    auto format = static_cast<vk::Format>(header.vk_format);
+    auto block = block_info(format);
+    if (block.extent == 0)
+        return Error(error_view("ktx2 format is not supported"));
+
+    // a level count of 0 asks the loader to generate mips, we only ever upload what is there. Levels past the 1x1 one
+    // don't exist, the cap also keeps a corrupt count from sizing the level index
+    uint32_t level_count = std::max(header.level_count, 1u);
+    if (level_count > std::bit_width(std::max(header.pixel_width, header.pixel_height)))
+        return Error(error_view("ktx2 level count out of range"));
+    std::vector<FileLevel> file_levels(level_count);
+    ifs.read(reinterpret_cast<char *>(file_levels.data()), static_cast<std::streamsize>(level_count * sizeof(FileLevel)));
+    if (!ifs)
+        return Error(error_view("ktx2 level index truncated"));
+
+    ifs.seekg(0, std::ios::end);
+    auto file_size = static_cast<uint64_t>(ifs.tellg());
+
+    Ktx2File file;
+    file._path = path;
+    file._format = format;
+    file._block_height = block.extent;
+    file._levels.reserve(level_count);
+
+    for (uint32_t i = 0; i < level_count; i++)
+    {
+        vk::Extent2D extent = {
+                .width = std::max(header.pixel_width >> i, 1u),
+                .height = std::max(std::max(header.pixel_height, 1u) >> i, 1u),
+        };
+
+        uint64_t blocks_x = (extent.width + block.extent - 1) / block.extent;
+        uint64_t blocks_y = (extent.height + block.extent - 1) / block.extent;
+        const auto &file_level = file_levels[i];
+        if (file_level.byte_length != blocks_x * blocks_y * block.bytes)
+            return Error(error_view("ktx2 level size mismatch"));
+        if (file_level.byte_offset > file_size || file_level.byte_length > file_size - file_level.byte_offset)
+            return Error(error_view("ktx2 level out of range"));
+
+        file._levels.push_back({
+                .offset = file_level.byte_offset,
+                .size = file_level.byte_length,
+                .extent = extent,
+        });
+    }
+
+    return file;
+}
+
+Result<std::vector<std::byte>> Ktx2File::read_levels(uint32_t first_level) const
+{
+    check(first_level < _levels.size());
+
+    // the smallest level comes first in the file, so the requested levels are one range with padding in between
+    uint64_t begin = UINT64_MAX;
+    uint64_t end = 0;
+    for (uint32_t i = first_level; i < _levels.size(); i++)
+    {
+        begin = std::min(begin, _levels[i].offset);
+        end = std::max(end, _levels[i].offset + _levels[i].size);
+    }
+
+    std::vector<std::byte> range(end - begin);
+    {
+        std::ifstream ifs(_path, std::ios::binary); // raii
+        ifs.seekg(static_cast<std::streamoff>(begin));
+        ifs.read(reinterpret_cast<char *>(range.data()), static_cast<std::streamsize>(range.size()));
+        // the file may have changed or gone since open()
+        if (!ifs)
+            return Error(error_view("ktx2 level data cannot be read"));
+    }
+
+    std::vector<std::byte> levels;
+    levels.reserve(level_bytes(first_level));
+    for (uint32_t i = first_level; i < _levels.size(); i++)
+    {
+        auto first = range.begin() + static_cast<std::ptrdiff_t>(_levels[i].offset - begin);
+        levels.insert(levels.end(), first, first + static_cast<std::ptrdiff_t>(_levels[i].size));
+    }
+    return levels;
+}
+
+uint64_t Ktx2File::level_bytes(uint32_t first_level) const noexcept
+{
+    uint64_t bytes = 0;
+    for (uint32_t i = first_level; i < _levels.size(); i++)
+    {
+        bytes += _levels[i].size;
+    }
+    return bytes;
+}
+
+} // venture::vulkan
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <filesystem>
+#include <vector>
+#include "error_handling/Result.hpp"
+
+namespace venture::vulkan {
+
+/**
+ * Header and level index of a KTX2 texture, level data is read on demand
+ *
+ * Only what the texture streamer can upload as is: single 2D images without supercompression in an uncompressed or
+ * BC format whose block size divides the staging alignment. Level 0 is the largest, the file stores the smallest
+ * level first so the mip tail is one contiguous read. Immutable after open(), read_levels() is thread safe.
+ */
+class Ktx2File
+{
+public:
+    struct Level
+    {
+        uint64_t offset = 0; // in the file
+        uint64_t size = 0;
+        vk::Extent2D extent;
+    };
+
+    [[nodiscard]]
+    static Result<Ktx2File> open(const std::filesystem::path &path);
+
+    /** levels [first_level, level_count()) back to back in level order, opens its own stream */
+    [[nodiscard]]
+    Result<std::vector<std::byte>> read_levels(uint32_t first_level) const;
+
+    /** bytes of levels [first_level, level_count()) */
+    [[nodiscard]]
+    uint64_t level_bytes(uint32_t first_level) const noexcept;
+
+    [[nodiscard]]
+    inline const std::filesystem::path &path() const noexcept;
+    [[nodiscard]]
+    inline vk::Format format() const noexcept;
+    [[nodiscard]]
+    inline uint32_t block_height() const noexcept;
+    [[nodiscard]]
+    inline uint32_t level_count() const noexcept;
+    [[nodiscard]]
+    inline const Level &level(uint32_t index) const noexcept;
+
+private:
+    struct FileHeader
+    {
+        uint8_t identifier[12];
+        uint32_t vk_format;
+        uint32_t type_size;
+        uint32_t pixel_width;
+        uint32_t pixel_height;
+        uint32_t pixel_depth;
+        uint32_t layer_count;
+        uint32_t face_count;
+        uint32_t level_count;
+        uint32_t supercompression_scheme;
+        uint32_t dfd_byte_offset;
+        uint32_t dfd_byte_length;
+        uint32_t kvd_byte_offset;
+        uint32_t kvd_byte_length;
+        uint64_t sgd_byte_offset;
+        uint64_t sgd_byte_length;
+    };
+
+    struct FileLevel
+    {
+        uint64_t byte_offset;
+        uint64_t byte_length;
+        uint64_t uncompressed_byte_length;
+    };
+
+private:
+    std::filesystem::path _path;
+    vk::Format _format = vk::Format::eUndefined;
+    uint32_t _block_height = 1;
+    std::vector<Level> _levels;
+};
+
+const std::filesystem::path &Ktx2File::path() const noexcept { return _path; }
+vk::Format Ktx2File::format() const noexcept { return _format; }
+uint32_t Ktx2File::block_height() const noexcept { return _block_height; }
+uint32_t Ktx2File::level_count() const noexcept { return static_cast<uint32_t>(_levels.size()); }
+const Ktx2File::Level &Ktx2File::level(uint32_t index) const noexcept { return _levels[index]; }
+
+} // venture::vulkan
@@ -0,0 +1,150 @@
+#include "Mesh.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include "ShaderInterface.hpp"
+#include "error_handling/Check.hpp"
+
+namespace venture::vulkan {
+
+namespace {
+
+// exclusive ownership, the uploader transfers it from the transfer family to graphics when they differ
+void create_buffers(
+        Mesh &mesh,
+        DeviceAllocator *allocator,
+        StagingUploader *uploader,
+        std::span<const std::byte> vertices,
+        std::span<const std::byte> indices)
+{
+    // Vulkan has no zero sized buffers
+    checkf(!vertices.empty() && !indices.empty(), "mesh without vertices or indices");
+
+    vk::BufferCreateInfo vertex_buffer_create_info = {
+            .sType = vk::StructureType::eBufferCreateInfo,
+            .size = vertices.size(),
+            .usage = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst,
+            .sharingMode = vk::SharingMode::eExclusive,
+    };
+    mesh.vertex_buffer = allocator->create_buffer(vertex_buffer_create_info, MemoryUsage::eGpuOnly);
+
+    vk::BufferCreateInfo index_buffer_create_info = {
+            .sType = vk::StructureType::eBufferCreateInfo,
+            .size = indices.size(),
+            .usage = vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst,
+            .sharingMode = vk::SharingMode::eExclusive,
+    };
+    mesh.index_buffer = allocator->create_buffer(index_buffer_create_info, MemoryUsage::eGpuOnly);
+
+    uploader->upload(
+            *mesh.vertex_buffer.buffer, 0, vertices,
+            vk::PipelineStageFlagBits2::eVertexAttributeInput, vk::AccessFlagBits2::eVertexAttributeRead);
+    uploader->upload(
+            *mesh.index_buffer.buffer, 0, indices,
+            vk::PipelineStageFlagBits2::eIndexInput, vk::AccessFlagBits2::eIndexRead);
+
+    mesh.index_count = static_cast<uint32_t>(indices.size() / sizeof(uint32_t));
+    mesh.ticket = uploader->pending_ticket();
+}
+
+} // anonymous
+
+// cooked vertices are uploaded as they are, the layouts must match byte for byte
+static_assert(sizeof(Vertex) == sizeof(assets::CookedVertex));
+static_assert(offsetof(Vertex, position) == offsetof(assets::CookedVertex, position));
+static_assert(offsetof(Vertex, color) == offsetof(assets::CookedVertex, color));
+static_assert(MAX_MESH_LODS == assets::MESH_MAX_LODS);
+
+std::array<vk::VertexInputBindingDescription, 1> Vertex::bindings()
+{
+    return {
+            vk::VertexInputBindingDescription {
+                    .binding = 0,
+                    .stride = sizeof(Vertex),
+                    .inputRate = vk::VertexInputRate::eVertex,
+            },
+    };
+}
+
+std::array<vk::VertexInputAttributeDescription, 2> Vertex::attributes()
+{
+    return {
+            vk::VertexInputAttributeDescription {
+                    .location = 0,
+                    .binding = 0,
+                    .format = vk::Format::eR32G32B32Sfloat,
+                    .offset = offsetof(Vertex, position),
+            },
+            vk::VertexInputAttributeDescription {
+                    .location = 1,
+                    .binding = 0,
+                    .format = vk::Format::eR32G32B32Sfloat,
+                    .offset = offsetof(Vertex, color),
+            },
+    };
+}
+
+Mesh Mesh::create(
+        DeviceAllocator *allocator,
+        StagingUploader *uploader,
+        std::span<const Vertex> vertices,
+        std::span<const uint32_t> indices)
+{
+    Mesh mesh;
+    create_buffers(mesh, allocator, uploader, std::as_bytes(vertices), std::as_bytes(indices));
+    mesh.lods.push_back({ .first_index = 0, .index_count = mesh.index_count, .error = 0.0f });
+
+    // sphere around the box center, looser than a minimal sphere but one pass and good enough for culling
+    glm::vec3 min_corner(std::numeric_limits<float>::max());
+    glm::vec3 max_corner(std::numeric_limits<float>::lowest());
+    for (const auto &vertex : vertices)
+    {
+        min_corner = glm::min(min_corner, vertex.position);
+        max_corner = glm::max(max_corner, vertex.position);
+    }
+
+    glm::vec3 center = vertices.empty() ? glm::vec3(0.0f) : (min_corner + max_corner) * 0.5f;
+    float radius = 0.0f;
+    for (const auto &vertex : vertices)
+    {
+        radius = std::max(radius, glm::length(vertex.position - center));
+    }
+    mesh.bounds = glm::vec4(center, radius);
+    return mesh;
+}
+
+Mesh Mesh::create(
+        DeviceAllocator *allocator,
+        StagingUploader *uploader,
+        const assets::MeshFile &file,
+        uint32_t mesh_index)
+{
+    Mesh mesh;
+    create_buffers(mesh, allocator, uploader, file.vertices(mesh_index), file.indices(mesh_index));
+
+    for (const auto &lod : file.lods(mesh_index))
+    {
+        mesh.lods.push_back({ .first_index = lod.first_index, .index_count = lod.index_count, .error = lod.error });
+    }
+    mesh.index_count = mesh.lods.front().index_count;
+
+    // computed by the cooker
+    const auto &bounds = file.entry(mesh_index).bounds;
+    mesh.bounds = glm::vec4(bounds[0], bounds[1], bounds[2], bounds[3]);
+    return mesh;
+}
+
+void Mesh::bind(vk::CommandBuffer command_buffer) const
+{
+    vk::DeviceSize offset = 0;
+    command_buffer.bindVertexBuffers(0, *vertex_buffer.buffer, offset);
+    command_buffer.bindIndexBuffer(*index_buffer.buffer, 0, vk::IndexType::eUint32);
+}
+
+void Mesh::draw(vk::CommandBuffer command_buffer, uint32_t draw_index) const
+{
+    bind(command_buffer);
+    command_buffer.drawIndexed(index_count, 1, 0, 0, draw_index);
+}
+
+} // venture::vulkan
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <array>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include "DeviceAllocator.hpp"
+#include "StagingUploader.hpp"
+#include "assets/MeshFile.hpp"
+
+namespace venture::vulkan {
+
+/** Interleaved vertex layout shared by every mesh, see shaders/shader.vert */
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 color;
+
+    [[nodiscard]]
+    static std::array<vk::VertexInputBindingDescription, 1> bindings();
+    [[nodiscard]]
+    static std::array<vk::VertexInputAttributeDescription, 2> attributes();
+};
+
+/** Range of a mesh's index buffer, every LOD indexes the same vertices */
+struct MeshLod
+{
+    uint32_t first_index;
+    uint32_t index_count;
+    float error; // object space bound on the distance from full detail, see MeshFileLod
+};
+
+/** Device local vertex and index buffer pair, filled through the StagingUploader */
+struct Mesh
+{
+    AllocatedBuffer vertex_buffer;
+    AllocatedBuffer index_buffer;
+    uint32_t index_count = 0; // of LOD 0
+    std::vector<MeshLod> lods; // full detail first, GpuScene's culling pass picks one per object
+    glm::vec4 bounds = {}; // object space bounding sphere, xyz center and w radius
+    UploadTicket ticket = 0; // draw only once the uploader reports it ready
+
+    /** queues the upload, the caller decides when to flush */
+    [[nodiscard]]
+    static Mesh create(
+            DeviceAllocator *allocator,
+            StagingUploader *uploader,
+            std::span<const Vertex> vertices,
+            std::span<const uint32_t> indices);
+    /** queues a straight copy of a cooked mesh and its LODs out of the mapping, nothing is converted */
+    [[nodiscard]]
+    static Mesh create(
+            DeviceAllocator *allocator,
+            StagingUploader *uploader,
+            const assets::MeshFile &file,
+            uint32_t mesh_index);
+
+    /** bind the vertex and index buffers, for callers issuing their own (indirect) draws */
+    void bind(vk::CommandBuffer command_buffer) const;
+    /** full detail, draw_index is passed as firstInstance, shaders use it to find their ObjectData */
+    void draw(vk::CommandBuffer command_buffer, uint32_t draw_index = 0) const;
+};
+
+} // venture::vulkan
@@ -0,0 +1,114 @@
+#include "ParallelRecorder.hpp"
+#include <algorithm>
+#include <exception>
+#include <future>
+
+namespace venture::vulkan {
+
+ParallelRecorder::ParallelRecorder(vk::Device device, uint32_t queue_family_index, ThreadPool *workers, uint32_t frame_count)
+        : _device(device),
+          _workers(workers)
+{
+    vk::CommandPoolCreateInfo command_pool_create_info = {
+            .sType = vk::StructureType::eCommandPoolCreateInfo,
+            .flags = vk::CommandPoolCreateFlagBits::eTransient,
+            .queueFamilyIndex = queue_family_index,
+    };
+
+    // one context per worker plus the calling thread
+    _contexts.resize(frame_count);
+    for (auto &frame_contexts : _contexts)
+    {
+        frame_contexts.resize(_workers->size() + 1);
+        for (auto &context : frame_contexts)
+        {
+            context.pool = _device.createCommandPoolUnique(command_pool_create_info);
+        }
+    }
+}
+
+void ParallelRecorder::begin_frame(uint32_t frame)
+{
+    _frame = frame;
+    for (auto &context : _contexts[_frame])
+    {
+        _device.resetCommandPool(*context.pool);
+        context.used = 0;
+    }
+}
+
+std::vector<vk::CommandBuffer> ParallelRecorder::record(
+        const vk::CommandBufferInheritanceInfo &inheritance,
+        uint32_t item_count,
+        const RecordFn &record_fn)
+{
+    auto &frame_contexts = _contexts[_frame];
+    auto context_count = static_cast<uint32_t>(frame_contexts.size());
+
+    uint32_t chunk_size = std::max(MIN_ITEMS_PER_CHUNK, (item_count + context_count - 1) / context_count);
+    uint32_t chunk_count = std::max(1U, (item_count + chunk_size - 1) / chunk_size);
+
+    // handed out up front, contexts are not touched by anyone else until the futures are joined
+    std::vector<vk::CommandBuffer> command_buffers(chunk_count);
+    for (uint32_t i = 0; i < chunk_count; i++)
+    {
+        command_buffers[i] = next_command_buffer(frame_contexts[i]);
+    }
+
+    auto record_chunk = [&](uint32_t chunk) {
+        vk::CommandBufferBeginInfo command_buffer_begin_info = {
+                .sType = vk::StructureType::eCommandBufferBeginInfo,
+                .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit |
+                         vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+                .pInheritanceInfo = &inheritance,
+        };
+
+        uint32_t first = chunk * chunk_size;
+        uint32_t last = std::min(first + chunk_size, item_count);
+
+        command_buffers[chunk].begin(command_buffer_begin_info);
+        record_fn(command_buffers[chunk], first, last);
+        command_buffers[chunk].end();
+    };
+
+    std::vector<std::future<void>> futures;
+    for (uint32_t i = 1; i < chunk_count; i++)
+    {
+        futures.emplace_back(_workers->submit([&record_chunk, i] { record_chunk(i); }));
+    }
+
+    // the workers reference this stack frame, so every one of them is joined before anything is rethrown
+    std::exception_ptr error;
+    try {
+        record_chunk(0);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    for (auto &future : futures)
+        future.wait();
+    if (error)
+        std::rethrow_exception(error);
+    for (auto &future : futures)
+        future.get();
+
+    return command_buffers;
+}
+
+vk::CommandBuffer ParallelRecorder::next_command_buffer(Context &context)
+{
+    if (context.used == context.command_buffers.size())
+    {
+        vk::CommandBufferAllocateInfo command_buffer_alloc_info = {
+                .sType = vk::StructureType::eCommandBufferAllocateInfo,
+                .commandPool = *context.pool,
+                .level = vk::CommandBufferLevel::eSecondary,
+                .commandBufferCount = 1,
+        };
+        context.command_buffers.push_back(_device.allocateCommandBuffers(command_buffer_alloc_info)[0]);
+    }
+
+    return context.command_buffers[context.used++];
+}
+
+} // venture::vulkan
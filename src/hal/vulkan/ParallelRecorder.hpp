@@ -0,0 +1,62 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <functional>
+#include <vector>
+#include "threading/ThreadPool.hpp"
+
+namespace venture::vulkan {
+
+/**
+ * Records secondary command buffers in parallel on the worker pool
+ *
+ * Command pools are externally synchronized, so every recording context owns a pool per frame in flight and a chunk
+ * of work only ever touches its own context. The frame's pools are reset wholesale by begin_frame(), secondaries are
+ * handed out again from the start of each pool instead of being freed. The calling thread records the first chunk
+ * itself so small jobs never pay for a hand off.
+ */
+class ParallelRecorder
+{
+public:
+    /** record the draws of items [first, last) into command_buffer, called concurrently from different threads */
+    using RecordFn = std::function<void(vk::CommandBuffer command_buffer, uint32_t first, uint32_t last)>;
+
+    ParallelRecorder(vk::Device device, uint32_t queue_family_index, ThreadPool *workers, uint32_t frame_count);
+
+    ParallelRecorder(const ParallelRecorder&) = delete;
+    void operator=(const ParallelRecorder&) = delete;
+
+    /** the frame's submission must have completed, every secondary recorded for it before is invalidated */
+    void begin_frame(uint32_t frame);
+
+    /**
+     * split [0, item_count) across the contexts and record each chunk into a secondary continuing the render pass
+     * described by inheritance, returns them in item order ready for executeCommands
+     */
+    [[nodiscard]]
+    std::vector<vk::CommandBuffer> record(
+            const vk::CommandBufferInheritanceInfo &inheritance,
+            uint32_t item_count,
+            const RecordFn &record_fn);
+
+private:
+    struct Context
+    {
+        vk::UniqueCommandPool pool;
+        std::vector<vk::CommandBuffer> command_buffers; // freed with the pool
+        uint32_t used = 0;
+    };
+
+    vk::CommandBuffer next_command_buffer(Context &context);
+
+private:
+    vk::Device _device;
+    ThreadPool *_workers;
+    std::vector<std::vector<Context>> _contexts; // [frame][context]
+    uint32_t _frame = 0;
+
+    // below this many items per chunk the hand off costs more than the recording
+    constexpr static uint32_t MIN_ITEMS_PER_CHUNK = 32;
+};
+
+} // venture::vulkan
@@ -0,0 +1,147 @@
+#include "PipelineCache.hpp"
+#include <cstring>
+#include <fstream>
+#include "error_handling/Log.hpp"
+
+namespace venture::vulkan {
+
+PipelineCache::PipelineCache(vk::Device device, const DeviceProfile &profile, std::filesystem::path path)
+        : _device(device),
+          _device_props(profile.properties()),
+          _path(std::move(path))
+{
+    auto data = load();
+
+    vk::PipelineCacheCreateInfo pipeline_cache_create_info = {
+            .sType = vk::StructureType::ePipelineCacheCreateInfo,
+            .initialDataSize = data.size(),
+            .pInitialData = data.empty() ? nullptr : data.data(),
+    };
+
+    _cache = _device.createPipelineCacheUnique(pipeline_cache_create_info);
+}
+
+PipelineCache::~PipelineCache()
+{
+    // never throw out of a destructor, losing the cache only costs startup time
+    try {
+        save();
+    } catch (const std::exception &e) {
+        log(Warning, "pipeline cache not saved " << e.what());
+    }
+}
+
+void PipelineCache::save() const
+{
+    if (_path.empty())
+        return;
+
+    auto data = _device.getPipelineCacheData(*_cache);
+
+    FileHeader header = {
+            .magic = FILE_MAGIC,
+            .version = FILE_VERSION,
+            .vendor_id = _device_props.vendorID,
+            .device_id = _device_props.deviceID,
+            .driver_version = _device_props.driverVersion,
+            .pipeline_cache_uuid = {},
+            .data_size = data.size(),
+    };
+    std::memcpy(header.pipeline_cache_uuid, _device_props.pipelineCacheUUID.data(), VK_UUID_SIZE);
+
+    // write next to the target and rename so a crash mid write never leaves a torn cache behind
+    auto tmp_path = _path;
+    tmp_path += ".tmp";
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc); // raii
+        if (!ofs.is_open())
+        {
+            log(Warning, "pipeline cache cannot write " << tmp_path);
+            return;
+        }
+        ofs.write(reinterpret_cast<const char *>(&header), sizeof header);
+        ofs.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, _path, ec);
+    if (ec)
+    {
+        log(Warning, "pipeline cache cannot replace " << _path << " " << ec.message());
+        return;
+    }
+
+    log(Info, "pipeline cache saved " << data.size() << " bytes to " << _path);
+}
+
+std::vector<uint8_t> PipelineCache::load() const
+{
+    if (_path.empty())
+        return {};
+
+    std::error_code ec;
+    auto file_size = std::filesystem::file_size(_path, ec);
+    if (ec)
+        return {};
+
+    std::ifstream ifs(_path, std::ios::binary); // raii
+    if (!ifs.is_open())
+        return {};
+
+    FileHeader header = {};
+    ifs.read(reinterpret_cast<char *>(&header), sizeof header);
+    if (!ifs || header.magic != FILE_MAGIC || header.version != FILE_VERSION)
+    {
+        log(Warning, "pipeline cache " << _path << " has an unknown format, ignoring");
+        return {};
+    }
+
+    bool same_device =
+            header.vendor_id == _device_props.vendorID &&
+            header.device_id == _device_props.deviceID &&
+            header.driver_version == _device_props.driverVersion &&
+            std::memcmp(header.pipeline_cache_uuid, _device_props.pipelineCacheUUID.data(), VK_UUID_SIZE) == 0;
+
+    if (!same_device)
+    {
+        log(Info, "pipeline cache " << _path << " was built for another device or driver, ignoring");
+        return {};
+    }
+
+    // the size comes from the file, never allocate for more than the file holds
+    if (file_size < sizeof header || header.data_size != file_size - sizeof header)
+    {
+        log(Warning, "pipeline cache " << _path << " is truncated or corrupt, ignoring");
+        return {};
+    }
+
+    std::vector<uint8_t> data(header.data_size);
+    ifs.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!ifs || !verify_data(data))
+    {
+        log(Warning, "pipeline cache " << _path << " is corrupt, ignoring");
+        return {};
+    }
+
+    log(Info, "pipeline cache loaded " << data.size() << " bytes from " << _path);
+    return data;
+}
+
+bool PipelineCache::verify_data(const std::vector<uint8_t> &data) const
+{
+    // the driver's blob starts with VkPipelineCacheHeaderVersionOne, check it agrees with our header
+    constexpr size_t header_size = 16 + VK_UUID_SIZE;
+    if (data.size() < header_size)
+        return false;
+
+    uint32_t fields[4]; // headerSize, headerVersion, vendorID, deviceID
+    std::memcpy(fields, data.data(), sizeof fields);
+
+    return fields[0] >= header_size &&
+           fields[1] == static_cast<uint32_t>(VK_PIPELINE_CACHE_HEADER_VERSION_ONE) &&
+           fields[2] == _device_props.vendorID &&
+           fields[3] == _device_props.deviceID &&
+           std::memcmp(data.data() + 16, _device_props.pipelineCacheUUID.data(), VK_UUID_SIZE) == 0;
+}
+
+} // venture::vulkan
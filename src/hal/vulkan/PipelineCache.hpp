@@ -0,0 +1,61 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <filesystem>
+#include <vector>
+#include "DeviceProfile.hpp"
+
+namespace venture::vulkan {
+
+/**
+ * VkPipelineCache persisted to disk between launches
+ *
+ * The file is our own header followed by the driver's cache blob, the header pins vendor, device, driver version and
+ * cache UUID so a driver update or a different GPU starts from an empty cache instead of feeding it a stale blob.
+ */
+class PipelineCache
+{
+public:
+    /** load from path if valid, an empty path keeps the cache in memory only, a relative one is against the working directory */
+    PipelineCache(vk::Device device, const DeviceProfile &profile, std::filesystem::path path);
+    /** saves to disk */
+    ~PipelineCache();
+
+    PipelineCache(const PipelineCache&) = delete;
+    void operator=(const PipelineCache&) = delete;
+
+    void save() const;
+
+    [[nodiscard]]
+    inline vk::PipelineCache get() const noexcept;
+
+private:
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vendor_id;
+        uint32_t device_id;
+        uint32_t driver_version;
+        uint8_t pipeline_cache_uuid[VK_UUID_SIZE];
+        uint64_t data_size;
+    };
+
+    [[nodiscard]]
+    std::vector<uint8_t> load() const;
+    [[nodiscard]]
+    bool verify_data(const std::vector<uint8_t> &data) const;
+
+private:
+    vk::Device _device;
+    vk::PhysicalDeviceProperties _device_props;
+    std::filesystem::path _path;
+    vk::UniquePipelineCache _cache;
+
+    constexpr static uint32_t FILE_MAGIC = 0x43504556; // 'VEPC'
+    constexpr static uint32_t FILE_VERSION = 1;
+};
+
+vk::PipelineCache PipelineCache::get() const noexcept { return *_cache; }
+
+} // venture::vulkan
@@ -0,0 +1,86 @@
+#include "PipelineDesc.hpp"
+#include <algorithm>
+#include <functional>
+
+namespace venture::vulkan {
+
+namespace {
+
+template<typename T>
+void hash_combine(size_t &seed, const T &value)
+{
+    seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+} // anonymous
+
+void PipelineDesc::specialize(uint32_t id, uint32_t value)
+{
+    auto match_id = [=](const SpecializationConstant &constant) -> bool { return constant.id == id; };
+
+    if (auto it = std::ranges::find_if(specialization, match_id); it != specialization.end())
+        it->value = value;
+    else
+        specialization.push_back({ id, value });
+}
+
+bool PipelineDesc::operator==(const PipelineDesc &other) const
+{
+    // shaders are static arrays so their address is their identity
+    return vertex_shader.data() == other.vertex_shader.data() &&
+           fragment_shader.data() == other.fragment_shader.data() &&
+           specialization == other.specialization &&
+           vertex_bindings == other.vertex_bindings &&
+           vertex_attributes == other.vertex_attributes &&
+           topology == other.topology &&
+           polygon_mode == other.polygon_mode &&
+           cull_mode == other.cull_mode &&
+           front_face == other.front_face &&
+           alpha_blend == other.alpha_blend &&
+           layout == other.layout &&
+           color_formats == other.color_formats &&
+           depth_format == other.depth_format;
+}
+
+size_t PipelineDescHash::operator()(const PipelineDesc &desc) const noexcept
+{
+    size_t seed = 0;
+
+    hash_combine(seed, desc.vertex_shader.data());
+    hash_combine(seed, desc.fragment_shader.data());
+    for (const auto &constant : desc.specialization)
+    {
+        hash_combine(seed, constant.id);
+        hash_combine(seed, constant.value);
+    }
+
+    for (const auto &binding : desc.vertex_bindings)
+    {
+        hash_combine(seed, binding.binding);
+        hash_combine(seed, binding.stride);
+        hash_combine(seed, binding.inputRate);
+    }
+    for (const auto &attribute : desc.vertex_attributes)
+    {
+        hash_combine(seed, attribute.location);
+        hash_combine(seed, attribute.binding);
+        hash_combine(seed, attribute.format);
+        hash_combine(seed, attribute.offset);
+    }
+
+    hash_combine(seed, desc.topology);
+    hash_combine(seed, desc.polygon_mode);
+    hash_combine(seed, static_cast<uint32_t>(desc.cull_mode));
+    hash_combine(seed, desc.front_face);
+    hash_combine(seed, desc.alpha_blend);
+    hash_combine(seed, static_cast<VkPipelineLayout>(desc.layout));
+    for (auto format : desc.color_formats)
+    {
+        hash_combine(seed, format);
+    }
+    hash_combine(seed, desc.depth_format);
+
+    return seed;
+}
+
+} // venture::vulkan
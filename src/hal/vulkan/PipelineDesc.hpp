@@ -0,0 +1,69 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <span>
+#include <vector>
+
+namespace venture::vulkan {
+
+/** Specialization constant ids reserved by the engine, every shader sees these */
+enum SpecializationId : uint32_t
+{
+    SPEC_ALPHA_BLEND = 0, // mirrors PipelineDesc::alpha_blend, see shaders/shader.frag
+};
+
+struct SpecializationConstant
+{
+    uint32_t id;
+    uint32_t value;
+
+    bool operator==(const SpecializationConstant&) const = default;
+};
+
+/**
+ * Everything that makes a graphics pipeline unique, hashed by PipelineManager to deduplicate identical states
+ *
+ * Shaders are referenced by their embedded SPIR-V array, permutations of the same shader (alpha blend, variants)
+ * should be expressed through specialization constants rather than separate shader files.
+ */
+struct PipelineDesc
+{
+    //--- Shaders
+    std::span<const uint32_t> vertex_shader;
+    std::span<const uint32_t> fragment_shader;
+    std::vector<SpecializationConstant> specialization;
+
+    //--- Vertex Input
+    std::vector<vk::VertexInputBindingDescription> vertex_bindings;
+    std::vector<vk::VertexInputAttributeDescription> vertex_attributes;
+    vk::PrimitiveTopology topology = vk::PrimitiveTopology::eTriangleList;
+
+    //--- Raster
+    vk::PolygonMode polygon_mode = vk::PolygonMode::eFill;
+    vk::CullModeFlags cull_mode = vk::CullModeFlagBits::eBack;
+    vk::FrontFace front_face = vk::FrontFace::eClockwise;
+    // viewport and scissor are always dynamic so pipelines survive a resize
+
+    //--- Blend
+    bool alpha_blend = false;
+
+    //--- Layout
+    vk::PipelineLayout layout;
+
+    //--- Attachments
+    // dynamic rendering, the pipeline only knows attachment formats and never a render pass or framebuffer
+    std::vector<vk::Format> color_formats;
+    vk::Format depth_format = vk::Format::eUndefined;
+
+    /** set or replace a specialization constant */
+    void specialize(uint32_t id, uint32_t value);
+
+    bool operator==(const PipelineDesc &other) const;
+};
+
+struct PipelineDescHash
+{
+    size_t operator()(const PipelineDesc &desc) const noexcept;
+};
+
+} // venture::vulkan
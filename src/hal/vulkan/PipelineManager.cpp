@@ -0,0 +1,366 @@
+#include "PipelineManager.hpp"
+#include <array>
+#include <chrono>
+#include "error_handling/Check.hpp"
+
+namespace venture::vulkan {
+
+namespace {
+
+// extent dependent state stays out of the pipeline so a resized swapchain can keep using it
+constexpr std::array<vk::DynamicState, 2> DYNAMIC_STATES = {
+        vk::DynamicState::eViewport,
+        vk::DynamicState::eScissor,
+};
+
+/** Backing storage of one vk::GraphicsPipelineCreateInfo, points into itself so it must not move once filled */
+struct PipelineBuildState
+{
+    std::vector<vk::SpecializationMapEntry> map_entries;
+    std::vector<uint32_t> constant_data;
+    vk::SpecializationInfo specialization_info;
+    std::array<vk::PipelineShaderStageCreateInfo, 2> shader_stages;
+    vk::PipelineVertexInputStateCreateInfo vertex_input_state_create_info;
+    vk::PipelineInputAssemblyStateCreateInfo input_assembly_state_create_info;
+    vk::PipelineViewportStateCreateInfo viewport_state_create_info;
+    vk::PipelineRasterizationStateCreateInfo rasterization_state_create_info;
+    vk::PipelineMultisampleStateCreateInfo multisample_state_create_info;
+    vk::PipelineDepthStencilStateCreateInfo depth_stencil_state_create_info;
+    vk::PipelineColorBlendAttachmentState color_blend_attachment_state;
+    vk::PipelineColorBlendStateCreateInfo color_blend_state_create_info;
+    vk::PipelineDynamicStateCreateInfo dynamic_state_create_info;
+    std::vector<vk::PipelineColorBlendAttachmentState> color_blend_attachment_states;
+    vk::PipelineRenderingCreateInfo rendering_create_info;
+    vk::GraphicsPipelineCreateInfo graphics_pipeline_create_info;
+
+    void fill(const PipelineDesc &desc, ShaderRegistry *shader_registry);
+};
+
+void PipelineBuildState::fill(const PipelineDesc &desc, ShaderRegistry *shader_registry)
+{
+    //--- Specialization
+    // engine constants first so a description can still override them
+    auto constants = std::vector<SpecializationConstant>{ { SPEC_ALPHA_BLEND, desc.alpha_blend ? 1U : 0U } };
+    for (const auto &constant : desc.specialization)
+    {
+        if (constant.id == SPEC_ALPHA_BLEND)
+            constants[0].value = constant.value;
+        else
+            constants.push_back(constant);
+    }
+
+    for (const auto &constant : constants)
+    {
+        map_entries.push_back({
+                .constantID = constant.id,
+                .offset = static_cast<uint32_t>(constant_data.size() * sizeof(uint32_t)),
+                .size = sizeof(uint32_t),
+        });
+        constant_data.push_back(constant.value);
+    }
+
+    // entries a shader does not declare are ignored, so both stages can share one info
+    specialization_info = {
+            .mapEntryCount = static_cast<uint32_t>(map_entries.size()),
+            .pMapEntries = map_entries.data(),
+            .dataSize = constant_data.size() * sizeof(uint32_t),
+            .pData = constant_data.data(),
+    };
+
+    //--- Shaders
+    shader_stages[0] = {
+            .sType = vk::StructureType::ePipelineShaderStageCreateInfo,
+            .stage = vk::ShaderStageFlagBits::eVertex,
+            .module = shader_registry->get(desc.vertex_shader),
+            .pName = "main",
+            .pSpecializationInfo = &specialization_info,
+    };
+
+    shader_stages[1] = {
+            .sType = vk::StructureType::ePipelineShaderStageCreateInfo,
+            .stage = vk::ShaderStageFlagBits::eFragment,
+            .module = shader_registry->get(desc.fragment_shader),
+            .pName = "main",
+            .pSpecializationInfo = &specialization_info,
+    };
+
+    //--- Vertex Input
+    vertex_input_state_create_info = {
+            .sType = vk::StructureType::ePipelineVertexInputStateCreateInfo,
+            .vertexBindingDescriptionCount = static_cast<uint32_t>(desc.vertex_bindings.size()),
+            .pVertexBindingDescriptions = desc.vertex_bindings.data(),
+            .vertexAttributeDescriptionCount = static_cast<uint32_t>(desc.vertex_attributes.size()),
+            .pVertexAttributeDescriptions = desc.vertex_attributes.data(),
+    };
+
+    //--- Input Assembly
+    input_assembly_state_create_info = {
+            .sType = vk::StructureType::ePipelineInputAssemblyStateCreateInfo,
+            .topology = desc.topology,
+            .primitiveRestartEnable = false,
+    };
+
+    //--- Viewport and Scissor
+    // set while recording, see DYNAMIC_STATES
+    viewport_state_create_info = {
+            .sType = vk::StructureType::ePipelineViewportStateCreateInfo,
+            .viewportCount = 1,
+            .pViewports = nullptr,
+            .scissorCount = 1,
+            .pScissors = nullptr,
+    };
+
+    //--- Rasterizer
+    rasterization_state_create_info = {
+            .sType = vk::StructureType::ePipelineRasterizationStateCreateInfo,
+            .depthClampEnable = false,
+            .rasterizerDiscardEnable = false,
+            .polygonMode = desc.polygon_mode,
+            .cullMode = desc.cull_mode,
+            .frontFace = desc.front_face,
+            .depthBiasEnable = false,
+            .lineWidth = 1.0f,
+    };
+
+    //--- Multisampling
+    multisample_state_create_info = {
+            .sType = vk::StructureType::ePipelineMultisampleStateCreateInfo,
+            .rasterizationSamples = vk::SampleCountFlagBits::e1,
+            .sampleShadingEnable = false,
+    };
+
+    //--- Depth Stencil
+    // tested and written whenever the pipeline renders with a depth attachment
+    bool depth = desc.depth_format != vk::Format::eUndefined;
+    depth_stencil_state_create_info = {
+            .sType = vk::StructureType::ePipelineDepthStencilStateCreateInfo,
+            .depthTestEnable = depth,
+            .depthWriteEnable = depth,
+            .depthCompareOp = vk::CompareOp::eLess,
+            .depthBoundsTestEnable = false,
+            .stencilTestEnable = false,
+    };
+
+    //--- Blending
+    // equation : (srcColorBlendFactor * new color) colorBlendOp (dstColorBlendFactor * old color)
+    color_blend_attachment_state = {
+            .blendEnable = desc.alpha_blend,
+            .srcColorBlendFactor = vk::BlendFactor::eSrcAlpha,
+            .dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha,
+            .colorBlendOp = vk::BlendOp::eAdd,
+            .srcAlphaBlendFactor = vk::BlendFactor::eOne,
+            .dstAlphaBlendFactor = vk::BlendFactor::eZero,
+            .alphaBlendOp = vk::BlendOp::eAdd,
+            .colorWriteMask =
+            vk::ColorComponentFlagBits::eR |
+            vk::ColorComponentFlagBits::eG |
+            vk::ColorComponentFlagBits::eB |
+            vk::ColorComponentFlagBits::eA,
+    };
+
+    // every color attachment blends the same way
+    color_blend_attachment_states.assign(desc.color_formats.size(), color_blend_attachment_state);
+
+    color_blend_state_create_info = {
+            .sType = vk::StructureType::ePipelineColorBlendStateCreateInfo,
+            .logicOpEnable = false,
+            .attachmentCount = static_cast<uint32_t>(color_blend_attachment_states.size()),
+            .pAttachments = color_blend_attachment_states.data(),
+    };
+
+    //--- Dynamic State
+    dynamic_state_create_info = {
+            .sType = vk::StructureType::ePipelineDynamicStateCreateInfo,
+            .dynamicStateCount = static_cast<uint32_t>(DYNAMIC_STATES.size()),
+            .pDynamicStates = DYNAMIC_STATES.data(),
+    };
+
+    //--- Attachments
+    rendering_create_info = {
+            .sType = vk::StructureType::ePipelineRenderingCreateInfo,
+            .colorAttachmentCount = static_cast<uint32_t>(desc.color_formats.size()),
+            .pColorAttachmentFormats = desc.color_formats.data(),
+            .depthAttachmentFormat = desc.depth_format,
+    };
+
+    //--- Graphics Pipeline
+    graphics_pipeline_create_info = {
+            .sType = vk::StructureType::eGraphicsPipelineCreateInfo,
+            .pNext = &rendering_create_info,
+            .stageCount = static_cast<uint32_t>(shader_stages.size()),
+            .pStages = shader_stages.data(),
+            .pVertexInputState = &vertex_input_state_create_info,
+            .pInputAssemblyState = &input_assembly_state_create_info,
+            .pViewportState = &viewport_state_create_info,
+            .pRasterizationState = &rasterization_state_create_info,
+            .pMultisampleState = &multisample_state_create_info,
+            .pDepthStencilState = &depth_stencil_state_create_info,
+            .pColorBlendState = &color_blend_state_create_info,
+            .pDynamicState = &dynamic_state_create_info,
+            .layout = desc.layout,
+            .renderPass = VK_NULL_HANDLE,
+            .subpass = 0,
+            .basePipelineHandle = VK_NULL_HANDLE,
+            .basePipelineIndex = -1,
+    };
+}
+
+} // anonymous
+
+PipelineManager::PipelineManager(
+        vk::Device device,
+        ShaderRegistry *shader_registry,
+        vk::PipelineCache pipeline_cache,
+        ThreadPool *workers)
+        : _device(device),
+          _shader_registry(shader_registry),
+          _pipeline_cache(pipeline_cache),
+          _workers(workers)
+{}
+
+PipelineManager::~PipelineManager()
+{
+    wait_idle();
+}
+
+vk::Pipeline PipelineManager::get(const PipelineDesc &desc)
+{
+    return compile_async({ &desc, 1 })[0].get();
+}
+
+vk::Pipeline PipelineManager::try_get(const PipelineDesc &desc, vk::Pipeline fallback)
+{
+    auto future = compile_async({ &desc, 1 })[0];
+    return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready ? future.get() : fallback;
+}
+
+std::vector<std::shared_future<vk::Pipeline>> PipelineManager::compile_async(std::span<const PipelineDesc> batch)
+{
+    std::vector<std::shared_future<vk::Pipeline>> futures;
+    std::vector<const PipelineDesc *> new_descs;
+    std::vector<Entry *> new_entries;
+    {
+        std::lock_guard lock(_mutex);
+        for (const auto &desc : batch)
+        {
+            auto [it, inserted] = _pipelines.try_emplace(desc, nullptr);
+            if (inserted)
+            {
+                it->second = std::make_unique<Entry>();
+                it->second->future = it->second->promise.get_future().share();
+                // map nodes never move, so the key can be read by the worker without copying
+                new_descs.push_back(&it->first);
+                new_entries.push_back(it->second.get());
+            }
+            futures.push_back(it->second->future);
+        }
+
+        std::erase_if(_pending_batches, [](const std::future<void> &batch_future) {
+            return batch_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        });
+    }
+
+    if (new_descs.empty())
+        return futures;
+
+    // one createGraphicsPipelines call per worker, the drivers spread a single call poorly if at all
+    size_t chunk_size = (new_descs.size() + _workers->size() - 1) / _workers->size();
+    for (size_t first = 0; first < new_descs.size(); first += chunk_size)
+    {
+        size_t last = std::min(first + chunk_size, new_descs.size());
+        std::vector<const PipelineDesc *> chunk_descs(new_descs.begin() + first, new_descs.begin() + last);
+        std::vector<Entry *> chunk_entries(new_entries.begin() + first, new_entries.begin() + last);
+
+        auto batch_future = _workers->submit([this, chunk_descs = std::move(chunk_descs), chunk_entries = std::move(chunk_entries)] {
+            compile(chunk_descs, chunk_entries);
+        });
+
+        std::lock_guard lock(_mutex);
+        _pending_batches.emplace_back(std::move(batch_future));
+    }
+
+    return futures;
+}
+
+vk::Pipeline PipelineManager::get_compute(std::span<const uint32_t> shader, vk::PipelineLayout layout)
+{
+    std::lock_guard lock(_mutex);
+
+    auto &pipeline = _compute_pipelines[{ shader.data(), static_cast<VkPipelineLayout>(layout) }];
+    if (pipeline)
+        return *pipeline;
+
+    vk::ComputePipelineCreateInfo compute_pipeline_create_info = {
+            .sType = vk::StructureType::eComputePipelineCreateInfo,
+            .stage = {
+                    .sType = vk::StructureType::ePipelineShaderStageCreateInfo,
+                    .stage = vk::ShaderStageFlagBits::eCompute,
+                    .module = _shader_registry->get(shader),
+                    .pName = "main",
+            },
+            .layout = layout,
+            .basePipelineHandle = VK_NULL_HANDLE,
+            .basePipelineIndex = -1,
+    };
+
+    auto [result, value] = _device.createComputePipelineUnique(_pipeline_cache, compute_pipeline_create_info);
+    check(result == vk::Result::eSuccess);
+    pipeline = std::move(value);
+    return *pipeline;
+}
+
+void PipelineManager::wait_idle()
+{
+    std::vector<std::future<void>> pending;
+    {
+        std::lock_guard lock(_mutex);
+        pending.swap(_pending_batches);
+    }
+
+    for (auto &batch_future : pending)
+        batch_future.wait();
+}
+
+size_t PipelineManager::size()
+{
+    std::lock_guard lock(_mutex);
+    return _pipelines.size();
+}
+
+void PipelineManager::compile(const std::vector<const PipelineDesc *> &descs, const std::vector<Entry *> &entries)
+{
+    try {
+        auto pipelines = build(descs);
+
+        std::lock_guard lock(_mutex);
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            entries[i]->pipeline = std::move(pipelines[i]);
+            entries[i]->promise.set_value(*entries[i]->pipeline);
+        }
+    } catch (...) {
+        // every waiter of the batch sees the failure when it calls get()
+        for (auto *entry : entries)
+            entry->promise.set_exception(std::current_exception());
+    }
+}
+
+std::vector<vk::UniquePipeline> PipelineManager::build(std::span<const PipelineDesc *const> descs) const
+{
+    // sized once up front, the states point into themselves
+    std::vector<PipelineBuildState> states(descs.size());
+    std::vector<vk::GraphicsPipelineCreateInfo> create_infos;
+    create_infos.reserve(descs.size());
+
+    for (size_t i = 0; i < descs.size(); i++)
+    {
+        states[i].fill(*descs[i], _shader_registry);
+        create_infos.push_back(states[i].graphics_pipeline_create_info);
+    }
+
+    auto [result, value] = _device.createGraphicsPipelinesUnique(_pipeline_cache, create_infos);
+    check(result == vk::Result::eSuccess);
+    return std::move(value);
+}
+
+} // venture::vulkan
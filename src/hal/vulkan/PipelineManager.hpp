@@ -0,0 +1,82 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "PipelineDesc.hpp"
+#include "ShaderRegistry.hpp"
+#include "threading/ThreadPool.hpp"
+
+namespace venture::vulkan {
+
+/**
+ * Runtime cache of graphics pipelines keyed by PipelineDesc, identical descriptions share one vk::Pipeline
+ *
+ * Compilation happens on worker threads in batches, every batch is split into one createGraphicsPipelines call per
+ * worker and all of them share the same vk::PipelineCache. Compute pipelines are few and built on the calling thread.
+ */
+class PipelineManager
+{
+public:
+    PipelineManager(
+            vk::Device device,
+            ShaderRegistry *shader_registry,
+            vk::PipelineCache pipeline_cache,
+            ThreadPool *workers);
+    /** waits for outstanding compiles */
+    ~PipelineManager();
+
+    PipelineManager(const PipelineManager&) = delete;
+    void operator=(const PipelineManager&) = delete;
+
+    /** returns the cached pipeline, compiling it or waiting on a pending compile */
+    [[nodiscard]]
+    vk::Pipeline get(const PipelineDesc &desc);
+
+    /** returns the pipeline if it is ready, otherwise makes sure it is queued and returns fallback (null to skip) */
+    [[nodiscard]]
+    vk::Pipeline try_get(const PipelineDesc &desc, vk::Pipeline fallback = {});
+
+    /** queue a batch for compilation, descriptions already known are not compiled again */
+    std::vector<std::shared_future<vk::Pipeline>> compile_async(std::span<const PipelineDesc> batch);
+
+    /** compute pipelines are keyed by shader and layout, built on first use through the same vk::PipelineCache */
+    [[nodiscard]]
+    vk::Pipeline get_compute(std::span<const uint32_t> shader, vk::PipelineLayout layout);
+
+    /** block until every queued batch has finished */
+    void wait_idle();
+
+    [[nodiscard]]
+    size_t size();
+
+private:
+    struct Entry
+    {
+        std::promise<vk::Pipeline> promise;
+        std::shared_future<vk::Pipeline> future;
+        vk::UniquePipeline pipeline; // set once compiled
+    };
+
+    void compile(const std::vector<const PipelineDesc *> &descs, const std::vector<Entry *> &entries);
+    [[nodiscard]]
+    std::vector<vk::UniquePipeline> build(std::span<const PipelineDesc *const> descs) const;
+
+private:
+    vk::Device _device;
+    ShaderRegistry *_shader_registry;
+    vk::PipelineCache _pipeline_cache;
+    ThreadPool *_workers;
+
+    std::mutex _mutex;
+    std::unordered_map<PipelineDesc, std::unique_ptr<Entry>, PipelineDescHash> _pipelines;
+    std::vector<std::future<void>> _pending_batches;
+    std::map<std::pair<const uint32_t *, VkPipelineLayout>, vk::UniquePipeline> _compute_pipelines;
+};
+
+} // venture::vulkan
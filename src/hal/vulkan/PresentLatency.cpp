@@ -0,0 +1,46 @@
+#include "PresentLatency.hpp"
+#include "error_handling/Check.hpp"
+
+namespace venture::vulkan {
+
+PresentLatency::PresentLatency(vk::Device device)
+        : _device(device)
+{
+    _wait_for_present = reinterpret_cast<PFN_vkWaitForPresentKHR>(_device.getProcAddr("vkWaitForPresentKHR"));
+    checkf(_wait_for_present != nullptr, "vkWaitForPresentKHR not found");
+}
+
+uint64_t PresentLatency::next_present(Clock::time_point input_time)
+{
+    _pending.push_back({ _next_id, input_time });
+    return _next_id++;
+}
+
+void PresentLatency::poll(vk::SwapchainKHR swapchain)
+{
+    while (!_pending.empty())
+    {
+        auto result = _wait_for_present(_device, swapchain, _pending.front().id, 0);
+        if (result == VK_TIMEOUT)
+            break;
+
+        // out of date or lost, nothing outstanding will ever complete
+        if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+        {
+            reset();
+            break;
+        }
+
+        _last_ms = std::chrono::duration<double, std::milli>(Clock::now() - _pending.front().input_time).count();
+        _total_ms += _last_ms;
+        _samples++;
+        _pending.pop_front();
+    }
+}
+
+void PresentLatency::reset() noexcept
+{
+    _pending.clear();
+}
+
+} // venture::vulkan
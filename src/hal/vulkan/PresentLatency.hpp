@@ -0,0 +1,61 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <chrono>
+#include <deque>
+
+namespace venture::vulkan {
+
+/**
+ * Input to present latency through VK_KHR_present_id and VK_KHR_present_wait
+ *
+ * Every present is tagged with an id and the time its frame sampled input. poll() asks, without blocking, which ids
+ * have reached the display since the last call, so a sample is only as precise as the polling rate (once a frame).
+ */
+class PresentLatency
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** the device must have been created with presentId and presentWait enabled */
+    explicit PresentLatency(vk::Device device);
+
+    /** id to chain into the next present through vk::PresentIdKHR */
+    [[nodiscard]]
+    uint64_t next_present(Clock::time_point input_time);
+
+    /** non blocking, resolve every present that has completed */
+    void poll(vk::SwapchainKHR swapchain);
+
+    /** drop outstanding ids, they belong to a swapchain that was replaced */
+    void reset() noexcept;
+
+    [[nodiscard]]
+    inline double last_ms() const noexcept;
+    [[nodiscard]]
+    inline double average_ms() const noexcept;
+    [[nodiscard]]
+    inline uint64_t sample_count() const noexcept;
+
+private:
+    struct Pending
+    {
+        uint64_t id;
+        Clock::time_point input_time;
+    };
+
+    vk::Device _device;
+    PFN_vkWaitForPresentKHR _wait_for_present = nullptr; // not exported by the loader
+
+    std::deque<Pending> _pending;
+    uint64_t _next_id = 1; // ids must increase for the lifetime of a swapchain, keeping them global is simplest
+    double _last_ms = 0.0;
+    double _total_ms = 0.0;
+    uint64_t _samples = 0;
+};
+
+double PresentLatency::last_ms() const noexcept { return _last_ms; }
+double PresentLatency::average_ms() const noexcept { return _samples > 0 ? _total_ms / double(_samples) : 0.0; }
+uint64_t PresentLatency::sample_count() const noexcept { return _samples; }
+
+} // venture::vulkan
@@ -10,27 +10,58 @@ QueueFamilyInfo QueueFamilyInfo::get_info(vk::PhysicalDevice physical_device, vk
     auto queue_family_props = physical_device.getQueueFamilyProperties();
     for (int32_t i = 0; const auto &queue_family_prop: queue_family_props)
     {
+        // every family is visited, the optional ones may come after graphics and presentation
+        int32_t index = i++;
         if (queue_family_prop.queueCount <= 0)
             continue;
 
+        // check presentation queue family support, headless has no surface so images are handed off on graphics
+        bool graphics_support = static_cast<bool>(queue_family_prop.queueFlags & vk::QueueFlagBits::eGraphics);
+        vk::Bool32 presentation_support = false;
+        if (surface)
+        {
+            check(physical_device.getSurfaceSupportKHR(index, surface, &presentation_support) == vk::Result::eSuccess);
+        }
+        else
+        {
+            presentation_support = graphics_support;
+        }
+
+        // a family doing both wins over the first match of each, the swapchain then needs no concurrent sharing
+        bool has_both = queue_family_tracker.graphics_family_index >= 0 &&
+                        queue_family_tracker.graphics_family_index == queue_family_tracker.presentation_family_index;
+        if (graphics_support && presentation_support && !has_both)
+        {
+            queue_family_tracker.graphics_family_index = index;
+            queue_family_tracker.presentation_family_index = index;
+        }
+
         // check graphics queue family support
-        if (queue_family_prop.queueFlags & vk::QueueFlagBits::eGraphics)
+        if (graphics_support && queue_family_tracker.graphics_family_index < 0)
         {
-            queue_family_tracker.graphics_family_index = i;
+            queue_family_tracker.graphics_family_index = index;
         }
 
-        // check presentation queue family support
-        vk::Bool32 presentation_support = false;
-        check(physical_device.getSurfaceSupportKHR(i, surface, &presentation_support) == vk::Result::eSuccess);
-        if (presentation_support)
+        if (presentation_support && queue_family_tracker.presentation_family_index < 0)
         {
-            queue_family_tracker.presentation_family_index = i;
+            queue_family_tracker.presentation_family_index = index;
         }
 
-        if (queue_family_tracker.is_valid())
-            break;
+        // check compute without graphics, the async compute engine which runs alongside graphics
+        bool compute_only = (queue_family_prop.queueFlags & vk::QueueFlagBits::eCompute) && !graphics_support;
+        if (compute_only && queue_family_tracker.compute_family_index < 0)
+        {
+            queue_family_tracker.compute_family_index = index;
+        }
 
-        i++;
+        // check transfer only queue family, usually the copy engine which runs alongside graphics
+        constexpr auto graphics_or_compute = vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute;
+        bool transfer_only = (queue_family_prop.queueFlags & vk::QueueFlagBits::eTransfer) &&
+                             !(queue_family_prop.queueFlags & graphics_or_compute);
+        if (transfer_only && queue_family_tracker.transfer_family_index < 0)
+        {
+            queue_family_tracker.transfer_family_index = index;
+        }
     }
 
     return queue_family_tracker;
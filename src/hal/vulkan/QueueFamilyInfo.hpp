@@ -4,6 +4,7 @@
 
 namespace venture::vulkan {
 
+class DeviceProfile;
 class VulkanRenderer;
 
 /** Tracks queue family indices */
@@ -11,10 +12,15 @@ class QueueFamilyInfo
 {
     int32_t graphics_family_index = -1;
     int32_t presentation_family_index = -1;
+    int32_t transfer_family_index = -1; // transfer only family (dma engine), -1 if the device has none
+    int32_t compute_family_index = -1;  // compute without graphics (async compute), -1 if the device has none
 
     [[nodiscard]] inline bool is_valid() const noexcept;
+    [[nodiscard]] inline bool has_dedicated_transfer() const noexcept;
+    [[nodiscard]] inline bool has_dedicated_compute() const noexcept;
     static QueueFamilyInfo get_info(vk::PhysicalDevice physical_device, vk::SurfaceKHR surface);
 
+    friend DeviceProfile;
     friend VulkanRenderer;
 };
 
@@ -26,4 +32,14 @@ bool QueueFamilyInfo::is_valid() const noexcept
     );
 }
 
+bool QueueFamilyInfo::has_dedicated_transfer() const noexcept
+{
+    return transfer_family_index >= 0 && transfer_family_index != graphics_family_index;
+}
+
+bool QueueFamilyInfo::has_dedicated_compute() const noexcept
+{
+    return compute_family_index >= 0 && compute_family_index != graphics_family_index;
+}
+
 } // venture::vulkan
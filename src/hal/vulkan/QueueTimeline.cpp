@@ -0,0 +1,99 @@
+#include "QueueTimeline.hpp"
+#include <algorithm>
+#include <vector>
+#include "error_handling/Check.hpp"
+
+namespace venture::vulkan {
+
+QueueTimeline::QueueTimeline(vk::Device device, vk::Queue queue, uint32_t family_index)
+        : _device(device),
+          _queue(queue),
+          _family_index(family_index)
+{
+    vk::SemaphoreTypeCreateInfo semaphore_type_create_info = {
+            .sType = vk::StructureType::eSemaphoreTypeCreateInfo,
+            .semaphoreType = vk::SemaphoreType::eTimeline,
+            .initialValue = 0,
+    };
+
+    vk::SemaphoreCreateInfo semaphore_create_info = {
+            .sType = vk::StructureType::eSemaphoreCreateInfo,
+            .pNext = &semaphore_type_create_info,
+    };
+
+    _semaphore = _device.createSemaphoreUnique(semaphore_create_info);
+}
+
+uint64_t QueueTimeline::submit(
+        std::span<const vk::CommandBuffer> command_buffers,
+        std::span<const vk::SemaphoreSubmitInfo> waits,
+        std::span<const vk::SemaphoreSubmitInfo> signals)
+{
+    std::vector<vk::CommandBufferSubmitInfo> command_buffer_infos;
+    command_buffer_infos.reserve(command_buffers.size());
+    for (auto command_buffer : command_buffers)
+    {
+        command_buffer_infos.push_back({
+                .sType = vk::StructureType::eCommandBufferSubmitInfo,
+                .commandBuffer = command_buffer,
+        });
+    }
+
+    // the timeline signal goes last, once everything else in the batch has finished
+    std::vector<vk::SemaphoreSubmitInfo> signal_infos(signals.begin(), signals.end());
+    signal_infos.push_back({
+            .sType = vk::StructureType::eSemaphoreSubmitInfo,
+            .semaphore = *_semaphore,
+            .value = _last_submitted + 1,
+            .stageMask = vk::PipelineStageFlagBits2::eAllCommands,
+    });
+
+    vk::SubmitInfo2 submit_info = {
+            .sType = vk::StructureType::eSubmitInfo2,
+            .waitSemaphoreInfoCount = static_cast<uint32_t>(waits.size()),
+            .pWaitSemaphoreInfos = waits.data(),
+            .commandBufferInfoCount = static_cast<uint32_t>(command_buffer_infos.size()),
+            .pCommandBufferInfos = command_buffer_infos.data(),
+            .signalSemaphoreInfoCount = static_cast<uint32_t>(signal_infos.size()),
+            .pSignalSemaphoreInfos = signal_infos.data(),
+    };
+
+    _queue.submit2(submit_info);
+    return ++_last_submitted;
+}
+
+void QueueTimeline::wait(uint64_t value) const
+{
+    if (value <= _last_completed)
+        return;
+
+    vk::SemaphoreWaitInfo semaphore_wait_info = {
+            .sType = vk::StructureType::eSemaphoreWaitInfo,
+            .semaphoreCount = 1,
+            .pSemaphores = &_semaphore.get(),
+            .pValues = &value,
+    };
+
+    check(_device.waitSemaphores(semaphore_wait_info, UINT64_MAX) == vk::Result::eSuccess);
+    _last_completed = std::max(_last_completed, value);
+}
+
+bool QueueTimeline::completed(uint64_t value) const
+{
+    if (value > _last_completed)
+        _last_completed = _device.getSemaphoreCounterValue(*_semaphore);
+
+    return value <= _last_completed;
+}
+
+vk::SemaphoreSubmitInfo QueueTimeline::wait_info(uint64_t value, vk::PipelineStageFlags2 stage) const
+{
+    return {
+            .sType = vk::StructureType::eSemaphoreSubmitInfo,
+            .semaphore = *_semaphore,
+            .value = value,
+            .stageMask = stage,
+    };
+}
+
+} // venture::vulkan
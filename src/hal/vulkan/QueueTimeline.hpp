@@ -0,0 +1,61 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <span>
+
+namespace venture::vulkan {
+
+/**
+ * A queue and the timeline semaphore every submission to it signals
+ *
+ * Each submit() signals the next value, so a single number describes how far the queue has progressed. Other queues
+ * wait on it through wait_info(), the host through wait() or completed(). Binary semaphores are still passed in for
+ * swapchain acquire and present, which cannot use timelines. Not thread safe, driven by the render thread.
+ */
+class QueueTimeline
+{
+public:
+    /** the device must have been created with the timelineSemaphore and synchronization2 features */
+    QueueTimeline(vk::Device device, vk::Queue queue, uint32_t family_index);
+
+    QueueTimeline(const QueueTimeline&) = delete;
+    void operator=(const QueueTimeline&) = delete;
+
+    /** returns the value the timeline reaches once the submission has completed */
+    uint64_t submit(
+            std::span<const vk::CommandBuffer> command_buffers,
+            std::span<const vk::SemaphoreSubmitInfo> waits = {},
+            std::span<const vk::SemaphoreSubmitInfo> signals = {});
+
+    /** block until the value is reached */
+    void wait(uint64_t value) const;
+    /** non blocking */
+    [[nodiscard]]
+    bool completed(uint64_t value) const;
+
+    /** makes a submission on another queue wait for the value before stage */
+    [[nodiscard]]
+    vk::SemaphoreSubmitInfo wait_info(uint64_t value, vk::PipelineStageFlags2 stage) const;
+
+    [[nodiscard]]
+    inline uint64_t last_submitted() const noexcept;
+    [[nodiscard]]
+    inline vk::Queue queue() const noexcept;
+    [[nodiscard]]
+    inline uint32_t family_index() const noexcept;
+
+private:
+    vk::Device _device;
+    vk::Queue _queue;
+    uint32_t _family_index;
+    vk::UniqueSemaphore _semaphore;
+
+    uint64_t _last_submitted = 0;
+    mutable uint64_t _last_completed = 0; // cached so repeated queries don't go to the driver
+};
+
+uint64_t QueueTimeline::last_submitted() const noexcept { return _last_submitted; }
+vk::Queue QueueTimeline::queue() const noexcept { return _queue; }
+uint32_t QueueTimeline::family_index() const noexcept { return _family_index; }
+
+} // venture::vulkan
@@ -0,0 +1,569 @@
+#include "RenderGraph.hpp"
+#include <algorithm>
+#include "error_handling/Check.hpp"
+#include "error_handling/Log.hpp"
+
+namespace venture::vulkan {
+
+namespace {
+
+struct AccessInfo
+{
+    vk::PipelineStageFlags2 stages;
+    vk::AccessFlags2 access;
+    vk::ImageLayout layout;
+    bool write;
+    vk::ImageUsageFlags usage;
+};
+
+AccessInfo access_info(ResourceAccess access)
+{
+    using Stage = vk::PipelineStageFlagBits2;
+    using Access = vk::AccessFlagBits2;
+    using Layout = vk::ImageLayout;
+    using Usage = vk::ImageUsageFlagBits;
+
+    switch (access)
+    {
+        case ResourceAccess::eNone:
+            return { {}, {}, Layout::eUndefined, false, {} };
+        case ResourceAccess::eAcquired:
+            return { Stage::eColorAttachmentOutput, {}, Layout::eUndefined, false, {} };
+        case ResourceAccess::eColorAttachmentWrite:
+            return { Stage::eColorAttachmentOutput, Access::eColorAttachmentRead | Access::eColorAttachmentWrite,
+                     Layout::eColorAttachmentOptimal, true, Usage::eColorAttachment };
+        case ResourceAccess::eDepthAttachmentWrite:
+            return { Stage::eEarlyFragmentTests | Stage::eLateFragmentTests,
+                     Access::eDepthStencilAttachmentRead | Access::eDepthStencilAttachmentWrite,
+                     Layout::eDepthStencilAttachmentOptimal, true, Usage::eDepthStencilAttachment };
+        case ResourceAccess::eDepthAttachmentRead:
+            return { Stage::eEarlyFragmentTests | Stage::eLateFragmentTests, Access::eDepthStencilAttachmentRead,
+                     Layout::eDepthStencilReadOnlyOptimal, false, Usage::eDepthStencilAttachment };
+        case ResourceAccess::eFragmentSampledRead:
+            return { Stage::eFragmentShader, Access::eShaderSampledRead, Layout::eShaderReadOnlyOptimal, false, Usage::eSampled };
+        case ResourceAccess::eComputeSampledRead:
+            return { Stage::eComputeShader, Access::eShaderSampledRead, Layout::eShaderReadOnlyOptimal, false, Usage::eSampled };
+        case ResourceAccess::eComputeStorageRead:
+            return { Stage::eComputeShader, Access::eShaderStorageRead, Layout::eGeneral, false, Usage::eStorage };
+        case ResourceAccess::eComputeStorageWrite:
+            return { Stage::eComputeShader, Access::eShaderStorageRead | Access::eShaderStorageWrite,
+                     Layout::eGeneral, true, Usage::eStorage };
+        case ResourceAccess::eIndirectRead:
+            return { Stage::eDrawIndirect, Access::eIndirectCommandRead, Layout::eUndefined, false, {} };
+        case ResourceAccess::eTransferSrc:
+            return { Stage::eCopy | Stage::eBlit, Access::eTransferRead, Layout::eTransferSrcOptimal, false, Usage::eTransferSrc };
+        case ResourceAccess::eTransferDst:
+            return { Stage::eCopy | Stage::eBlit | Stage::eClear, Access::eTransferWrite,
+                     Layout::eTransferDstOptimal, true, Usage::eTransferDst };
+        case ResourceAccess::ePresent:
+            return { {}, {}, Layout::ePresentSrcKHR, false, {} };
+    }
+    return { {}, {}, Layout::eUndefined, false, {} };
+}
+
+vk::ImageAspectFlags aspect_of(vk::Format format)
+{
+    switch (format)
+    {
+        case vk::Format::eD16Unorm:
+        case vk::Format::eX8D24UnormPack32:
+        case vk::Format::eD32Sfloat:
+            return vk::ImageAspectFlagBits::eDepth;
+        case vk::Format::eD16UnormS8Uint:
+        case vk::Format::eD24UnormS8Uint:
+        case vk::Format::eD32SfloatS8Uint:
+            return vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+        default:
+            return vk::ImageAspectFlagBits::eColor;
+    }
+}
+
+} // anonymous
+
+//--- PassBuilder
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::read(RenderGraphResource resource, ResourceAccess access)
+{
+    _graph->add_use(_pass, resource, access, false);
+    return *this;
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::write(RenderGraphResource resource, ResourceAccess access)
+{
+    _graph->add_use(_pass, resource, access, true);
+    return *this;
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::side_effect()
+{
+    _graph->_passes[_pass].side_effect = true;
+    return *this;
+}
+
+//--- RenderGraph
+
+RenderGraph::RenderGraph(vk::Device device, DeviceAllocator *allocator)
+        : _device(device),
+          _allocator(allocator)
+{
+}
+
+RenderGraphResource RenderGraph::import_image(
+        std::string_view name,
+        vk::Format format,
+        ResourceAccess initial_access,
+        ResourceAccess final_access)
+{
+    check_DEBUG(!_is_compiled);
+    _resources.push_back({
+            .name = std::string(name),
+            .image = true,
+            .format = format,
+            .initial_access = initial_access,
+            .final_access = final_access,
+    });
+    return static_cast<RenderGraphResource>(_resources.size() - 1);
+}
+
+RenderGraphResource RenderGraph::import_buffer(
+        std::string_view name,
+        vk::Buffer buffer,
+        ResourceAccess initial_access,
+        ResourceAccess final_access)
+{
+    check_DEBUG(!_is_compiled);
+    _resources.push_back({
+            .name = std::string(name),
+            .image = false,
+            .initial_access = initial_access,
+            .final_access = final_access,
+            .vk_buffer = buffer,
+    });
+    return static_cast<RenderGraphResource>(_resources.size() - 1);
+}
+
+RenderGraphResource RenderGraph::create_image(std::string_view name, vk::Format format, vk::Extent2D extent)
+{
+    check_DEBUG(!_is_compiled);
+    _resources.push_back({
+            .name = std::string(name),
+            .image = true,
+            .transient = true,
+            .format = format,
+            .extent = extent,
+    });
+    return static_cast<RenderGraphResource>(_resources.size() - 1);
+}
+
+RenderGraph::PassBuilder RenderGraph::add_pass(std::string_view name, RecordFn record)
+{
+    check_DEBUG(!_is_compiled);
+    _passes.push_back({
+            .name = std::string(name),
+            .record = std::move(record),
+    });
+    return { this, static_cast<uint32_t>(_passes.size() - 1) };
+}
+
+void RenderGraph::add_use(uint32_t pass, RenderGraphResource resource, ResourceAccess access, bool write)
+{
+    check_DEBUG(!_is_compiled);
+    check_DEBUG(resource < _resources.size());
+    checkf_DEBUG(access_info(access).write == write, "'%s' declared with an access of the other kind", _resources[resource].name.c_str());
+
+    // one access per resource and pass, a read-modify-write is declared as the write
+    auto &uses = _passes[pass].uses;
+    checkf_DEBUG(std::ranges::none_of(uses, [=](const Use &use) { return use.resource == resource; }),
+                 "'%s' used twice by pass '%s'", _resources[resource].name.c_str(), _passes[pass].name.c_str());
+
+    uses.push_back({ .resource = resource, .access = access, .write = write });
+}
+
+void RenderGraph::compile()
+{
+    check(!_is_compiled);
+
+    cull_passes();
+    create_transients();
+    place_transients();
+    compute_barriers();
+    _is_compiled = true;
+
+    log(Info, "render graph " << _compiled.size() << " passes, " << culled_pass_count() << " culled, transient memory "
+              << (_transient_bytes >> 10) << " KiB aliased from " << (_unaliased_bytes >> 10) << " KiB");
+}
+
+void RenderGraph::set_image(RenderGraphResource resource, vk::Image image, vk::ImageView view)
+{
+    auto &r = _resources.at(resource);
+    check_DEBUG(r.image && !r.transient);
+    r.vk_image = image;
+    r.vk_view = view;
+}
+
+void RenderGraph::execute(vk::CommandBuffer command_buffer, uint32_t frame_index) const
+{
+    check_DEBUG(_is_compiled);
+
+    for (auto index : _compiled)
+    {
+        const auto &pass = _passes[index];
+        record_barriers(command_buffer, pass.barriers);
+        pass.record(command_buffer, frame_index);
+    }
+
+    record_barriers(command_buffer, _final_barriers);
+}
+
+vk::ImageView RenderGraph::view(RenderGraphResource resource) const
+{
+    return _resources.at(resource).vk_view;
+}
+
+void RenderGraph::cull_passes()
+{
+    // walk backwards from the outputs, a pass is needed when it writes something a needed pass or an output reads
+    std::vector<bool> needed(_resources.size());
+    for (size_t i = 0; i < _resources.size(); i++)
+    {
+        needed[i] = _resources[i].final_access != ResourceAccess::eNone;
+    }
+
+    std::vector<bool> kept(_passes.size());
+    for (size_t i = _passes.size(); i-- > 0;)
+    {
+        const auto &pass = _passes[i];
+        kept[i] = pass.side_effect || std::ranges::any_of(pass.uses, [&](const Use &use) {
+            return use.write && needed[use.resource];
+        });
+
+        if (!kept[i])
+            continue;
+
+        for (const auto &use : pass.uses)
+        {
+            if (!use.write)
+                needed[use.resource] = true;
+        }
+    }
+
+    for (uint32_t i = 0; i < _passes.size(); i++)
+    {
+        if (kept[i])
+            _compiled.push_back(i);
+    }
+}
+
+void RenderGraph::create_transients()
+{
+    for (uint32_t p = 0; p < _compiled.size(); p++)
+    {
+        for (const auto &use : _passes[_compiled[p]].uses)
+        {
+            auto &r = _resources[use.resource];
+            if (!r.transient)
+                continue;
+
+            r.first_pass = std::min(r.first_pass, p);
+            r.last_pass = std::max(r.last_pass, p);
+            r.usage |= access_info(use.access).usage;
+        }
+    }
+
+    // only used by culled passes, never created
+    for (auto &r : _resources)
+    {
+        if (!r.transient || r.first_pass == UINT32_MAX)
+            continue;
+
+        vk::ImageCreateInfo image_create_info = {
+                .sType = vk::StructureType::eImageCreateInfo,
+                .imageType = vk::ImageType::e2D,
+                .format = r.format,
+                .extent = { r.extent.width, r.extent.height, 1 },
+                .mipLevels = 1,
+                .arrayLayers = 1,
+                .samples = vk::SampleCountFlagBits::e1,
+                .tiling = vk::ImageTiling::eOptimal,
+                .usage = r.usage,
+                .sharingMode = vk::SharingMode::eExclusive,
+                .initialLayout = vk::ImageLayout::eUndefined,
+        };
+
+        r.owned_image = _device.createImageUnique(image_create_info);
+        r.vk_image = *r.owned_image;
+        r.requirements = _device.getImageMemoryRequirements(r.vk_image);
+    }
+}
+
+void RenderGraph::place_transients()
+{
+    std::vector<Resource *> order;
+    for (auto &r : _resources)
+    {
+        if (r.owned_image)
+            order.push_back(&r);
+    }
+
+    if (order.empty())
+        return;
+
+    // largest first, smaller images then fill the gaps left next to them
+    std::ranges::sort(order, std::greater<>(), [](const Resource *r) { return r->requirements.size; });
+
+    auto lifetimes_overlap = [](const Resource &a, const Resource &b) {
+        return a.first_pass <= b.last_pass && b.first_pass <= a.last_pass;
+    };
+
+    uint32_t memory_type_bits = ~0U;
+    vk::DeviceSize alignment = 1;
+    std::vector<const Resource *> placed;
+
+    for (auto *r : order)
+    {
+        memory_type_bits &= r->requirements.memoryTypeBits;
+        alignment = std::max(alignment, r->requirements.alignment);
+        _unaliased_bytes += r->requirements.size;
+
+        // lowest offset clear of every placed image alive at the same time, moving past a conflict only ever goes up
+        vk::DeviceSize offset = 0;
+        bool moved = true;
+        while (moved)
+        {
+            moved = false;
+            offset = (offset + r->requirements.alignment - 1) / r->requirements.alignment * r->requirements.alignment;
+
+            for (const auto *other : placed)
+            {
+                auto other_end = other->memory_offset + other->requirements.size;
+                if (lifetimes_overlap(*r, *other) && offset < other_end && other->memory_offset < offset + r->requirements.size)
+                {
+                    offset = other_end;
+                    moved = true;
+                }
+            }
+        }
+
+        r->memory_offset = offset;
+        _transient_bytes = std::max(_transient_bytes, offset + r->requirements.size);
+        placed.push_back(r);
+    }
+
+    checkf(memory_type_bits != 0, "transient images share no memory type");
+
+    vk::MemoryRequirements requirements = {
+            .size = _transient_bytes,
+            .alignment = alignment,
+            .memoryTypeBits = memory_type_bits,
+    };
+    _transient_memory = UniqueAllocation(_allocator, _allocator->allocate(requirements, MemoryUsage::eGpuOnly, true));
+
+    for (auto *r : order)
+    {
+        _device.bindImageMemory(r->vk_image, _transient_memory->memory, _transient_memory->offset + r->memory_offset);
+
+        vk::ImageViewCreateInfo image_view_create_info = {
+                .sType = vk::StructureType::eImageViewCreateInfo,
+                .image = r->vk_image,
+                .viewType = vk::ImageViewType::e2D,
+                .format = r->format,
+                .subresourceRange = {
+                        .aspectMask = aspect_of(r->format),
+                        .baseMipLevel = 0,
+                        .levelCount = 1,
+                        .baseArrayLayer = 0,
+                        .layerCount = 1,
+                },
+        };
+
+        r->owned_view = _device.createImageViewUnique(image_view_create_info);
+        r->vk_view = *r->owned_view;
+    }
+}
+
+void RenderGraph::compute_barriers()
+{
+    // what each transient's last pass did to it
+    std::vector<vk::PipelineStageFlags2> last_stages(_resources.size());
+    std::vector<vk::AccessFlags2> last_writes(_resources.size());
+    for (uint32_t p = 0; p < _compiled.size(); p++)
+    {
+        for (const auto &use : _passes[_compiled[p]].uses)
+        {
+            if (!_resources[use.resource].transient || _resources[use.resource].last_pass != p)
+                continue;
+
+            auto info = access_info(use.access);
+            last_stages[use.resource] |= info.stages;
+            if (info.write)
+                last_writes[use.resource] |= info.access;
+        }
+    }
+
+    std::vector<ResourceState> states(_resources.size());
+    for (size_t i = 0; i < _resources.size(); i++)
+    {
+        const auto &r = _resources[i];
+        auto &state = states[i];
+
+        if (!r.transient)
+        {
+            auto info = access_info(r.initial_access);
+            state.layout = info.layout;
+            if (info.write)
+            {
+                state.write_stages = info.stages;
+                state.write_access = info.access;
+            }
+            else
+            {
+                state.read_stages = info.stages;
+            }
+            continue;
+        }
+
+        // contents are discarded, but whatever last touched the same memory, an alias or the image itself in the
+        // previous frame, has to be done with it first
+        auto r_end = r.memory_offset + r.requirements.size;
+        for (size_t j = 0; j < _resources.size(); j++)
+        {
+            const auto &other = _resources[j];
+            if (!other.owned_image)
+                continue;
+
+            if (r.memory_offset < other.memory_offset + other.requirements.size && other.memory_offset < r_end)
+            {
+                state.write_stages |= last_stages[j];
+                state.write_access |= last_writes[j];
+            }
+        }
+    }
+
+    for (auto index : _compiled)
+    {
+        auto &pass = _passes[index];
+        for (const auto &use : pass.uses)
+        {
+            Barrier barrier;
+            if (transition(_resources[use.resource], states[use.resource], use.access, barrier))
+                pass.barriers.push_back(barrier);
+        }
+    }
+
+    for (RenderGraphResource i = 0; i < _resources.size(); i++)
+    {
+        if (_resources[i].final_access == ResourceAccess::eNone)
+            continue;
+
+        Barrier barrier;
+        if (transition(_resources[i], states[i], _resources[i].final_access, barrier))
+            _final_barriers.push_back(barrier);
+    }
+}
+
+bool RenderGraph::transition(const Resource &resource, ResourceState &state, ResourceAccess access, Barrier &barrier) const
+{
+    auto info = access_info(access);
+    bool layout_change = resource.image && info.layout != state.layout;
+
+    barrier = {
+            .resource = static_cast<RenderGraphResource>(&resource - _resources.data()),
+            .dst_stages = info.stages,
+            .dst_access = info.access,
+            .old_layout = state.layout,
+            .new_layout = resource.image ? info.layout : state.layout,
+    };
+
+    if (!info.write && !layout_change)
+    {
+        // a read after a read needs nothing, after a write the write has to be made visible once per stage and access
+        bool visible = !(info.stages & ~state.visible_stages) && !(info.access & ~state.visible_access);
+        state.read_stages |= info.stages;
+        if (!state.write_stages || visible)
+            return false;
+
+        barrier.src_stages = state.write_stages;
+        barrier.src_access = state.write_access;
+        state.visible_stages |= info.stages;
+        state.visible_access |= info.access;
+        return true;
+    }
+
+    // writes and layout transitions wait for every access since the last write, only writes need making available
+    barrier.src_stages = state.write_stages | state.read_stages;
+    barrier.src_access = state.write_access;
+
+    // a transition for a read is itself a write, already visible to the read it was made for
+    state = {
+            .write_stages = info.stages,
+            .write_access = info.write ? info.access : vk::AccessFlags2(),
+            .read_stages = info.write ? vk::PipelineStageFlags2() : info.stages,
+            .visible_stages = info.write ? vk::PipelineStageFlags2() : info.stages,
+            .visible_access = info.write ? vk::AccessFlags2() : info.access,
+            .layout = barrier.new_layout,
+    };
+
+    return layout_change || static_cast<bool>(barrier.src_stages);
+}
+
+void RenderGraph::record_barriers(vk::CommandBuffer command_buffer, std::span<const Barrier> barriers) const
+{
+    if (barriers.empty())
+        return;
+
+    std::vector<vk::ImageMemoryBarrier2> image_barriers;
+    std::vector<vk::BufferMemoryBarrier2> buffer_barriers;
+
+    for (const auto &barrier : barriers)
+    {
+        const auto &r = _resources[barrier.resource];
+        if (r.image)
+        {
+            image_barriers.push_back({
+                    .sType = vk::StructureType::eImageMemoryBarrier2,
+                    .srcStageMask = barrier.src_stages,
+                    .srcAccessMask = barrier.src_access,
+                    .dstStageMask = barrier.dst_stages,
+                    .dstAccessMask = barrier.dst_access,
+                    .oldLayout = barrier.old_layout,
+                    .newLayout = barrier.new_layout,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .image = r.vk_image,
+                    .subresourceRange = {
+                            .aspectMask = aspect_of(r.format),
+                            .baseMipLevel = 0,
+                            .levelCount = VK_REMAINING_MIP_LEVELS,
+                            .baseArrayLayer = 0,
+                            .layerCount = VK_REMAINING_ARRAY_LAYERS,
+                    },
+            });
+        }
+        else
+        {
+            buffer_barriers.push_back({
+                    .sType = vk::StructureType::eBufferMemoryBarrier2,
+                    .srcStageMask = barrier.src_stages,
+                    .srcAccessMask = barrier.src_access,
+                    .dstStageMask = barrier.dst_stages,
+                    .dstAccessMask = barrier.dst_access,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .buffer = r.vk_buffer,
+                    .offset = 0,
+                    .size = VK_WHOLE_SIZE,
+            });
+        }
+    }
+
+    vk::DependencyInfo dependency_info = {
+            .sType = vk::StructureType::eDependencyInfo,
+            .bufferMemoryBarrierCount = static_cast<uint32_t>(buffer_barriers.size()),
+            .pBufferMemoryBarriers = buffer_barriers.data(),
+            .imageMemoryBarrierCount = static_cast<uint32_t>(image_barriers.size()),
+            .pImageMemoryBarriers = image_barriers.data(),
+    };
+    command_buffer.pipelineBarrier2(dependency_info);
+}
+
+} // venture::vulkan
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DeviceAllocator.hpp"
+
+namespace venture::vulkan {
+
+/** Index of a resource inside the RenderGraph that declared it */
+using RenderGraphResource = uint32_t;
+
+/** How a pass touches a resource, each maps to the stages, access mask and image layout barriers are built from */
+enum class ResourceAccess
+{
+    eNone,                  // untouched, contents undefined
+    eAcquired,              // swapchain image handed over by acquire, whose semaphore waits at color attachment output
+    eColorAttachmentWrite,
+    eDepthAttachmentWrite,
+    eDepthAttachmentRead,
+    eFragmentSampledRead,
+    eComputeSampledRead,
+    eComputeStorageRead,
+    eComputeStorageWrite,
+    eIndirectRead,
+    eTransferSrc,
+    eTransferDst,
+    ePresent,
+};
+
+/**
+ * Frame graph, passes declare the resources they read and write and the graph works out the synchronization
+ *
+ * Setup declares resources and passes in submission order, compile() then freezes it:
+ *  - passes whose writes never reach an output (an imported resource with a final access) or a side effect are culled
+ *  - transient images get one memory allocation, images whose lifetimes don't overlap share the same memory
+ *  - the barriers and layout transitions in front of every pass are computed once, merged into one call per pass and
+ *    only emitted for real hazards, reads after reads in the same layout need nothing
+ * A compiled graph is executed once per frame, imported images may be swapped between executions (the acquired
+ * swapchain image). Transient images are shared by all frames in flight, a resource's first barrier waits on the
+ * last use of its memory so consecutive frames on the same queue never overlap on it. Not thread safe.
+ */
+class RenderGraph
+{
+public:
+    using RecordFn = std::function<void(vk::CommandBuffer command_buffer, uint32_t frame_index)>;
+
+    /** Declares what one pass touches, see RenderGraph::add_pass */
+    class PassBuilder
+    {
+    public:
+        PassBuilder &read(RenderGraphResource resource, ResourceAccess access);
+        PassBuilder &write(RenderGraphResource resource, ResourceAccess access);
+        /** kept even when nothing reads what it writes */
+        PassBuilder &side_effect();
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph *graph, uint32_t pass) : _graph(graph), _pass(pass) {}
+
+        RenderGraph *_graph;
+        uint32_t _pass;
+    };
+
+    RenderGraph(vk::Device device, DeviceAllocator *allocator);
+
+    RenderGraph(const RenderGraph&) = delete;
+    void operator=(const RenderGraph&) = delete;
+
+    //--- Setup
+    /** owned elsewhere, final_access is what the image is left in, anything but eNone makes it an output */
+    RenderGraphResource import_image(
+            std::string_view name,
+            vk::Format format,
+            ResourceAccess initial_access,
+            ResourceAccess final_access);
+    RenderGraphResource import_buffer(
+            std::string_view name,
+            vk::Buffer buffer,
+            ResourceAccess initial_access,
+            ResourceAccess final_access);
+    /** owned by the graph, created by compile() with the usage its accesses need and no contents across frames */
+    RenderGraphResource create_image(std::string_view name, vk::Format format, vk::Extent2D extent);
+
+    /** passes execute in the order they are added */
+    PassBuilder add_pass(std::string_view name, RecordFn record);
+
+    /** cull passes, place transient memory and compute barriers, setup is frozen afterwards */
+    void compile();
+
+    //--- Execution
+    /** imported images only, the image must be set before every execute() it changes for */
+    void set_image(RenderGraphResource resource, vk::Image image, vk::ImageView view);
+    void execute(vk::CommandBuffer command_buffer, uint32_t frame_index) const;
+
+    [[nodiscard]]
+    vk::ImageView view(RenderGraphResource resource) const;
+
+    [[nodiscard]]
+    inline uint32_t culled_pass_count() const noexcept;
+    /** bytes the transient images occupy with aliasing, and would without */
+    [[nodiscard]]
+    inline vk::DeviceSize transient_bytes() const noexcept;
+    [[nodiscard]]
+    inline vk::DeviceSize unaliased_bytes() const noexcept;
+
+private:
+    struct Resource
+    {
+        std::string name;
+        bool image = true;
+        bool transient = false;
+        vk::Format format = vk::Format::eUndefined;
+        vk::Extent2D extent;
+        ResourceAccess initial_access = ResourceAccess::eNone;
+        ResourceAccess final_access = ResourceAccess::eNone;
+
+        vk::Image vk_image;
+        vk::ImageView vk_view;
+        vk::Buffer vk_buffer;
+
+        // transient only
+        vk::UniqueImage owned_image;
+        vk::UniqueImageView owned_view;
+        vk::ImageUsageFlags usage;
+        vk::MemoryRequirements requirements;
+        vk::DeviceSize memory_offset = 0;
+        uint32_t first_pass = UINT32_MAX; // lifetime in compiled pass indices
+        uint32_t last_pass = 0;
+    };
+
+    struct Use
+    {
+        RenderGraphResource resource;
+        ResourceAccess access;
+        bool write;
+    };
+
+    struct Barrier
+    {
+        RenderGraphResource resource;
+        vk::PipelineStageFlags2 src_stages;
+        vk::AccessFlags2 src_access;
+        vk::PipelineStageFlags2 dst_stages;
+        vk::AccessFlags2 dst_access;
+        vk::ImageLayout old_layout;
+        vk::ImageLayout new_layout;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        RecordFn record;
+        std::vector<Use> uses;
+        bool side_effect = false;
+        std::vector<Barrier> barriers; // in front of the pass, filled by compile()
+    };
+
+    /** what a barrier in front of the next access has to wait for */
+    struct ResourceState
+    {
+        vk::PipelineStageFlags2 write_stages;
+        vk::AccessFlags2 write_access;
+        vk::PipelineStageFlags2 read_stages;   // since the last write
+        vk::PipelineStageFlags2 visible_stages; // the last write is already visible to these
+        vk::AccessFlags2 visible_access;
+        vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+    };
+
+    void add_use(uint32_t pass, RenderGraphResource resource, ResourceAccess access, bool write);
+    void cull_passes();
+    void create_transients();
+    void place_transients();
+    void compute_barriers();
+    /** advances state to the access, returns false when no barrier is needed */
+    bool transition(const Resource &resource, ResourceState &state, ResourceAccess access, Barrier &barrier) const;
+    void record_barriers(vk::CommandBuffer command_buffer, std::span<const Barrier> barriers) const;
+
+private:
+    vk::Device _device;
+    DeviceAllocator *_allocator;
+
+    UniqueAllocation _transient_memory; // freed after the images bound to it
+    std::vector<Resource> _resources;
+    std::vector<Pass> _passes;
+    std::vector<uint32_t> _compiled; // indices of the passes that survived culling
+    std::vector<Barrier> _final_barriers;
+    vk::DeviceSize _transient_bytes = 0;
+    vk::DeviceSize _unaliased_bytes = 0;
+    bool _is_compiled = false;
+};
+
+uint32_t RenderGraph::culled_pass_count() const noexcept { return static_cast<uint32_t>(_passes.size() - _compiled.size()); }
+vk::DeviceSize RenderGraph::transient_bytes() const noexcept { return _transient_bytes; }
+vk::DeviceSize RenderGraph::unaliased_bytes() const noexcept { return _unaliased_bytes; }
+
+} // venture::vulkan
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace venture::vulkan {
+
+// host side mirrors of the blocks declared in shaders/, std140/std430 layouts so keep members 16 byte aligned
+
+/** set 0 binding 0, written once per frame, declared for the shaders in shaders/frame.glsl */
+struct FrameUniforms
+{
+    glm::mat4 view_proj;
+    glm::vec4 time; // x = seconds since start, y = delta seconds
+    glm::vec4 frustum[6]; // world space planes, xyz normal pointing inward and w distance
+    glm::uvec4 scene; // x = object count, y = bindless image slot of the scene color target, z = of the detail texture
+    glm::vec4 lod; // x = pixels per world unit at clip w 1, y = error threshold in pixels, see RendererConfig
+    glm::vec4 resolution; // xy = rendered fraction of the scene color target, zw = its texel size, see DynamicResolution
+};
+
+/** LODs a mesh may have, LOD 0 included, assets::MESH_MAX_LODS */
+constexpr uint32_t MAX_MESH_LODS = 8;
+
+/** push constants of every pipeline, storage buffer slots of the scene in the bindless heap, see shaders/bindless.glsl */
+struct PushConstants
+{
+    uint32_t objects;
+    uint32_t mesh_draws;
+    uint32_t draw_commands;
+    uint32_t draw_counts;
+};
+
+/** bindless storage buffer, one per object, indexed by firstInstance of the indirect draw */
+struct ObjectData
+{
+    glm::mat4 model;
+    glm::vec4 bounds; // object space bounding sphere, copied from the Mesh
+    uint32_t mesh;
+    uint32_t padding[3];
+};
+
+struct MeshLodData
+{
+    uint32_t index_count;
+    uint32_t first_index;
+    float error; // object space, the culling pass projects it to pixels
+    uint32_t padding;
+};
+
+/** bindless storage buffer, one per mesh, where the culling pass writes the mesh's draws at the LOD it picks */
+struct MeshDrawData
+{
+    int32_t vertex_offset;
+    uint32_t command_offset; // first vk::DrawIndexedIndirectCommand of the mesh's region
+    uint32_t lod_count;
+    uint32_t padding;
+    MeshLodData lods[MAX_MESH_LODS];
+};
+
+} // venture::vulkan
@@ -0,0 +1,27 @@
+#include "ShaderRegistry.hpp"
+#include "error_handling/Check.hpp"
+
+namespace venture::vulkan {
+
+ShaderRegistry::ShaderRegistry(vk::Device device) : _device(device) {}
+
+vk::ShaderModule ShaderRegistry::get(std::span<const uint32_t> spirv)
+{
+    std::lock_guard lock(_mutex);
+
+    if (auto it = _modules.find(spirv.data()); it != _modules.end())
+        return *it->second;
+
+    check_DEBUG(!spirv.empty() && spirv[0] == 0x07230203); // SPIR-V magic number
+
+    vk::ShaderModuleCreateInfo shader_module_create_info = {
+            .sType = vk::StructureType::eShaderModuleCreateInfo,
+            .codeSize = spirv.size_bytes(),
+            .pCode = spirv.data(),
+    };
+
+    auto [it, _] = _modules.emplace(spirv.data(), _device.createShaderModuleUnique(shader_module_create_info));
+    return *it->second;
+}
+
+} // venture::vulkan
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <mutex>
+#include <span>
+#include <unordered_map>
+
+namespace venture::vulkan {
+
+/**
+ * Owns every vk::ShaderModule, each embedded SPIR-V array is turned into a module once and shared by all pipelines
+ * that use it. Keyed by the address of the array which is static for the life of the program. Thread safe so
+ * pipelines can be compiled on worker threads.
+ */
+class ShaderRegistry
+{
+public:
+    explicit ShaderRegistry(vk::Device device);
+
+    ShaderRegistry(const ShaderRegistry&) = delete;
+    void operator=(const ShaderRegistry&) = delete;
+
+    [[nodiscard]]
+    vk::ShaderModule get(std::span<const uint32_t> spirv);
+
+private:
+    vk::Device _device;
+    std::mutex _mutex;
+    std::unordered_map<const uint32_t *, vk::UniqueShaderModule> _modules;
+};
+
+} // venture::vulkan
@@ -0,0 +1,462 @@
+#include "StagingUploader.hpp"
+#include <algorithm>
+#include <cstring>
+#include "error_handling/Check.hpp"
+
+namespace venture::vulkan {
+
+StagingUploader::StagingUploader(
+        vk::Device device,
+        DeviceAllocator *allocator,
+        QueueTimeline *transfer,
+        QueueTimeline *graphics,
+        vk::DeviceSize ring_size)
+        : _device(device),
+          _transfer(transfer),
+          _graphics(graphics),
+          _transfer_family_index(transfer->family_index()),
+          _graphics_family_index(graphics->family_index()),
+          _ring_size(ring_size)
+{
+    vk::CommandPoolCreateInfo transfer_pool_create_info = {
+            .sType = vk::StructureType::eCommandPoolCreateInfo,
+            .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+            .queueFamilyIndex = _transfer_family_index,
+    };
+    _transfer_command_pool = _device.createCommandPoolUnique(transfer_pool_create_info);
+
+    vk::CommandPoolCreateInfo acquire_pool_create_info = {
+            .sType = vk::StructureType::eCommandPoolCreateInfo,
+            .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+            .queueFamilyIndex = _graphics_family_index,
+    };
+    _acquire_command_pool = _device.createCommandPoolUnique(acquire_pool_create_info);
+
+    vk::BufferCreateInfo ring_create_info = {
+            .sType = vk::StructureType::eBufferCreateInfo,
+            .size = _ring_size,
+            .usage = vk::BufferUsageFlagBits::eTransferSrc,
+            .sharingMode = vk::SharingMode::eExclusive,
+    };
+    _ring = allocator->create_buffer(ring_create_info, MemoryUsage::eCpuOnly);
+    check(_ring.allocation->mapped != nullptr);
+
+    _recording = make_batch();
+}
+
+StagingUploader::~StagingUploader()
+{
+    for (auto &batch : _in_flight)
+    {
+        _transfer->wait(batch->transfer_value);
+        if (is_cross_family() && batch->acquire_submitted)
+            _graphics->wait(batch->acquire_value);
+    }
+}
+
+void StagingUploader::upload(
+        vk::Buffer dst,
+        vk::DeviceSize dst_offset,
+        std::span<const std::byte> data,
+        vk::PipelineStageFlags2 dst_stage,
+        vk::AccessFlags2 dst_access)
+{
+    checkf(!data.empty(), "empty upload");
+
+    // large uploads are split so a single resource can never need the whole ring at once
+    const vk::DeviceSize max_chunk = _ring_size / 4;
+
+    while (!data.empty())
+    {
+        auto chunk = std::min<vk::DeviceSize>(data.size(), max_chunk);
+        auto ring_offset = stage(data.first(chunk));
+
+        _recording->copies.push_back({
+                .dst = dst,
+                .region = { .srcOffset = ring_offset, .dstOffset = dst_offset, .size = chunk },
+                .dst_stage = dst_stage,
+                .dst_access = dst_access,
+        });
+
+        data = data.subspan(chunk);
+        dst_offset += chunk;
+    }
+}
+
+void StagingUploader::upload_image(
+        vk::Image dst,
+        uint32_t mip,
+        vk::Extent2D extent,
+        uint32_t block_height,
+        std::span<const std::byte> data,
+        vk::PipelineStageFlags2 dst_stage,
+        vk::AccessFlags2 dst_access)
+{
+    checkf(!data.empty(), "empty image upload");
+
+    // split along rows of blocks, chunks landing in different batches are ordered by the transfer queue
+    const vk::DeviceSize max_chunk = _ring_size / 4;
+
+    uint32_t block_rows = (extent.height + block_height - 1) / block_height;
+    vk::DeviceSize row_bytes = data.size() / block_rows;
+    check(block_rows > 0 && row_bytes * block_rows == data.size() && row_bytes <= _ring_size);
+    auto rows_per_chunk = static_cast<uint32_t>(std::max<vk::DeviceSize>(max_chunk / row_bytes, 1));
+
+    for (uint32_t row = 0; row < block_rows; row += rows_per_chunk)
+    {
+        uint32_t rows = std::min(rows_per_chunk, block_rows - row);
+        auto ring_offset = stage(data.subspan(row * row_bytes, rows * row_bytes));
+
+        uint32_t y = row * block_height;
+        _recording->copies.push_back({
+                .dst_image = dst,
+                .image_region = {
+                        .bufferOffset = ring_offset,
+                        .bufferRowLength = 0, // tightly packed
+                        .bufferImageHeight = 0,
+                        .imageSubresource = {
+                                .aspectMask = vk::ImageAspectFlagBits::eColor,
+                                .mipLevel = mip,
+                                .baseArrayLayer = 0,
+                                .layerCount = 1,
+                        },
+                        .imageOffset = { 0, static_cast<int32_t>(y), 0 },
+                        .imageExtent = { extent.width, std::min(rows * block_height, extent.height - y), 1 },
+                },
+                .first_chunk = row == 0,
+                .last_chunk = row + rows == block_rows,
+                .dst_stage = dst_stage,
+                .dst_access = dst_access,
+        });
+    }
+}
+
+UploadTicket StagingUploader::flush()
+{
+    if (_recording->copies.empty())
+        return _last_ticket;
+
+    auto batch = std::move(_recording);
+    _recording = make_batch();
+
+    batch->ticket = ++_last_ticket;
+    batch->ring_end = _ring_head;
+    record_transfer(*batch);
+
+    batch->transfer_value = _transfer->submit(std::span(&batch->transfer_commands.get(), 1));
+
+    // on a single family the copy is on the graphics queue already, submission order makes it visible
+    batch->acquire_submitted = !is_cross_family();
+    if (is_cross_family())
+        record_acquire(*batch);
+
+    auto ticket = batch->ticket;
+    _in_flight.emplace_back(std::move(batch));
+    update_ready();
+    return ticket;
+}
+
+void StagingUploader::update()
+{
+    for (auto &batch : _in_flight)
+    {
+        if (!batch->acquire_submitted && _transfer->completed(batch->transfer_value))
+            submit_acquire(*batch);
+    }
+
+    // retire in order so the ring tail only moves forward
+    while (!_in_flight.empty())
+    {
+        auto &oldest = _in_flight.front();
+        bool transfer_done = _transfer->completed(oldest->transfer_value);
+        bool acquire_done = !is_cross_family() ||
+                            (oldest->acquire_submitted && _graphics->completed(oldest->acquire_value));
+        if (!transfer_done || !acquire_done)
+            break;
+
+        _ring_tail = oldest->ring_end;
+        oldest->copies.clear();
+        oldest->acquire_submitted = false;
+        _free_batches.emplace_back(std::move(oldest));
+        _in_flight.pop_front();
+    }
+
+    update_ready();
+}
+
+void StagingUploader::wait(UploadTicket ticket)
+{
+    check_DEBUG(ticket <= pending_ticket());
+
+    // the pending ticket is only ever reached once its batch goes out, an empty batch is covered by the last one
+    if (ticket == pending_ticket())
+        ticket = flush();
+
+    while (!is_ready(ticket))
+        wait_oldest();
+}
+
+std::unique_ptr<StagingUploader::Batch> StagingUploader::make_batch()
+{
+    if (!_free_batches.empty())
+    {
+        auto batch = std::move(_free_batches.back());
+        _free_batches.pop_back();
+        return batch;
+    }
+
+    auto batch = std::make_unique<Batch>();
+
+    vk::CommandBufferAllocateInfo transfer_alloc_info = {
+            .sType = vk::StructureType::eCommandBufferAllocateInfo,
+            .commandPool = *_transfer_command_pool,
+            .level = vk::CommandBufferLevel::ePrimary,
+            .commandBufferCount = 1,
+    };
+    batch->transfer_commands = std::move(_device.allocateCommandBuffersUnique(transfer_alloc_info)[0]);
+
+    vk::CommandBufferAllocateInfo acquire_alloc_info = {
+            .sType = vk::StructureType::eCommandBufferAllocateInfo,
+            .commandPool = *_acquire_command_pool,
+            .level = vk::CommandBufferLevel::ePrimary,
+            .commandBufferCount = 1,
+    };
+    batch->acquire_commands = std::move(_device.allocateCommandBuffersUnique(acquire_alloc_info)[0]);
+
+    return batch;
+}
+
+bool StagingUploader::ring_allocate(vk::DeviceSize size, vk::DeviceSize &offset)
+{
+    constexpr uint64_t alignment = 16;
+
+    // a copy never wraps, skip whatever is left at the end of the ring instead
+    uint64_t start = (_ring_head + alignment - 1) & ~(alignment - 1);
+    uint64_t physical = start % _ring_size;
+    if (physical + size > _ring_size)
+        start += _ring_size - physical;
+
+    if (start + size - _ring_tail > _ring_size)
+        return false;
+
+    offset = start % _ring_size;
+    _ring_head = start + size;
+    return true;
+}
+
+vk::DeviceSize StagingUploader::stage(std::span<const std::byte> data)
+{
+    vk::DeviceSize ring_offset = 0;
+    while (!ring_allocate(data.size(), ring_offset))
+    {
+        // ring full, the recording batch has to go out before its space can ever come back
+        if (!_recording->copies.empty())
+            flush();
+        wait_oldest();
+    }
+
+    std::memcpy(static_cast<std::byte *>(_ring.allocation->mapped) + ring_offset, data.data(), data.size());
+    return ring_offset;
+}
+
+vk::ImageMemoryBarrier2 StagingUploader::image_barrier(
+        const Copy &copy,
+        vk::ImageLayout old_layout,
+        vk::ImageLayout new_layout)
+{
+    return {
+            .sType = vk::StructureType::eImageMemoryBarrier2,
+            .srcStageMask = vk::PipelineStageFlagBits2::eNone,
+            .srcAccessMask = vk::AccessFlagBits2::eNone,
+            .dstStageMask = vk::PipelineStageFlagBits2::eCopy,
+            .dstAccessMask = vk::AccessFlagBits2::eTransferWrite,
+            .oldLayout = old_layout,
+            .newLayout = new_layout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = copy.dst_image,
+            .subresourceRange = {
+                    .aspectMask = vk::ImageAspectFlagBits::eColor,
+                    .baseMipLevel = copy.image_region.imageSubresource.mipLevel,
+                    .levelCount = 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+            },
+    };
+}
+
+void StagingUploader::record_transfer(Batch &batch) const
+{
+    auto cmd = *batch.transfer_commands;
+    bool cross_family = is_cross_family();
+
+    vk::CommandBufferBeginInfo command_buffer_begin_info = {
+            .sType = vk::StructureType::eCommandBufferBeginInfo,
+            .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+    };
+    cmd.begin(command_buffer_begin_info);
+
+    // image levels start out undefined, later commands in submission order are covered so chunks in following
+    // batches need no barrier of their own
+    std::vector<vk::ImageMemoryBarrier2> image_barriers;
+    for (const auto &copy : batch.copies)
+    {
+        if (copy.first_chunk)
+            image_barriers.push_back(image_barrier(copy, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal));
+    }
+
+    if (!image_barriers.empty())
+    {
+        cmd.pipelineBarrier2({
+                .sType = vk::StructureType::eDependencyInfo,
+                .imageMemoryBarrierCount = static_cast<uint32_t>(image_barriers.size()),
+                .pImageMemoryBarriers = image_barriers.data(),
+        });
+        image_barriers.clear();
+    }
+
+    std::vector<vk::BufferMemoryBarrier2> barriers;
+
+    for (const auto &copy : batch.copies)
+    {
+        if (copy.dst_image)
+        {
+            cmd.copyBufferToImage(*_ring.buffer, copy.dst_image, vk::ImageLayout::eTransferDstOptimal, copy.image_region);
+
+            // same release as buffers below, the level is readable once its last chunk landed
+            if (copy.last_chunk)
+            {
+                auto &barrier = image_barriers.emplace_back(image_barrier(
+                        copy, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal));
+                barrier.srcStageMask = vk::PipelineStageFlagBits2::eCopy;
+                barrier.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+                barrier.dstStageMask = cross_family ? vk::PipelineStageFlags2() : copy.dst_stage;
+                barrier.dstAccessMask = cross_family ? vk::AccessFlags2() : copy.dst_access;
+                barrier.srcQueueFamilyIndex = cross_family ? _transfer_family_index : VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = cross_family ? _graphics_family_index : VK_QUEUE_FAMILY_IGNORED;
+            }
+            continue;
+        }
+
+        cmd.copyBuffer(*_ring.buffer, copy.dst, copy.region);
+
+        // across families this is the release half, the destination scope belongs to the acquire
+        barriers.push_back({
+                .sType = vk::StructureType::eBufferMemoryBarrier2,
+                .srcStageMask = vk::PipelineStageFlagBits2::eCopy,
+                .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+                .dstStageMask = cross_family ? vk::PipelineStageFlags2() : copy.dst_stage,
+                .dstAccessMask = cross_family ? vk::AccessFlags2() : copy.dst_access,
+                .srcQueueFamilyIndex = cross_family ? _transfer_family_index : VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = cross_family ? _graphics_family_index : VK_QUEUE_FAMILY_IGNORED,
+                .buffer = copy.dst,
+                .offset = copy.region.dstOffset,
+                .size = copy.region.size,
+        });
+    }
+
+    vk::DependencyInfo dependency_info = {
+            .sType = vk::StructureType::eDependencyInfo,
+            .bufferMemoryBarrierCount = static_cast<uint32_t>(barriers.size()),
+            .pBufferMemoryBarriers = barriers.data(),
+            .imageMemoryBarrierCount = static_cast<uint32_t>(image_barriers.size()),
+            .pImageMemoryBarriers = image_barriers.data(),
+    };
+    cmd.pipelineBarrier2(dependency_info);
+    cmd.end();
+}
+
+void StagingUploader::record_acquire(Batch &batch) const
+{
+    auto cmd = *batch.acquire_commands;
+
+    vk::CommandBufferBeginInfo command_buffer_begin_info = {
+            .sType = vk::StructureType::eCommandBufferBeginInfo,
+            .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+    };
+    cmd.begin(command_buffer_begin_info);
+
+    std::vector<vk::BufferMemoryBarrier2> barriers;
+    std::vector<vk::ImageMemoryBarrier2> image_barriers;
+
+    // must match the release barriers exactly
+    for (const auto &copy : batch.copies)
+    {
+        if (copy.dst_image)
+        {
+            if (copy.last_chunk)
+            {
+                auto &barrier = image_barriers.emplace_back(image_barrier(
+                        copy, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal));
+                barrier.dstStageMask = copy.dst_stage;
+                barrier.dstAccessMask = copy.dst_access;
+                barrier.srcQueueFamilyIndex = _transfer_family_index;
+                barrier.dstQueueFamilyIndex = _graphics_family_index;
+            }
+            continue;
+        }
+
+        barriers.push_back({
+                .sType = vk::StructureType::eBufferMemoryBarrier2,
+                .srcStageMask = {},
+                .srcAccessMask = {},
+                .dstStageMask = copy.dst_stage,
+                .dstAccessMask = copy.dst_access,
+                .srcQueueFamilyIndex = _transfer_family_index,
+                .dstQueueFamilyIndex = _graphics_family_index,
+                .buffer = copy.dst,
+                .offset = copy.region.dstOffset,
+                .size = copy.region.size,
+        });
+    }
+
+    vk::DependencyInfo dependency_info = {
+            .sType = vk::StructureType::eDependencyInfo,
+            .bufferMemoryBarrierCount = static_cast<uint32_t>(barriers.size()),
+            .pBufferMemoryBarriers = barriers.data(),
+            .imageMemoryBarrierCount = static_cast<uint32_t>(image_barriers.size()),
+            .pImageMemoryBarriers = image_barriers.data(),
+    };
+    cmd.pipelineBarrier2(dependency_info);
+    cmd.end();
+}
+
+void StagingUploader::submit_acquire(Batch &batch)
+{
+    // the transfer value has been observed on the host, so this never makes graphics wait on the copy
+    batch.acquire_value = _graphics->submit(std::span(&batch.acquire_commands.get(), 1));
+    batch.acquire_submitted = true;
+}
+
+void StagingUploader::update_ready()
+{
+    _ready_ticket = _last_ticket;
+    for (const auto &batch : _in_flight)
+    {
+        if (!batch->acquire_submitted)
+        {
+            _ready_ticket = batch->ticket - 1;
+            break;
+        }
+    }
+}
+
+void StagingUploader::wait_oldest()
+{
+    if (_in_flight.empty())
+        return;
+
+    auto &oldest = *_in_flight.front();
+    _transfer->wait(oldest.transfer_value);
+
+    if (is_cross_family())
+    {
+        if (!oldest.acquire_submitted)
+            submit_acquire(oldest);
+        _graphics->wait(oldest.acquire_value);
+    }
+
+    update();
+}
+
+} // venture::vulkan
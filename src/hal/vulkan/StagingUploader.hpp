@@ -0,0 +1,146 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <deque>
+#include <memory>
+#include <span>
+#include <vector>
+#include "DeviceAllocator.hpp"
+#include "QueueTimeline.hpp"
+
+namespace venture::vulkan {
+
+/** Identifies a flushed upload batch, see StagingUploader::is_ready */
+using UploadTicket = uint64_t;
+
+/**
+ * Streams data into device local buffers and images through a persistently mapped staging ring
+ *
+ * Copies are recorded into batches and submitted by flush() on the transfer queue. When the transfer queue belongs to
+ * its own family the batch releases ownership of the destination ranges, and update() submits the matching acquire
+ * on the graphics queue only after the transfer timeline has reached the batch, so graphics never waits on a copy in
+ * flight.
+ * Not thread safe, owned and driven by the render thread.
+ */
+class StagingUploader
+{
+public:
+    StagingUploader(
+            vk::Device device,
+            DeviceAllocator *allocator,
+            QueueTimeline *transfer,
+            QueueTimeline *graphics,
+            vk::DeviceSize ring_size = 32 << 20);
+    /** waits for every batch in flight */
+    ~StagingUploader();
+
+    StagingUploader(const StagingUploader&) = delete;
+    void operator=(const StagingUploader&) = delete;
+
+    /** dst_stage and dst_access describe the first graphics use of the data, e.g. vertex input, data must not be empty */
+    void upload(
+            vk::Buffer dst,
+            vk::DeviceSize dst_offset,
+            std::span<const std::byte> data,
+            vk::PipelineStageFlags2 dst_stage,
+            vk::AccessFlags2 dst_access);
+    /**
+     * one mip level of a 2D image, data is tightly packed rows of texel blocks block_height texels high. The level
+     * goes from undefined to eShaderReadOnlyOptimal, nothing else may touch it until the upload's ticket is ready
+     */
+    void upload_image(
+            vk::Image dst,
+            uint32_t mip,
+            vk::Extent2D extent,
+            uint32_t block_height,
+            std::span<const std::byte> data,
+            vk::PipelineStageFlags2 dst_stage,
+            vk::AccessFlags2 dst_access);
+
+    /** submit everything uploaded since the last flush */
+    UploadTicket flush();
+    /** non blocking, hand finished transfers over to graphics and recycle completed batches, call once a frame */
+    void update();
+    /** block until the ticket is ready, flushes first when it is the pending ticket */
+    void wait(UploadTicket ticket);
+
+    /** ready means graphics work submitted from now on sees the data */
+    [[nodiscard]]
+    inline bool is_ready(UploadTicket ticket) const noexcept;
+    /** ticket the next flush() will return, covers everything uploaded so far */
+    [[nodiscard]]
+    inline UploadTicket pending_ticket() const noexcept;
+    [[nodiscard]]
+    inline bool is_cross_family() const noexcept;
+
+private:
+    struct Copy
+    {
+        vk::Buffer dst; // null for image copies
+        vk::BufferCopy region;
+        vk::Image dst_image;
+        vk::BufferImageCopy image_region;
+        bool first_chunk = false; // of its mip level, transitions the level out of undefined
+        bool last_chunk = false;  // of its mip level, transitions the level to shader read and releases it
+        vk::PipelineStageFlags2 dst_stage;
+        vk::AccessFlags2 dst_access;
+    };
+
+    struct Batch
+    {
+        UploadTicket ticket = 0;
+        vk::UniqueCommandBuffer transfer_commands;
+        vk::UniqueCommandBuffer acquire_commands; // graphics family, only used across families
+        uint64_t transfer_value = 0; // on the transfer timeline
+        uint64_t acquire_value = 0;  // on the graphics timeline, only used across families
+        std::vector<Copy> copies;
+        uint64_t ring_end = 0;
+        bool acquire_submitted = false;
+    };
+
+    [[nodiscard]]
+    std::unique_ptr<Batch> make_batch();
+    [[nodiscard]]
+    bool ring_allocate(vk::DeviceSize size, vk::DeviceSize &offset);
+    /** blocks until the ring has room, returns the offset data was copied to */
+    [[nodiscard]]
+    vk::DeviceSize stage(std::span<const std::byte> data);
+    /** the copy's whole mip level, defaults to a transition in front of the copy */
+    [[nodiscard]]
+    static vk::ImageMemoryBarrier2 image_barrier(const Copy &copy, vk::ImageLayout old_layout, vk::ImageLayout new_layout);
+    void record_transfer(Batch &batch) const;
+    void record_acquire(Batch &batch) const;
+    void submit_acquire(Batch &batch);
+    void update_ready();
+    void wait_oldest();
+
+private:
+    vk::Device _device;
+    QueueTimeline *_transfer; // the graphics timeline when there is no dedicated transfer family
+    QueueTimeline *_graphics;
+    uint32_t _transfer_family_index;
+    uint32_t _graphics_family_index;
+
+    vk::UniqueCommandPool _transfer_command_pool;
+    vk::UniqueCommandPool _acquire_command_pool;
+
+    //--- Ring
+    // head and tail only ever grow, the physical offset is the value modulo the ring size
+    AllocatedBuffer _ring;
+    vk::DeviceSize _ring_size;
+    uint64_t _ring_head = 0;
+    uint64_t _ring_tail = 0;
+
+    //--- Batches
+    std::unique_ptr<Batch> _recording;
+    std::deque<std::unique_ptr<Batch>> _in_flight;
+    std::vector<std::unique_ptr<Batch>> _free_batches;
+    UploadTicket _last_ticket = 0;
+    UploadTicket _ready_ticket = 0;
+};
+
+bool StagingUploader::is_ready(UploadTicket ticket) const noexcept { return ticket <= _ready_ticket; }
+UploadTicket StagingUploader::pending_ticket() const noexcept { return _last_ticket + 1; }
+bool StagingUploader::is_cross_family() const noexcept { return _transfer_family_index != _graphics_family_index; }
+
+} // venture::vulkan
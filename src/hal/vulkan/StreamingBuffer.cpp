@@ -0,0 +1,124 @@
+#include "StreamingBuffer.hpp"
+#include <algorithm>
+#include "error_handling/Check.hpp"
+
+namespace venture::vulkan {
+
+StreamingBuffer::StreamingBuffer(
+        vk::Device device,
+        const DeviceProfile &profile,
+        DeviceAllocator *allocator,
+        uint32_t frame_count,
+        vk::DeviceSize frame_size)
+{
+    const auto &limits = profile.limits();
+    _alignment = std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment);
+    _frame_size = (frame_size + _alignment - 1) & ~(_alignment - 1);
+
+    // what a shader can see past a dynamic offset, the tail padding keeps the last partition's window in bounds
+    vk::DeviceSize uniform_range = std::min<vk::DeviceSize>(limits.maxUniformBufferRange, 64 << 10);
+    vk::DeviceSize storage_range = std::min<vk::DeviceSize>(limits.maxStorageBufferRange, _frame_size);
+    vk::DeviceSize padding = std::max(uniform_range, storage_range);
+
+    vk::BufferCreateInfo buffer_create_info = {
+            .sType = vk::StructureType::eBufferCreateInfo,
+            .size = _frame_size * frame_count + padding,
+            .usage = vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer,
+            .sharingMode = vk::SharingMode::eExclusive,
+    };
+    // host coherent, writes need no flush
+    _buffer = allocator->create_buffer(buffer_create_info, MemoryUsage::eCpuToGpu);
+    check(_buffer.allocation->mapped != nullptr);
+
+    //--- Descriptors
+    constexpr auto stages =
+            vk::ShaderStageFlagBits::eVertex |
+            vk::ShaderStageFlagBits::eFragment |
+            vk::ShaderStageFlagBits::eCompute;
+
+    vk::DescriptorSetLayoutBinding bindings[] = {
+            {
+                    .binding = 0,
+                    .descriptorType = vk::DescriptorType::eUniformBufferDynamic,
+                    .descriptorCount = 1,
+                    .stageFlags = stages,
+            },
+            {
+                    .binding = 1,
+                    .descriptorType = vk::DescriptorType::eStorageBufferDynamic,
+                    .descriptorCount = 1,
+                    .stageFlags = stages,
+            },
+    };
+
+    vk::DescriptorSetLayoutCreateInfo layout_create_info = {
+            .sType = vk::StructureType::eDescriptorSetLayoutCreateInfo,
+            .bindingCount = sizeof bindings / sizeof *bindings,
+            .pBindings = bindings,
+    };
+    _layout = device.createDescriptorSetLayoutUnique(layout_create_info);
+
+    vk::DescriptorPoolSize pool_sizes[] = {
+            { .type = vk::DescriptorType::eUniformBufferDynamic, .descriptorCount = 1 },
+            { .type = vk::DescriptorType::eStorageBufferDynamic, .descriptorCount = 1 },
+    };
+
+    vk::DescriptorPoolCreateInfo pool_create_info = {
+            .sType = vk::StructureType::eDescriptorPoolCreateInfo,
+            .maxSets = 1,
+            .poolSizeCount = sizeof pool_sizes / sizeof *pool_sizes,
+            .pPoolSizes = pool_sizes,
+    };
+    _descriptor_pool = device.createDescriptorPoolUnique(pool_create_info);
+
+    vk::DescriptorSetAllocateInfo set_alloc_info = {
+            .sType = vk::StructureType::eDescriptorSetAllocateInfo,
+            .descriptorPool = *_descriptor_pool,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &_layout.get(),
+    };
+    _descriptor_set = device.allocateDescriptorSets(set_alloc_info)[0];
+
+    vk::DescriptorBufferInfo uniform_info = { .buffer = *_buffer.buffer, .offset = 0, .range = uniform_range };
+    vk::DescriptorBufferInfo storage_info = { .buffer = *_buffer.buffer, .offset = 0, .range = storage_range };
+
+    vk::WriteDescriptorSet writes[] = {
+            {
+                    .sType = vk::StructureType::eWriteDescriptorSet,
+                    .dstSet = _descriptor_set,
+                    .dstBinding = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = vk::DescriptorType::eUniformBufferDynamic,
+                    .pBufferInfo = &uniform_info,
+            },
+            {
+                    .sType = vk::StructureType::eWriteDescriptorSet,
+                    .dstSet = _descriptor_set,
+                    .dstBinding = 1,
+                    .descriptorCount = 1,
+                    .descriptorType = vk::DescriptorType::eStorageBufferDynamic,
+                    .pBufferInfo = &storage_info,
+            },
+    };
+    device.updateDescriptorSets(writes, nullptr);
+}
+
+void StreamingBuffer::begin_frame(uint32_t frame_index)
+{
+    _head = _frame_size * frame_index;
+    _frame_end = _head + _frame_size;
+}
+
+StreamAllocation StreamingBuffer::allocate(vk::DeviceSize size)
+{
+    auto offset = (_head + _alignment - 1) & ~(_alignment - 1);
+    checkf(offset + size <= _frame_end, "streaming buffer out of space, %llu bytes per frame", (unsigned long long)_frame_size);
+    _head = offset + size;
+
+    return {
+            .data = static_cast<std::byte *>(_buffer.allocation->mapped) + offset,
+            .offset = static_cast<uint32_t>(offset),
+    };
+}
+
+} // venture::vulkan
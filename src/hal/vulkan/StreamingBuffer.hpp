@@ -0,0 +1,90 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <cstring>
+#include <span>
+#include "DeviceAllocator.hpp"
+#include "DeviceProfile.hpp"
+
+namespace venture::vulkan {
+
+/** A slice of the streaming buffer, data is mapped and offset is the dynamic offset to bind it at */
+struct StreamAllocation
+{
+    void *data = nullptr;
+    uint32_t offset = 0;
+};
+
+/**
+ * Persistently mapped ring of per-frame partitions for data rewritten every frame (camera, transforms, ...)
+ *
+ * Each frame in flight owns one partition that is bump allocated and rewound wholesale by begin_frame() once the
+ * frame's submission has completed, so writes never race the GPU and never allocate. A single descriptor set exposes
+ * the whole buffer as a dynamic uniform (binding 0) and dynamic storage buffer (binding 1), an allocation is
+ * selected at bind time through its offset.
+ */
+class StreamingBuffer
+{
+public:
+    StreamingBuffer(
+            vk::Device device,
+            const DeviceProfile &profile,
+            DeviceAllocator *allocator,
+            uint32_t frame_count,
+            vk::DeviceSize frame_size = 1 << 20);
+
+    StreamingBuffer(const StreamingBuffer&) = delete;
+    void operator=(const StreamingBuffer&) = delete;
+
+    /** the frame's submission must have completed, everything previously written to its partition is discarded */
+    void begin_frame(uint32_t frame_index);
+
+    [[nodiscard]]
+    StreamAllocation allocate(vk::DeviceSize size);
+    template<typename T>
+    [[nodiscard]]
+    StreamAllocation push(const T &value);
+    template<typename T>
+    [[nodiscard]]
+    StreamAllocation push(std::span<const T> values);
+
+    [[nodiscard]]
+    inline vk::DescriptorSetLayout layout() const noexcept;
+    [[nodiscard]]
+    inline vk::DescriptorSet descriptor_set() const noexcept;
+    [[nodiscard]]
+    inline vk::Buffer buffer() const noexcept;
+
+private:
+    AllocatedBuffer _buffer;
+    vk::UniqueDescriptorSetLayout _layout;
+    vk::UniqueDescriptorPool _descriptor_pool;
+    vk::DescriptorSet _descriptor_set; // freed with the pool
+
+    vk::DeviceSize _frame_size;
+    vk::DeviceSize _alignment;
+    vk::DeviceSize _head = 0;
+    vk::DeviceSize _frame_end = 0;
+};
+
+template<typename T>
+StreamAllocation StreamingBuffer::push(const T &value)
+{
+    auto allocation = allocate(sizeof(T));
+    std::memcpy(allocation.data, &value, sizeof(T));
+    return allocation;
+}
+
+template<typename T>
+StreamAllocation StreamingBuffer::push(std::span<const T> values)
+{
+    auto allocation = allocate(values.size_bytes());
+    std::memcpy(allocation.data, values.data(), values.size_bytes());
+    return allocation;
+}
+
+vk::DescriptorSetLayout StreamingBuffer::layout() const noexcept { return *_layout; }
+vk::DescriptorSet StreamingBuffer::descriptor_set() const noexcept { return _descriptor_set; }
+vk::Buffer StreamingBuffer::buffer() const noexcept { return *_buffer.buffer; }
+
+} // venture::vulkan
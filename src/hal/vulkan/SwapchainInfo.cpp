@@ -1,4 +1,5 @@
 #include "SwapchainInfo.hpp"
+#include <algorithm>
 #include <limits>
 #include "error_handling/Check.hpp"
 
@@ -7,14 +8,15 @@ namespace venture::vulkan {
 SwapchainInfo SwapchainInfo::get_info(
         vk::PhysicalDevice physical_device,
         vk::SurfaceKHR surface,
-        const VulkanWindow *window)
+        const VulkanWindow *window,
+        vk::PresentModeKHR preferred_present_mode)
 {
     SwapchainInfo swap_chain_info;
     swap_chain_info.surface_capabilities = physical_device.getSurfaceCapabilitiesKHR(surface);
     swap_chain_info.surface_formats = physical_device.getSurfaceFormatsKHR(surface);
     swap_chain_info.present_modes = physical_device.getSurfacePresentModesKHR(surface);
     swap_chain_info.surface_format = swap_chain_info.find_optimal_surface_format();
-    swap_chain_info.present_mode = swap_chain_info.find_optimal_present_mode();
+    swap_chain_info.present_mode = swap_chain_info.find_optimal_present_mode(preferred_present_mode);
     swap_chain_info.extent = swap_chain_info.find_optimal_extent(window);
     return swap_chain_info;
 }
@@ -34,24 +36,32 @@ vk::SurfaceFormatKHR SwapchainInfo::find_optimal_surface_format() const
         : surface_formats.at(0); // any random format
 }
 
-vk::PresentModeKHR SwapchainInfo::find_optimal_present_mode() const
+vk::PresentModeKHR SwapchainInfo::find_optimal_present_mode(vk::PresentModeKHR preferred) const
 {
-    return std::ranges::find(present_modes, vk::PresentModeKHR::eMailbox) != present_modes.end()
-        ? vk::PresentModeKHR::eMailbox
-        : vk::PresentModeKHR::eFifo;
+    auto supported = [this](vk::PresentModeKHR mode) -> bool {
+        return std::ranges::find(present_modes, mode) != present_modes.end();
+    };
+
+    if (supported(preferred))
+        return preferred;
+
+    // immediate asks not to wait on vblank, mailbox is the closest mode that still honours that
+    if (preferred == vk::PresentModeKHR::eImmediate && supported(vk::PresentModeKHR::eMailbox))
+        return vk::PresentModeKHR::eMailbox;
+
+    return vk::PresentModeKHR::eFifo;
 }
 
 vk::Extent2D SwapchainInfo::find_optimal_extent(const VulkanWindow *window) const
 {
-    // if surface width == INT_MAX then window extent can vary else it is window dimensions
-    if (surface_capabilities.currentExtent.width == std::numeric_limits<uint32_t>::max())
+    // if surface width == UINT32_MAX the surface takes its size from the swapchain, otherwise it must match exactly
+    if (surface_capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max())
         return surface_capabilities.currentExtent;
 
-    uint32_t width, height;
-    glfwGetFramebufferSize(window->_window, (int *)&width, (int *)&height);
+    auto framebuffer = window->framebuffer_extent();
 
-    width  = std::clamp(width,  surface_capabilities.minImageExtent.width,  surface_capabilities.maxImageExtent.width);
-    height = std::clamp(height, surface_capabilities.minImageExtent.height, surface_capabilities.maxImageExtent.height);
+    uint32_t width  = std::clamp(framebuffer.width,  surface_capabilities.minImageExtent.width,  surface_capabilities.maxImageExtent.width);
+    uint32_t height = std::clamp(framebuffer.height, surface_capabilities.minImageExtent.height, surface_capabilities.maxImageExtent.height);
 
     return vk::Extent2D(width, height);
 }
@@ -31,7 +31,8 @@ public:
     static SwapchainInfo get_info(
             vk::PhysicalDevice physical_device,
             vk::SurfaceKHR surface,
-            const VulkanWindow *window);
+            const VulkanWindow *window,
+            vk::PresentModeKHR preferred_present_mode = vk::PresentModeKHR::eMailbox);
 
 private:
     // Prefer
@@ -41,9 +42,9 @@ private:
     vk::SurfaceFormatKHR find_optimal_surface_format() const;
 
     // Prefer
-    //     Present Mode : VK_PRESENT_MODE_MAILBOX_KHR
+    //     Present Mode : preferred, then its closest supported relative, then VK_PRESENT_MODE_FIFO_KHR
     [[nodiscard]]
-    vk::PresentModeKHR find_optimal_present_mode() const;
+    vk::PresentModeKHR find_optimal_present_mode(vk::PresentModeKHR preferred) const;
 
     [[nodiscard]]
     vk::Extent2D find_optimal_extent(const VulkanWindow *window) const;
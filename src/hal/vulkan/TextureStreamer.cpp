@@ -0,0 +1,293 @@
+#include "TextureStreamer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include "error_handling/Check.hpp"
+#include "error_handling/Log.hpp"
+
+namespace venture::vulkan {
+
+namespace {
+
+// the first sampled use of a level, the streamer doesn't know which stages sample it
+constexpr vk::PipelineStageFlags2 SAMPLED_STAGES =
+        vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader;
+
+} // anonymous
+
+TextureStreamer::TextureStreamer(
+        DeviceAllocator *allocator,
+        StagingUploader *uploader,
+        BindlessHeap *heap,
+        const QueueTimeline *graphics,
+        ThreadPool *workers,
+        vk::DeviceSize budget)
+        : _allocator(allocator),
+          _uploader(uploader),
+          _heap(heap),
+          _graphics(graphics),
+          _workers(workers),
+          _device(allocator->device()),
+          _budget(budget)
+{
+    // sampled until a texture's tail arrives, waited on here so it is always valid
+    constexpr uint32_t white = 0xFFFFFFFF;
+    _placeholder = create_residency(vk::Format::eR8G8B8A8Unorm, { 1, 1 }, 1);
+    _uploader->upload_image(
+            *_placeholder.image.image, 0, { 1, 1 }, 1, std::as_bytes(std::span(&white, 1)),
+            SAMPLED_STAGES, vk::AccessFlagBits2::eShaderSampledRead);
+    _uploader->wait(_uploader->flush());
+    _placeholder.slot = _heap->add_image(*_placeholder.view);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    for (auto &texture : _textures)
+    {
+        if (texture.read.valid())
+            texture.read.wait();
+    }
+}
+
+Result<TextureHandle> TextureStreamer::load(const std::filesystem::path &path)
+{
+    auto file = Ktx2File::open(path);
+    if (!file)
+        return Error(file.error());
+
+    Texture texture = {
+            .file = std::move(*file),
+    };
+
+    // the first level small enough for the tail, everything below it is resident for the texture's lifetime
+    texture.tail_level = texture.file.level_count() - 1;
+    for (uint32_t i = 0; i < texture.file.level_count(); i++)
+    {
+        auto extent = texture.file.level(i).extent;
+        if (std::max(extent.width, extent.height) <= TAIL_SIZE)
+        {
+            texture.tail_level = i;
+            break;
+        }
+    }
+
+    auto data = texture.file.read_levels(texture.tail_level);
+    if (!data)
+        return Error(data.error());
+    texture.pending = upload(texture.file, texture.tail_level, *data);
+    texture.pending_ticket = _uploader->pending_ticket();
+    texture.wanted_level = texture.tail_level;
+    texture.last_requested_frame = _frame;
+
+    _textures.push_back(std::move(texture));
+    return static_cast<TextureHandle>(_textures.size() - 1);
+}
+
+void TextureStreamer::request(TextureHandle texture, uint32_t level)
+{
+    auto &requested = _textures[texture].requested_level;
+    requested = std::min(requested, level);
+}
+
+uint32_t TextureStreamer::level_for(TextureHandle texture, vk::Extent2D extent) const
+{
+    // texels per pixel along the denser axis, the finer of the two levels trilinear filtering blends
+    const auto &file = _textures[texture].file;
+    auto size = file.level(0).extent;
+    double ratio = std::max(
+            double(size.width) / std::max(extent.width, 1u),
+            double(size.height) / std::max(extent.height, 1u));
+    auto level = ratio > 1.0 ? static_cast<uint32_t>(std::floor(std::log2(ratio))) : 0u;
+    return std::min(level, file.level_count() - 1);
+}
+
+void TextureStreamer::update()
+{
+    _frame++;
+
+    //--- Finished uploads
+    for (auto &texture : _textures)
+    {
+        if (texture.pending.image.image && _uploader->is_ready(texture.pending_ticket))
+        {
+            retire(texture.resident);
+            texture.resident = std::move(texture.pending);
+            texture.pending = {};
+        }
+    }
+
+    //--- Retired images
+    while (!_retired.empty() && _graphics->completed(_retired.front().first))
+    {
+        _resident_bytes -= _retired.front().second.bytes;
+        _retired.pop_front();
+    }
+
+    //--- Finished reads
+    bool uploaded = false;
+    for (auto &texture : _textures)
+    {
+        if (!texture.read.valid() || texture.read.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            continue;
+
+        auto data = texture.read.get();
+        _reads_in_flight--;
+        if (!data)
+        {
+            // the request is dropped, retrying right away would most likely repeat the failure every frame
+            log(Warning, "texture " << texture.file.path() << " level " << texture.read_level << " not streamed, "
+                         << std::string_view(data.error()) << ", retrying in " << READ_RETRY_FRAMES << " frames");
+            texture.read_retry_frame = _frame + READ_RETRY_FRAMES;
+            continue;
+        }
+
+        texture.pending = upload(texture.file, texture.read_level, *data);
+        texture.pending_ticket = _uploader->pending_ticket();
+        uploaded = true;
+    }
+
+    if (uploaded)
+        _uploader->flush();
+
+    //--- Feedback
+    for (auto &texture : _textures)
+    {
+        if (texture.requested_level != UINT32_MAX)
+        {
+            texture.wanted_level = texture.requested_level;
+            texture.last_requested_frame = _frame;
+        }
+        else if (_frame - texture.last_requested_frame > EVICT_AFTER_FRAMES)
+        {
+            texture.wanted_level = texture.tail_level;
+        }
+        texture.requested_level = UINT32_MAX;
+    }
+
+    //--- New reads
+    // one residency change per texture at a time, growing and shrinking both go through a fresh image
+    auto levels = plan_levels();
+    for (size_t i = 0; i < _textures.size() && _reads_in_flight < MAX_LOADS_IN_FLIGHT; i++)
+    {
+        auto &texture = _textures[i];
+        if (texture.read.valid() || texture.pending.image.image || levels[i] == texture.resident.first_level ||
+            _frame < texture.read_retry_frame)
+            continue;
+
+        // the file is copied so the task never sees _textures move
+        texture.read_level = levels[i];
+        texture.read = _workers->submit([file = texture.file, level = levels[i]] {
+            return file.read_levels(level);
+        });
+        _reads_in_flight++;
+    }
+}
+
+TextureStreamer::Residency TextureStreamer::create_residency(vk::Format format, vk::Extent2D extent, uint32_t level_count)
+{
+    vk::ImageCreateInfo image_create_info = {
+            .sType = vk::StructureType::eImageCreateInfo,
+            .imageType = vk::ImageType::e2D,
+            .format = format,
+            .extent = { extent.width, extent.height, 1 },
+            .mipLevels = level_count,
+            .arrayLayers = 1,
+            .samples = vk::SampleCountFlagBits::e1,
+            .tiling = vk::ImageTiling::eOptimal,
+            .usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,
+            .sharingMode = vk::SharingMode::eExclusive,
+            .initialLayout = vk::ImageLayout::eUndefined,
+    };
+
+    Residency residency;
+    residency.image = _allocator->create_image(image_create_info, MemoryUsage::eGpuOnly);
+    residency.bytes = residency.image.allocation->size;
+    _resident_bytes += residency.bytes;
+
+    vk::ImageViewCreateInfo image_view_create_info = {
+            .sType = vk::StructureType::eImageViewCreateInfo,
+            .image = *residency.image.image,
+            .viewType = vk::ImageViewType::e2D,
+            .format = format,
+            .subresourceRange = {
+                    .aspectMask = vk::ImageAspectFlagBits::eColor,
+                    .baseMipLevel = 0,
+                    .levelCount = level_count,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+            },
+    };
+    residency.view = _device.createImageViewUnique(image_view_create_info);
+
+    return residency;
+}
+
+TextureStreamer::Residency TextureStreamer::upload(
+        const Ktx2File &file,
+        uint32_t first_level,
+        std::span<const std::byte> data)
+{
+    check(data.size() == file.level_bytes(first_level));
+
+    auto residency = create_residency(file.format(), file.level(first_level).extent, file.level_count() - first_level);
+    residency.first_level = first_level;
+
+    for (uint32_t i = first_level; i < file.level_count(); i++)
+    {
+        const auto &level = file.level(i);
+        _uploader->upload_image(
+                *residency.image.image, i - first_level, level.extent, file.block_height(), data.first(level.size),
+                SAMPLED_STAGES, vk::AccessFlagBits2::eShaderSampledRead);
+        data = data.subspan(level.size);
+    }
+
+    // nothing samples the slot before the residency is swapped in, after the upload is ready
+    residency.slot = _heap->add_image(*residency.view);
+    return residency;
+}
+
+void TextureStreamer::retire(Residency &residency)
+{
+    if (!residency.image.image)
+        return;
+
+    // the frame being recorded already reads the replacement's slot
+    _heap->remove_image(residency.slot);
+    _retired.emplace_back(_graphics->last_submitted() + 1, std::move(residency));
+    residency = {};
+}
+
+std::vector<uint32_t> TextureStreamer::plan_levels() const
+{
+    std::vector<uint32_t> levels(_textures.size());
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < _textures.size(); i++)
+    {
+        levels[i] = std::min(_textures[i].wanted_level, _textures[i].tail_level);
+        bytes += _textures[i].file.level_bytes(levels[i]);
+    }
+
+    if (bytes <= _budget)
+        return levels;
+
+    // least recently requested first, each one goes all the way down to its tail before the next is touched
+    std::vector<size_t> order(_textures.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return _textures[a].last_requested_frame < _textures[b].last_requested_frame;
+    });
+
+    for (auto i : order)
+    {
+        const auto &file = _textures[i].file;
+        while (bytes > _budget && levels[i] < _textures[i].tail_level)
+        {
+            bytes -= file.level(levels[i]).size;
+            levels[i]++;
+        }
+    }
+    return levels;
+}
+
+} // venture::vulkan
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "VulkanApi.hpp"
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <span>
+#include <vector>
+#include "BindlessHeap.hpp"
+#include "DeviceAllocator.hpp"
+#include "Ktx2File.hpp"
+#include "QueueTimeline.hpp"
+#include "StagingUploader.hpp"
+#include "error_handling/Result.hpp"
+#include "threading/ThreadPool.hpp"
+
+namespace venture::vulkan {
+
+/** Index of a texture inside the TextureStreamer that loaded it */
+using TextureHandle = uint32_t;
+
+/**
+ * KTX2 textures whose mip levels are streamed in and out of device memory on demand
+ *
+ * load() makes the mip tail (every level at or below TAIL_SIZE) resident right away. Finer levels follow the
+ * feedback passed to request(), the levels are read on the worker pool and uploaded into a new image holding the
+ * requested level and everything below it, which then replaces the old image in the bindless heap. Textures nobody
+ * requested for a while drop back to their tail, and when the wanted levels exceed the memory budget the least
+ * recently requested textures give up their finest levels first.
+ * Residency changes take a new bindless slot, the old one and its image are released once the graphics timeline has
+ * passed every frame that could sample them, so slot() has to be read every frame. Not thread safe, owned and driven
+ * by the render thread. A read that fails is logged and dropped, the texture keeps its levels and reads again after
+ * READ_RETRY_FRAMES, so a transient error neither sticks nor exempts it from the budget and eviction.
+ */
+class TextureStreamer
+{
+public:
+    constexpr static uint32_t TAIL_SIZE = 128;         // largest level dimension that is always resident
+    constexpr static uint32_t EVICT_AFTER_FRAMES = 120; // unrequested frames before a texture drops to its tail
+    constexpr static uint32_t MAX_LOADS_IN_FLIGHT = 4;
+    constexpr static uint32_t READ_RETRY_FRAMES = 60;   // frames a texture waits to read again after a failed read
+
+    TextureStreamer(
+            DeviceAllocator *allocator,
+            StagingUploader *uploader,
+            BindlessHeap *heap,
+            const QueueTimeline *graphics,
+            ThreadPool *workers,
+            vk::DeviceSize budget);
+    /** waits for the reads in flight, the caller must make sure the GPU is done with every image */
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    void operator=(const TextureStreamer&) = delete;
+
+    /** reads the mip tail on the calling thread and queues its upload, the caller decides when to flush */
+    [[nodiscard]]
+    Result<TextureHandle> load(const std::filesystem::path &path);
+
+    /** finest level wanted this frame, the finest request of a frame wins */
+    void request(TextureHandle texture, uint32_t level);
+    /** level the sampler picks when the whole texture covers extent pixels, what a full screen use of it requests */
+    [[nodiscard]]
+    uint32_t level_for(TextureHandle texture, vk::Extent2D extent) const;
+    /** non blocking, swap in finished uploads, free retired images and start new reads, call once a frame */
+    void update();
+
+    /** bindless image slot, a 1x1 white placeholder until the tail is uploaded */
+    [[nodiscard]]
+    inline uint32_t slot(TextureHandle texture) const noexcept;
+    /** the 1x1 white image, for passes sampling a texture that may not be there */
+    [[nodiscard]]
+    inline uint32_t placeholder_slot() const noexcept;
+    /** finest level currently sampled */
+    [[nodiscard]]
+    inline uint32_t resident_level(TextureHandle texture) const noexcept;
+    /** every live texture image, including pending and retired ones */
+    [[nodiscard]]
+    inline vk::DeviceSize resident_bytes() const noexcept;
+    [[nodiscard]]
+    inline vk::DeviceSize budget() const noexcept;
+
+private:
+    /** one image holding levels [first_level, level_count) of a texture */
+    struct Residency
+    {
+        AllocatedImage image;
+        vk::UniqueImageView view;
+        uint32_t first_level = UINT32_MAX;
+        uint32_t slot = UINT32_MAX;
+        vk::DeviceSize bytes = 0;
+    };
+
+    struct Texture
+    {
+        Ktx2File file;
+        uint32_t tail_level = 0;
+        Residency resident;
+        Residency pending;           // uploading, swapped in once the ticket is ready
+        UploadTicket pending_ticket = 0;
+        std::future<Result<std::vector<std::byte>>> read;
+        uint32_t read_level = UINT32_MAX;
+        uint64_t read_retry_frame = 0; // no read starts before this frame, set by a failed one
+        uint32_t requested_level = UINT32_MAX; // this frame
+        uint32_t wanted_level = UINT32_MAX;    // last request, sticky until evicted
+        uint64_t last_requested_frame = 0;
+    };
+
+    [[nodiscard]]
+    Residency create_residency(vk::Format format, vk::Extent2D extent, uint32_t level_count);
+    /** create the image for levels [first_level, level_count) and queue the upload of data */
+    [[nodiscard]]
+    Residency upload(const Ktx2File &file, uint32_t first_level, std::span<const std::byte> data);
+    void retire(Residency &residency);
+    /** finest level each texture may have, wanted levels coarsened until they fit the budget */
+    [[nodiscard]]
+    std::vector<uint32_t> plan_levels() const;
+
+private:
+    DeviceAllocator *_allocator;
+    StagingUploader *_uploader;
+    BindlessHeap *_heap;
+    const QueueTimeline *_graphics;
+    ThreadPool *_workers;
+    vk::Device _device;
+    vk::DeviceSize _budget;
+
+    std::vector<Texture> _textures;
+    Residency _placeholder;
+    std::deque<std::pair<uint64_t, Residency>> _retired; // graphics timeline value, residency
+    vk::DeviceSize _resident_bytes = 0;
+    uint64_t _frame = 0;
+    uint32_t _reads_in_flight = 0;
+};
+
+uint32_t TextureStreamer::slot(TextureHandle texture) const noexcept
+{
+    const auto &resident = _textures[texture].resident;
+    return resident.image.image ? resident.slot : _placeholder.slot;
+}
+
+uint32_t TextureStreamer::placeholder_slot() const noexcept { return _placeholder.slot; }
+
+uint32_t TextureStreamer::resident_level(TextureHandle texture) const noexcept
+{
+    return _textures[texture].resident.first_level;
+}
+
+vk::DeviceSize TextureStreamer::resident_bytes() const noexcept { return _resident_bytes; }
+vk::DeviceSize TextureStreamer::budget() const noexcept { return _budget; }
+
+} // venture::vulkan
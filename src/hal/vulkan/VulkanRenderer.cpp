@@ -1,29 +1,75 @@
 #include "VulkanRenderer.hpp"
-#include <fstream>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
 #include <ranges>
 #include <set>
+#include "ShaderInterface.hpp"
 #include "error_handling/Check.hpp"
 #include "error_handling/Log.hpp"
 #include "Debug.hpp"
+#include "spirv/shader_vert.hpp"
+#include "spirv/shader_frag.hpp"
+#include "spirv/cull_comp.hpp"
+#include "spirv/upscale_vert.hpp"
+#include "spirv/upscale_frag.hpp"
 
 namespace venture::vulkan {
 
-VulkanRenderer::VulkanRenderer(VulkanWindow *window) : IRenderer(window)
-// no member initializer because all members are POD or require create functions
+namespace {
+
+// one range shared by every pipeline on the common layout, see shaders/bindless.glsl
+constexpr vk::ShaderStageFlags PUSH_CONSTANT_STAGES =
+        vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment | vk::ShaderStageFlagBits::eCompute;
+
+vk::PresentModeKHR to_present_mode(PresentPolicy policy)
+{
+    switch (policy)
+    {
+        case PresentPolicy::Immediate:   return vk::PresentModeKHR::eImmediate;
+        case PresentPolicy::Mailbox:     return vk::PresentModeKHR::eMailbox;
+        case PresentPolicy::Fifo:        return vk::PresentModeKHR::eFifo;
+        case PresentPolicy::FifoRelaxed: return vk::PresentModeKHR::eFifoRelaxed;
+    }
+    return vk::PresentModeKHR::eFifo;
+}
+
+} // anonymous
+
+VulkanRenderer::VulkanRenderer(VulkanWindow *window, const RendererConfig &config)
+        : IRenderer(window),
+          _workers(config.worker_threads),
+          _config(config)
+// no other member initializers because all members are POD or require create functions
 {
     try {
         create_instance();
-        create_surface();
+        if (!_window->is_headless())
+            create_surface();
         retrieve_physical_device();
         create_logical_device();
-        create_swapchain();
-        create_render_pass();
+        create_queue_timelines();
+        create_async_compute();
+        create_present_latency();
+        create_allocator();
+        create_uploader();
+        create_bindless_heap();
+        create_texture_streamer();
+        create_streaming_buffer();
+        create_gpu_scene();
+        create_pipeline_cache();
+        create_shader_registry();
+        if (!_window->is_headless())
+            create_swapchain();
+        else
+            create_offscreen_targets();
         create_graphics_pipeline();
-        create_framebuffers();
-        create_graphics_command_pool();
-        create_command_buffers();
-        record_commands();
-        create_synchronization();
+        create_frame_contexts();
+        create_parallel_recorder();
+        create_gpu_profiler();
+        create_dynamic_resolution();
+        create_meshes();
+        create_render_graph();
     } catch (const std::exception &e) {
         log(Error, e.what());
         throw e; // unwind stack and crash program
@@ -33,53 +79,160 @@ VulkanRenderer::VulkanRenderer(VulkanWindow *window) : IRenderer(window)
 VulkanRenderer::~VulkanRenderer()
 {
     _logical_device->waitIdle();
+
+    if (_present_latency && _present_latency->sample_count() > 0)
+    {
+        log(Info, "present latency " << _present_latency->average_ms() << " ms average over "
+                  << _present_latency->sample_count() << " presents");
+    }
+}
+
+void VulkanRenderer::wait_idle()
+{
+    _logical_device->waitIdle();
+}
+
+void VulkanRenderer::set_present_policy(PresentPolicy policy)
+{
+    _config.present_policy = policy;
+    _swapchain_dirty = !_window->is_headless();
 }
 
 void VulkanRenderer::draw()
 {
     //--- Get Next Image
     constexpr uint32_t timeout = UINT32_MAX;
+    bool headless = _window->is_headless();
+
+    // the engine polls input right before drawing, this is as close to input sampling as the renderer gets
+    auto input_time = std::chrono::steady_clock::now();
+
+    // recreated before touching the frame, a skipped frame leaves the context untouched
+    if (!headless && (_window->consume_resize() || _swapchain_dirty))
+    {
+        _swapchain_dirty = !recreate_swapchain();
+        if (_swapchain_dirty)
+        {
+            // minimized, sleep until the window changes instead of spinning the main loop
+            _window->wait_events();
+            return;
+        }
+    }
+
+    if (_present_latency)
+        _present_latency->poll(*_swapchain);
+
+    auto &frame = _frames[_frame_index];
 
-    auto result = _logical_device->waitForFences(*_draw_fences[_frame_counter], true, timeout);
-    check(result == vk::Result::eSuccess);
-    _logical_device->resetFences(*_draw_fences[_frame_counter]);
+    _graphics_timeline->wait(frame.timeline_value);
 
-    auto [res, image_index] = _logical_device->acquireNextImageKHR(*_swapchain, timeout, *_draw_locks[_frame_counter], VK_NULL_HANDLE);
-    check(res == vk::Result::eSuccess);
+    // cpu time excludes the timeline wait, a frame spending its time there is gpu bound
+    auto cpu_start = std::chrono::steady_clock::now();
+
+    // the frame that last used this context is complete, so is everything submitted before it
+    if (frame.pending)
+    {
+        std::erase_if(_retired_swapchains, [&](const RetiredSwapchain &retired) {
+            return frame.frame_number >= retired.retire_frame;
+        });
+
+        if (_profiler)
+            _profiler->collect(_frame_index, frame.frame_number, frame.cpu_ms);
+        if (_resolution)
+            _resolution->collect(_frame_index);
+        frame.pending = false;
+    }
+
+    _uploader->update();
+    _textures->update();
+    _bindless->collect();
+
+    // headless owns one offscreen image per frame in flight, nothing to acquire
+    uint32_t image_index = _frame_index;
+    if (!headless)
+    {
+        try {
+            auto [res, index] = _logical_device->acquireNextImageKHR(*_swapchain, timeout, *frame.image_available, VK_NULL_HANDLE);
+            // suboptimal still presents fine, recreate at the start of the next frame
+            _swapchain_dirty = res == vk::Result::eSuboptimalKHR;
+            image_index = index;
+        } catch (const vk::OutOfDateKHRError &) {
+            _swapchain_dirty = true;
+            return;
+        }
+    }
+
+    // picked once per frame, the uniforms and the passes have to agree on it
+    _render_extent = _resolution ? _resolution->render_extent(_swapchain_info.extent) : _swapchain_info.extent;
+
+    // the timeline wait also retired this frame's streaming partition and command pools
+    write_frame_data(frame.dynamic_offsets);
+    record_commands(_frame_index, image_index);
 
     //--- Draw to Image
-    vk::PipelineStageFlags wait_stages[] = {
-            vk::PipelineStageFlagBits::eColorAttachmentOutput,
-    };
+    // the swapchain only speaks binary semaphores, the timeline signal is added by the submit itself
+    std::array<vk::SemaphoreSubmitInfo, 2> wait_infos;
+    uint32_t wait_count = 0;
+    if (!headless)
+    {
+        wait_infos[wait_count++] = {
+                .sType = vk::StructureType::eSemaphoreSubmitInfo,
+                .semaphore = *frame.image_available,
+                .stageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+        };
+    }
 
-    vk::SubmitInfo submit_info = {
-            .sType = vk::StructureType::eSubmitInfo,
-            .waitSemaphoreCount = 1,
-            .pWaitSemaphores = &_draw_locks[_frame_counter].get(),
-            .pWaitDstStageMask = wait_stages,
-            .commandBufferCount = 1,
-            .pCommandBuffers = &_command_buffers[image_index].get(),
-            .signalSemaphoreCount = 1,
-            .pSignalSemaphores = &_present_locks[_frame_counter].get(),
+    // results of compute work submitted during the frame, waited for only at the stages reading them
+    if (auto handoff = _async_compute->take_handoff())
+        wait_infos[wait_count++] = *handoff;
+
+    vk::SemaphoreSubmitInfo signal_info = {
+            .sType = vk::StructureType::eSemaphoreSubmitInfo,
+            .semaphore = headless ? vk::Semaphore() : *_present_locks[image_index],
+            .stageMask = vk::PipelineStageFlagBits2::eAllCommands,
     };
 
-    _graphics_queue.submit(submit_info, *_draw_fences[_frame_counter]);
+    frame.timeline_value = _graphics_timeline->submit(
+            std::span(&frame.command_buffer, 1),
+            std::span(wait_infos.data(), wait_count),
+            std::span(&signal_info, headless ? 0U : 1U));
 
     //--- Present Image
-    vk::PresentInfoKHR present_info = {
-            .sType = vk::StructureType::ePresentInfoKHR,
-            .waitSemaphoreCount = 1,
-            .pWaitSemaphores = &_present_locks[_frame_counter].get(),
-            .swapchainCount = 1,
-            .pSwapchains = &_swapchain.get(),
-            .pImageIndices = &image_index,
-    };
+    if (!headless)
+    {
+        uint64_t present_id = _present_latency ? _present_latency->next_present(input_time) : 0;
 
-    result = _presentation_queue.presentKHR(present_info);
-    check(result == vk::Result::eSuccess);
+        vk::PresentIdKHR present_id_info = {
+                .sType = vk::StructureType::ePresentIdKHR,
+                .swapchainCount = 1,
+                .pPresentIds = &present_id,
+        };
+
+        vk::PresentInfoKHR present_info = {
+                .sType = vk::StructureType::ePresentInfoKHR,
+                .pNext = _present_latency ? &present_id_info : nullptr,
+                .waitSemaphoreCount = 1,
+                .pWaitSemaphores = &_present_locks[image_index].get(),
+                .swapchainCount = 1,
+                .pSwapchains = &_swapchain.get(),
+                .pImageIndices = &image_index,
+        };
 
-    // loop frames 0 to MAX_FRAME_DRAWS
-    _frame_counter = (_frame_counter + 1) % MAX_FRAME_DRAWS;
+        // the present still waits on its semaphore when out of date, only the swapchain has to be replaced
+        try {
+            auto result = _presentation_queue.presentKHR(present_info);
+            _swapchain_dirty |= result == vk::Result::eSuboptimalKHR;
+        } catch (const vk::OutOfDateKHRError &) {
+            _swapchain_dirty = true;
+        }
+    }
+
+    frame.frame_number = _frame_number++;
+    frame.cpu_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cpu_start).count();
+    _total_cpu_ms += frame.cpu_ms;
+    frame.pending = true;
+
+    _frame_index = (_frame_index + 1) % static_cast<uint32_t>(_frames.size());
 }
 
 void VulkanRenderer::create_instance()
@@ -98,9 +251,8 @@ void VulkanRenderer::create_instance()
             .apiVersion = VK_API_VERSION_1_3
     };
 
-    uint32_t glfw_ext_count;
-    const char **glfw_exts = glfwGetRequiredInstanceExtensions(&glfw_ext_count);
-    check_DEBUG(verify_instance_extension_support({glfw_exts, glfw_ext_count}));
+    auto instance_exts = _window->required_instance_extensions();
+    check_DEBUG(verify_instance_extension_support(instance_exts));
 
     static vk::DebugUtilsMessengerCreateInfoEXT debug_create_info = {
             .sType = vk::StructureType::eDebugUtilsMessengerCreateInfoEXT,
@@ -125,8 +277,8 @@ void VulkanRenderer::create_instance()
 			.pApplicationInfo = &app_info,
 			.enabledLayerCount = static_cast<uint32_t>(ici_enabled_layer_count),
 			.ppEnabledLayerNames = ici_enabled_layer_names,
-			.enabledExtensionCount = glfw_ext_count,
-			.ppEnabledExtensionNames = glfw_exts,
+			.enabledExtensionCount = static_cast<uint32_t>(instance_exts.size()),
+			.ppEnabledExtensionNames = instance_exts.data(),
     };
     _instance = vk::createInstanceUnique(instance_create_info);
 }
@@ -145,6 +297,14 @@ void VulkanRenderer::create_logical_device()
             _queue_family_info.graphics_family_index,
             _queue_family_info.presentation_family_index
     };
+    if (_queue_family_info.has_dedicated_transfer())
+    {
+        queue_family_indices.insert(_queue_family_info.transfer_family_index);
+    }
+    if (_queue_family_info.has_dedicated_compute())
+    {
+        queue_family_indices.insert(_queue_family_info.compute_family_index);
+    }
 
     for (auto index : queue_family_indices)
     {
@@ -158,23 +318,202 @@ void VulkanRenderer::create_logical_device()
         dev_queue_create_info_collection.emplace_back(device_queue_create_info);
     }
 
+    auto device_exts = required_device_extensions();
+    bool present_wait = supports_present_wait();
+    if (present_wait)
+    {
+        device_exts.insert(device_exts.end(), PRESENT_WAIT_EXTENSIONS.begin(), PRESENT_WAIT_EXTENSIONS.end());
+    }
+
+    // selection only kept devices with everything required, see DeviceProfile::missing_requirement
+    const auto &supported_features = _device_profile.features();
+
+    // only request what is both asked for and supported, the profiler checks support again on its own
+    vk::PhysicalDeviceFeatures enabled_features = {
+            .multiDrawIndirect = true,
+            .drawIndirectFirstInstance = true,
+            .pipelineStatisticsQuery = _config.gpu_profiling && _config.pipeline_statistics &&
+                                       supported_features.pipelineStatisticsQuery,
+            // bindless arrays are indexed with push constant and uniform values, see shaders/bindless.glsl
+            .shaderSampledImageArrayDynamicIndexing = true,
+            .shaderStorageBufferArrayDynamicIndexing = true,
+            // statistics scopes wrap passes recorded into secondaries
+            .inheritedQueries = _config.gpu_profiling && _config.pipeline_statistics &&
+                                supported_features.inheritedQueries,
+    };
+
+    vk::PhysicalDevicePresentWaitFeaturesKHR present_wait_features = {
+            .sType = vk::StructureType::ePhysicalDevicePresentWaitFeaturesKHR,
+            .presentWait = true,
+    };
+
+    vk::PhysicalDevicePresentIdFeaturesKHR present_id_features = {
+            .sType = vk::StructureType::ePhysicalDevicePresentIdFeaturesKHR,
+            .pNext = &present_wait_features,
+            .presentId = true,
+    };
+
+    vk::PhysicalDeviceVulkan13Features enabled_features_13 = {
+            .sType = vk::StructureType::ePhysicalDeviceVulkan13Features,
+            .pNext = present_wait ? &present_id_features : nullptr,
+            .synchronization2 = true,
+            .dynamicRendering = true,
+    };
+
+    vk::PhysicalDeviceVulkan12Features enabled_features_12 = {
+            .sType = vk::StructureType::ePhysicalDeviceVulkan12Features,
+            .pNext = &enabled_features_13,
+            .drawIndirectCount = true,
+            .descriptorIndexing = true,
+            .shaderSampledImageArrayNonUniformIndexing = true,
+            .descriptorBindingSampledImageUpdateAfterBind = true,
+            .descriptorBindingStorageBufferUpdateAfterBind = true,
+            .descriptorBindingUpdateUnusedWhilePending = true,
+            .descriptorBindingPartiallyBound = true,
+            .runtimeDescriptorArray = true,
+            .timelineSemaphore = true,
+    };
+
     vk::DeviceCreateInfo device_create_info = {
             .sType = vk::StructureType::eDeviceCreateInfo,
+            .pNext = &enabled_features_12,
             .queueCreateInfoCount = static_cast<uint32_t>(dev_queue_create_info_collection.size()),
             .pQueueCreateInfos = dev_queue_create_info_collection.data(),
-            .enabledExtensionCount = static_cast<uint32_t>(DEVICE_EXTENSIONS.size()),
-            .ppEnabledExtensionNames = DEVICE_EXTENSIONS.data()
+            .enabledExtensionCount = static_cast<uint32_t>(device_exts.size()),
+            .ppEnabledExtensionNames = device_exts.data(),
+            .pEnabledFeatures = &enabled_features,
     };
 
     _logical_device = _physical_device.createDeviceUnique(device_create_info);
 
     _logical_device->getQueue(_queue_family_info.graphics_family_index, 0, &_graphics_queue);
     _logical_device->getQueue(_queue_family_info.presentation_family_index, 0, &_presentation_queue);
+    _transfer_queue = _queue_family_info.has_dedicated_transfer()
+            ? _logical_device->getQueue(_queue_family_info.transfer_family_index, 0)
+            : _graphics_queue;
+    _compute_queue = _queue_family_info.has_dedicated_compute()
+            ? _logical_device->getQueue(_queue_family_info.compute_family_index, 0)
+            : _graphics_queue;
 }
 
-void VulkanRenderer::create_swapchain()
+void VulkanRenderer::create_queue_timelines()
 {
-    _swapchain_info = SwapchainInfo::get_info(_physical_device, *_surface, _window);
+    auto graphics_family = static_cast<uint32_t>(_queue_family_info.graphics_family_index);
+    _graphics_timeline = std::make_unique<QueueTimeline>(*_logical_device, _graphics_queue, graphics_family);
+
+    // without a dedicated family transfers go to the graphics queue and share its timeline
+    if (_queue_family_info.has_dedicated_transfer())
+    {
+        auto transfer_family = static_cast<uint32_t>(_queue_family_info.transfer_family_index);
+        _transfer_timeline = std::make_unique<QueueTimeline>(*_logical_device, _transfer_queue, transfer_family);
+    }
+
+    // same for compute, the work is then ordered behind graphics instead of overlapping it
+    if (_queue_family_info.has_dedicated_compute())
+    {
+        auto compute_family = static_cast<uint32_t>(_queue_family_info.compute_family_index);
+        _compute_timeline = std::make_unique<QueueTimeline>(*_logical_device, _compute_queue, compute_family);
+    }
+}
+
+void VulkanRenderer::create_async_compute()
+{
+    auto *compute = _compute_timeline ? _compute_timeline.get() : _graphics_timeline.get();
+    _async_compute = std::make_unique<AsyncCompute>(
+            *_logical_device,
+            compute,
+            _graphics_timeline.get(),
+            frames_in_flight());
+
+    log(Info, "async compute " << (_async_compute->is_async() ? "on queue family " : "shares graphics queue family ")
+              << compute->family_index());
+}
+
+void VulkanRenderer::create_present_latency()
+{
+    // the device only has the extensions when supports_present_wait() said so while creating it
+    if (supports_present_wait())
+        _present_latency = std::make_unique<PresentLatency>(*_logical_device);
+}
+
+void VulkanRenderer::create_allocator()
+{
+    _allocator = std::make_unique<DeviceAllocator>(*_logical_device, _device_profile);
+}
+
+void VulkanRenderer::create_uploader()
+{
+    auto *transfer = _transfer_timeline ? _transfer_timeline.get() : _graphics_timeline.get();
+
+    _uploader = std::make_unique<StagingUploader>(
+            *_logical_device,
+            _allocator.get(),
+            transfer,
+            _graphics_timeline.get());
+}
+
+void VulkanRenderer::create_bindless_heap()
+{
+    _bindless = std::make_unique<BindlessHeap>(*_logical_device, _device_profile, _graphics_timeline.get());
+}
+
+void VulkanRenderer::create_texture_streamer()
+{
+    _textures = std::make_unique<TextureStreamer>(
+            _allocator.get(),
+            _uploader.get(),
+            _bindless.get(),
+            _graphics_timeline.get(),
+            &_workers,
+            static_cast<vk::DeviceSize>(_config.texture_budget_mb) << 20);
+
+    if (_config.texture_path != nullptr)
+    {
+        // sampled from the first frame its tail is uploaded in, the placeholder until then
+        auto texture = _textures->load(_config.texture_path);
+        if (texture)
+            _detail_texture = *texture;
+        else
+            log(Warning, "texture not loaded from " << _config.texture_path << " " << std::string_view(texture.error()));
+        _uploader->flush();
+    }
+}
+
+void VulkanRenderer::create_streaming_buffer()
+{
+    _streaming_buffer = std::make_unique<StreamingBuffer>(
+            *_logical_device,
+            _device_profile,
+            _allocator.get(),
+            frames_in_flight());
+}
+
+void VulkanRenderer::create_gpu_scene()
+{
+    _scene = std::make_unique<GpuScene>(_allocator.get(), _uploader.get(), _bindless.get());
+}
+
+void VulkanRenderer::create_pipeline_cache()
+{
+    auto path = _config.pipeline_cache_path ? _config.pipeline_cache_path : "";
+    _pipeline_cache = std::make_unique<PipelineCache>(*_logical_device, _device_profile, path);
+}
+
+void VulkanRenderer::create_shader_registry()
+{
+    _shader_registry = std::make_unique<ShaderRegistry>(*_logical_device);
+}
+
+void VulkanRenderer::create_swapchain(vk::SwapchainKHR old_swapchain)
+{
+    auto previous_format = _swapchain_info.surface_format;
+    _swapchain_info = SwapchainInfo::get_info(_physical_device, *_surface, _window, to_present_mode(_config.present_policy));
+
+    // pipelines are built for one attachment format, keep it across recreation whenever it is still offered
+    if (old_swapchain && std::ranges::find(_swapchain_info.surface_formats, previous_format) != _swapchain_info.surface_formats.end())
+    {
+        _swapchain_info.surface_format = previous_format;
+    }
 
     uint32_t sci_image_count = _swapchain_info.surface_capabilities.minImageCount + 1;
     if (_swapchain_info.surface_capabilities.maxImageCount != 0)
@@ -209,10 +548,16 @@ void VulkanRenderer::create_swapchain()
 			.compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque,
 			.presentMode = _swapchain_info.present_mode,
 			.clipped = true,
-			.oldSwapchain = nullptr
+			.oldSwapchain = old_swapchain,
     };
 
     _swapchain = _logical_device->createSwapchainKHRUnique(swapchain_create_info);
+    log(Info, "swapchain " << _swapchain_info.extent.width << "x" << _swapchain_info.extent.height
+              << " present mode " << vk::to_string(_swapchain_info.present_mode));
+
+    // ids outstanding on the old swapchain never complete on the new one
+    if (_present_latency)
+        _present_latency->reset();
 
     auto images = _logical_device->getSwapchainImagesKHR(*_swapchain);
 	for (const auto& image : images)
@@ -220,331 +565,581 @@ void VulkanRenderer::create_swapchain()
 		auto img_view = make_image_view(image, _swapchain_info.surface_format.format, vk::ImageAspectFlagBits::eColor);
         _swapchain_images.emplace_back(image, std::move(img_view));
     }
+
+    // per image rather than per frame, the presentation engine may still hold a frame's semaphore when it comes around
+    vk::SemaphoreCreateInfo semaphore_create_info = {
+            .sType = vk::StructureType::eSemaphoreCreateInfo,
+    };
+
+    for ([[maybe_unused]] auto _ : std::views::iota(0U, images.size()))
+    {
+        _present_locks.emplace_back(_logical_device->createSemaphoreUnique(semaphore_create_info));
+    }
 }
 
-void VulkanRenderer::create_render_pass()
+bool VulkanRenderer::recreate_swapchain()
 {
-    vk::AttachmentDescription color_attachment_desc = {
+    // minimized, there is nothing to present to until the window has a size again
+    auto capabilities = _physical_device.getSurfaceCapabilitiesKHR(*_surface);
+    auto framebuffer = _window->framebuffer_extent();
+    if (capabilities.currentExtent.width == 0 || capabilities.currentExtent.height == 0 ||
+        framebuffer.width == 0 || framebuffer.height == 0)
+    {
+        return false;
+    }
+
+    // frames still in flight keep using the old objects, they are destroyed once the first new frame retires
+    RetiredSwapchain retired = {
+            .swapchain = std::move(_swapchain),
+            .images = std::move(_swapchain_images),
+            .present_locks = std::move(_present_locks),
+            .render_graph = std::move(_render_graph),
+            .retire_frame = _frame_number,
+    };
+    _swapchain_images.clear();
+    _present_locks.clear();
+
+    auto format = _swapchain_info.surface_format.format;
+    create_swapchain(*retired.swapchain);
+
+    // pipelines only depend on the attachment format, the extent never forces a rebuild
+    if (_swapchain_info.surface_format.format != format)
+    {
+        log(Warning, "surface format changed, rebuilding the graphics pipeline");
+        _graphics_pipeline = _pipelines->get(make_graphics_pipeline_desc());
+        if (_upscale_pipeline)
+            _upscale_pipeline = _pipelines->get(make_upscale_pipeline_desc());
+    }
+
+    create_render_graph();
+    _retired_swapchains.emplace_back(std::move(retired));
+    return true;
+}
+
+void VulkanRenderer::create_offscreen_targets()
+{
+    _swapchain_info.surface_format = { vk::Format::eR8G8B8A8Unorm, vk::ColorSpaceKHR::eSrgbNonlinear };
+    _swapchain_info.extent = _window->extent();
+
+    vk::ImageCreateInfo image_create_info = {
+            .sType = vk::StructureType::eImageCreateInfo,
+            .imageType = vk::ImageType::e2D,
             .format = _swapchain_info.surface_format.format,
+            .extent = { _swapchain_info.extent.width, _swapchain_info.extent.height, 1 },
+            .mipLevels = 1,
+            .arrayLayers = 1,
             .samples = vk::SampleCountFlagBits::e1,
-            .loadOp = vk::AttachmentLoadOp::eClear,
-            .storeOp = vk::AttachmentStoreOp::eStore,
-            .stencilLoadOp = vk::AttachmentLoadOp::eDontCare,
-            .stencilStoreOp = vk::AttachmentStoreOp::eDontCare,
+            .tiling = vk::ImageTiling::eOptimal,
+            .usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+            .sharingMode = vk::SharingMode::eExclusive,
             .initialLayout = vk::ImageLayout::eUndefined,
-            .finalLayout = vk::ImageLayout::ePresentSrcKHR,
     };
 
-    vk::AttachmentReference color_attachment_ref = {
-            .attachment = 0,
-            .layout = vk::ImageLayout::eColorAttachmentOptimal,
-    };
+    // one image per frame in flight stands in for the swapchain
+    for ([[maybe_unused]] auto _ : std::views::iota(0U, frames_in_flight()))
+    {
+        auto image = _allocator->create_image(image_create_info, MemoryUsage::eGpuOnly);
+        auto img_view = make_image_view(*image.image, _swapchain_info.surface_format.format, vk::ImageAspectFlagBits::eColor);
+        _swapchain_images.emplace_back(*image.image, std::move(img_view));
+        _offscreen_images.emplace_back(std::move(image));
+    }
+}
 
-    vk::SubpassDescription subpass_desc = {
-            .pipelineBindPoint = vk::PipelineBindPoint::eGraphics,
-            .colorAttachmentCount = 1,
-            .pColorAttachments = &color_attachment_ref,
+void VulkanRenderer::create_graphics_pipeline()
+{
+    //--- Pipeline Layout
+    // set 0 per frame data, set 1 the bindless heap, push constants carry the scene's slots in it,
+    // shared by the culling and graphics pipelines
+    vk::DescriptorSetLayout set_layouts[] = {
+            _streaming_buffer->layout(),
+            _bindless->layout(),
     };
 
-    //--- define where our subpass can change image layout state
-    vk::SubpassDependency subpass_dependencies[2];
-    // vk::ImageLayout::eUndefined => vk::ImageLayout::eColorAttachmentOptimal
-    subpass_dependencies[0] = vk::SubpassDependency {
-			.srcSubpass = vk::SubpassExternal,
-			.dstSubpass = 0,
-			.srcStageMask = vk::PipelineStageFlagBits::eBottomOfPipe,
-			.dstStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput,
-			.srcAccessMask = vk::AccessFlagBits::eMemoryRead,
-			.dstAccessMask = vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite,
+    vk::PushConstantRange push_constant_range = {
+            .stageFlags = PUSH_CONSTANT_STAGES,
+            .offset = 0,
+            .size = sizeof(PushConstants),
     };
-    // vk::ImageLayout::eColorAttachmentOptimal => vk::ImageLayout::ePresentSrcKHR,
-    subpass_dependencies[1] = vk::SubpassDependency {
-			.srcSubpass = 0,
-			.dstSubpass = vk::SubpassExternal,
-			.srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput,
-			.dstStageMask = vk::PipelineStageFlagBits::eBottomOfPipe,
-			.srcAccessMask = vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite,
-			.dstAccessMask = vk::AccessFlagBits::eMemoryRead,
+
+	vk::PipelineLayoutCreateInfo pipeline_layout_create_info = {
+			.sType = vk::StructureType::ePipelineLayoutCreateInfo,
+			.setLayoutCount = sizeof set_layouts / sizeof *set_layouts,
+			.pSetLayouts = set_layouts,
+			.pushConstantRangeCount = 1,
+			.pPushConstantRanges = &push_constant_range
+	};
+
+    _pipeline_layout = _logical_device->createPipelineLayoutUnique(pipeline_layout_create_info);
+
+    _depth_format = find_depth_format();
+
+    _pipelines = std::make_unique<PipelineManager>(
+            *_logical_device,
+            _shader_registry.get(),
+            _pipeline_cache->get(),
+            &_workers);
+
+    //--- Graphics Pipeline
+    // compiled on the worker pool, this is the only pipeline so the constructor has to wait for it
+    _graphics_pipeline = _pipelines->get(make_graphics_pipeline_desc());
+
+    //--- Cull Pipeline
+    _cull_pipeline = _pipelines->get_compute(spirv::cull_comp, *_pipeline_layout);
+
+    //--- Upscale Pipeline
+    // the first pipeline sampling the bindless image array, by a uniform index
+    if (_config.dynamic_resolution)
+    {
+        check_DEBUG(_device_profile.features().shaderSampledImageArrayDynamicIndexing);
+        _upscale_pipeline = _pipelines->get(make_upscale_pipeline_desc());
+    }
+}
+
+void VulkanRenderer::create_frame_contexts()
+{
+    vk::CommandPoolCreateInfo command_pool_create_info = {
+            .sType = vk::StructureType::eCommandPoolCreateInfo,
+            .flags = vk::CommandPoolCreateFlagBits::eTransient,
+            .queueFamilyIndex = static_cast<uint32_t>(_queue_family_info.graphics_family_index),
     };
 
-    vk::RenderPassCreateInfo render_pass_create_info = {
-			.sType = vk::StructureType::eRenderPassCreateInfo,
-			.attachmentCount = 1,
-			.pAttachments = &color_attachment_desc,
-			.subpassCount = 1,
-			.pSubpasses = &subpass_desc,
-			.dependencyCount = sizeof subpass_dependencies / sizeof *subpass_dependencies,
-			.pDependencies = subpass_dependencies,
+    vk::SemaphoreCreateInfo semaphore_create_info = {
+            .sType = vk::StructureType::eSemaphoreCreateInfo,
     };
 
-    _render_pass = _logical_device->createRenderPassUnique(render_pass_create_info);
+    _frames.resize(frames_in_flight());
+    for (auto &frame : _frames)
+    {
+        frame.command_pool = _logical_device->createCommandPoolUnique(command_pool_create_info);
+
+        vk::CommandBufferAllocateInfo command_buffer_alloc_info = {
+                .sType = vk::StructureType::eCommandBufferAllocateInfo,
+                .commandPool = *frame.command_pool,
+                .level = vk::CommandBufferLevel::ePrimary,
+                .commandBufferCount = 1,
+        };
+
+        frame.command_buffer = _logical_device->allocateCommandBuffers(command_buffer_alloc_info)[0];
+        frame.image_available = _logical_device->createSemaphoreUnique(semaphore_create_info);
+    }
 }
 
-void VulkanRenderer::create_graphics_pipeline()
+void VulkanRenderer::create_parallel_recorder()
 {
-    //--- Shaders
-    vk::UniqueShaderModule vert_mod = make_shader_module(VERT_PATH);
-    vk::UniqueShaderModule frag_mod = make_shader_module(FRAG_PATH);
+    _recorder = std::make_unique<ParallelRecorder>(
+            *_logical_device,
+            static_cast<uint32_t>(_queue_family_info.graphics_family_index),
+            &_workers,
+            frames_in_flight());
+}
 
-    vk::PipelineShaderStageCreateInfo vert_shader_create_info = {
-            .sType = vk::StructureType::ePipelineShaderStageCreateInfo,
-            .stage = vk::ShaderStageFlagBits::eVertex,
-            .module = *vert_mod,
-            .pName = "main"
-    };
+void VulkanRenderer::create_gpu_profiler()
+{
+    if (!_config.gpu_profiling)
+        return;
+
+    // one profiler slot per frame context since that is what gets submitted
+    _profiler = std::make_unique<GpuProfiler>(
+            *_logical_device,
+            _device_profile,
+            static_cast<uint32_t>(_queue_family_info.graphics_family_index),
+            frames_in_flight(),
+            _config.pipeline_statistics);
+
+    if (_config.profile_csv != nullptr)
+        _profiler->open_csv(_config.profile_csv);
+}
 
-    vk::PipelineShaderStageCreateInfo frag_shader_create_info = {
-            .sType = vk::StructureType::ePipelineShaderStageCreateInfo,
-            .stage = vk::ShaderStageFlagBits::eFragment,
-            .module = *frag_mod,
-            .pName = "main"
-    };
+void VulkanRenderer::create_dynamic_resolution()
+{
+    if (!_config.dynamic_resolution)
+        return;
+
+    // measures what is submitted, so one slot per frame context like the profiler
+    _resolution = std::make_unique<DynamicResolution>(
+            *_logical_device,
+            _device_profile,
+            static_cast<uint32_t>(_queue_family_info.graphics_family_index),
+            frames_in_flight(),
+            _config.gpu_budget_ms,
+            _config.min_render_scale,
+            _config.max_render_scale);
+}
 
-    vk::PipelineShaderStageCreateInfo shader_stages[] = {
-            vert_shader_create_info,
-            frag_shader_create_info
-    };
+void VulkanRenderer::create_meshes()
+{
+    if (_config.mesh_path != nullptr)
+    {
+        // copied straight out of the mapping into the staging ring, the file can go once the uploads are queued
+        auto file = assets::MeshFile::open(_config.mesh_path);
+        if (file && file->mesh_count() > 0)
+        {
+            for (uint32_t i = 0; i < file->mesh_count(); i++)
+            {
+                _meshes.emplace_back(Mesh::create(_allocator.get(), _uploader.get(), *file, i));
+                _scene->add_object(i, glm::mat4(1.0f));
+            }
+
+            // drawn from the first frame the uploads are ready in, see GpuScene::is_ready
+            _scene->build(_meshes);
+            _uploader->flush();
+            return;
+        }
 
-    //--- Vertex Input
-    vk::PipelineVertexInputStateCreateInfo vertex_input_state_create_info = {
-            .sType = vk::StructureType::ePipelineVertexInputStateCreateInfo,
-            // TODO
-            .vertexBindingDescriptionCount = 0,
-            .pVertexBindingDescriptions = nullptr,
-            .vertexAttributeDescriptionCount = 0,
-            .pVertexAttributeDescriptions = nullptr,
-    };
+        log(Warning, "cooked meshes not loaded from " << _config.mesh_path << " "
+                     << (file ? std::string_view("no meshes") : std::string_view(file.error())));
+    }
 
-    //--- Input Assembly
-    vk::PipelineInputAssemblyStateCreateInfo input_assembly_state_create_info = {
-            .sType = vk::StructureType::ePipelineInputAssemblyStateCreateInfo,
-            .topology = vk::PrimitiveTopology::eTriangleList,
-            .primitiveRestartEnable = false,
+    const Vertex vertices[] = {
+            { .position = { 0.0f, -0.4f, 0.0f}, .color = {1.0f, 0.0f, 0.0f} },
+            { .position = { 0.4f,  0.4f, 0.0f}, .color = {0.0f, 1.0f, 0.0f} },
+            { .position = {-0.4f,  0.4f, 0.0f}, .color = {0.0f, 0.0f, 1.0f} },
     };
+    constexpr uint32_t indices[] = { 0, 1, 2 };
 
-    //--- Viewport and Scissor
-    vk::Viewport viewport = {
-            .x = 0.0f,
-            .y = 0.0f,
-            .width = static_cast<float>(_swapchain_info.extent.width),
-            .height = static_cast<float>(_swapchain_info.extent.height),
-            .minDepth = 0.0f,
-            .maxDepth = 1.0f,
-    };
+    _meshes.emplace_back(Mesh::create(_allocator.get(), _uploader.get(), vertices, indices));
 
-    vk::Rect2D scissor = {
-            .offset = {0, 0},
-            .extent = _swapchain_info.extent
-    };
+    _scene->add_object(0, glm::mat4(1.0f));
+    _scene->build(_meshes);
+    _uploader->flush();
+}
 
-    vk::PipelineViewportStateCreateInfo viewport_state_create_info = {
-            .sType = vk::StructureType::ePipelineViewportStateCreateInfo,
-            .viewportCount = 1,
-            .pViewports = &viewport,
-            .scissorCount = 1,
-            .pScissors = &scissor,
-    };
+void VulkanRenderer::create_render_graph()
+{
+    _render_graph = std::make_unique<RenderGraph>(*_logical_device, _allocator.get());
+    auto &graph = *_render_graph;
+
+    // headless targets are left ready to be read back
+    auto final_access = _window->is_headless() ? ResourceAccess::eTransferSrc : ResourceAccess::ePresent;
+    _backbuffer = graph.import_image("backbuffer", _swapchain_info.surface_format.format, ResourceAccess::eAcquired, final_access);
+
+    // sized for the largest scale once, scaling only changes how much of it is rendered and never reallocates
+    auto target_extent = _resolution ? _resolution->target_extent(_swapchain_info.extent) : _swapchain_info.extent;
+    _scene_color = _resolution ? graph.create_image("scene_color", _swapchain_info.surface_format.format, target_extent) : _backbuffer;
+    _depth = graph.create_image("depth", _depth_format, target_extent);
+
+    // the previous frame's draws are ordered against the clear inside GpuScene::record_cull
+    auto draw_commands = graph.import_buffer("draw_commands", _scene->draw_commands(), ResourceAccess::eNone, ResourceAccess::eNone);
+    auto draw_counts = graph.import_buffer("draw_counts", _scene->draw_counts(), ResourceAccess::eNone, ResourceAccess::eNone);
+
+    graph.add_pass("cull", [this](vk::CommandBuffer command_buffer, uint32_t frame_index) {
+                record_cull_pass(command_buffer, frame_index);
+            })
+            .write(draw_commands, ResourceAccess::eComputeStorageWrite)
+            .write(draw_counts, ResourceAccess::eComputeStorageWrite);
+
+    graph.add_pass("main_pass", [this](vk::CommandBuffer command_buffer, uint32_t frame_index) {
+                record_main_pass(command_buffer, frame_index);
+            })
+            .read(draw_commands, ResourceAccess::eIndirectRead)
+            .read(draw_counts, ResourceAccess::eIndirectRead)
+            .write(_scene_color, ResourceAccess::eColorAttachmentWrite)
+            .write(_depth, ResourceAccess::eDepthAttachmentWrite);
+
+    if (!_resolution)
+    {
+        graph.compile();
+        return;
+    }
 
-    //--- Rasterizer
-    vk::PipelineRasterizationStateCreateInfo rasterization_state_create_info = {
-            .sType = vk::StructureType::ePipelineRasterizationStateCreateInfo,
-            .depthClampEnable = false,
-            .rasterizerDiscardEnable = false,
-            .polygonMode = vk::PolygonMode::eFill,
-            .cullMode = vk::CullModeFlagBits::eBack,
-            .frontFace = vk::FrontFace::eClockwise,
-            .depthBiasEnable = false,
-            .lineWidth = 1.0f,
-    };
+    graph.add_pass("upscale", [this](vk::CommandBuffer command_buffer, uint32_t frame_index) {
+                record_upscale_pass(command_buffer, frame_index);
+            })
+            .read(_scene_color, ResourceAccess::eFragmentSampledRead)
+            .write(_backbuffer, ResourceAccess::eColorAttachmentWrite);
 
-    //--- Multisampling
-    vk::PipelineMultisampleStateCreateInfo multisample_state_create_info = {
-            .sType = vk::StructureType::ePipelineMultisampleStateCreateInfo,
-            .rasterizationSamples = vk::SampleCountFlagBits::e1,
-            .sampleShadingEnable = false,
-    };
+    graph.compile();
 
-    //--- Depth Stencil
-    // TODO
+    // a graph retired with the swapchain may still be sampled through the old slot, it is freed with the frames
+    auto previous_slot = _scene_color_slot;
+    _scene_color_slot = _bindless->add_image(graph.view(_scene_color));
+    if (previous_slot != UINT32_MAX)
+        _bindless->remove_image(previous_slot);
+}
 
-    //--- Blending
-    // equation : (srcColorBlendFactor * new color) colorBlendOp (dstColorBlendFactor * old color)
-    vk::PipelineColorBlendAttachmentState color_blend_attachment_state = {
-            .blendEnable = true,
-            .srcColorBlendFactor = vk::BlendFactor::eSrcAlpha,
-            .dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha,
-            .colorBlendOp = vk::BlendOp::eAdd,
-            .srcAlphaBlendFactor = vk::BlendFactor::eOne,
-            .dstAlphaBlendFactor = vk::BlendFactor::eZero,
-            .alphaBlendOp = vk::BlendOp::eAdd,
-            .colorWriteMask =
-            vk::ColorComponentFlagBits::eR |
-            vk::ColorComponentFlagBits::eG |
-            vk::ColorComponentFlagBits::eB |
-            vk::ColorComponentFlagBits::eA,
-    };
+void VulkanRenderer::write_frame_data(std::span<uint32_t, 2> dynamic_offsets)
+{
+    auto now = std::chrono::steady_clock::now();
+    float time = std::chrono::duration<float>(now - _start_time).count();
+    float delta = std::chrono::duration<float>(now - _last_frame_time).count();
+    _last_frame_time = now;
 
-    vk::PipelineColorBlendStateCreateInfo color_blend_state_create_info = {
-            .sType = vk::StructureType::ePipelineColorBlendStateCreateInfo,
-            .logicOpEnable = false,
-            .attachmentCount = 1,
-            .pAttachments = &color_blend_attachment_state,
-    };
+    _streaming_buffer->begin_frame(_frame_index);
 
-    //--- Dynamic States
-    /*
-    vk::DynamicState dynamic_states[] = {
-            vk::DynamicState::eViewport,
-            vk::DynamicState::eScissor
+    FrameUniforms frame_uniforms = {
+            .view_proj = glm::mat4(1.0f),
+            .time = { time, delta, 0.0f, 0.0f },
+            .scene = { _scene->object_count(), _scene_color_slot, _textures->placeholder_slot(), 0 },
     };
 
-    vk::PipelineDynamicStateCreateInfo dynamic_state_create_info = {
-            .sType = vk::StructureType::ePipelineDynamicStateCreateInfo,
-            .dynamicStateCount = sizeof(dynamic_states) / sizeof(vk::DynamicState),
-            .pDynamicStates = dynamic_states,
-    };
-    */
+    // stretched over the rendered area, so the level it needs follows the render resolution and is requested from it
+    if (_detail_texture)
+    {
+        _textures->request(*_detail_texture, _textures->level_for(*_detail_texture, _render_extent));
+        frame_uniforms.scene.z = _textures->slot(*_detail_texture);
+    }
 
-    //--- Pipeline Layout
-	vk::PipelineLayoutCreateInfo pipeline_layout_create_info = {
-			.sType = vk::StructureType::ePipelineLayoutCreateInfo,
-			// TODO
-			.setLayoutCount = 0,
-			.pSetLayouts = nullptr,
-			.pushConstantRangeCount = 0,
-			.pPushConstantRanges = nullptr
-	};
+    // Gribb-Hartmann, rows of view_proj combined into world space planes, Vulkan clip depth is 0 to w
+    const auto &m = frame_uniforms.view_proj;
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++)
+    {
+        rows[i] = { m[0][i], m[1][i], m[2][i], m[3][i] };
+    }
 
-    _pipeline_layout = _logical_device->createPipelineLayoutUnique(pipeline_layout_create_info);
+    glm::vec4 planes[6] = {
+            rows[3] + rows[0], // left
+            rows[3] - rows[0], // right
+            rows[3] + rows[1], // top
+            rows[3] - rows[1], // bottom
+            rows[2],           // near
+            rows[3] - rows[2], // far
+    };
 
+    for (int i = 0; i < 6; i++)
+    {
+        frame_uniforms.frustum[i] = planes[i] / glm::length(glm::vec3(planes[i]));
+    }
 
-    //--- Graphics Pipeline
-    vk::GraphicsPipelineCreateInfo graphics_pipeline_create_info = {
-            .sType = vk::StructureType::eGraphicsPipelineCreateInfo,
-            .stageCount = sizeof shader_stages / sizeof *shader_stages,
-            .pStages = shader_stages,
-            .pVertexInputState = &vertex_input_state_create_info,
-            .pInputAssemblyState = &input_assembly_state_create_info,
-            .pViewportState = &viewport_state_create_info,
-            .pRasterizationState = &rasterization_state_create_info,
-            .pMultisampleState = &multisample_state_create_info,
-            .pDepthStencilState = nullptr,
-            .pColorBlendState = &color_blend_state_create_info,
-            .pDynamicState = nullptr,
-            .layout = *_pipeline_layout,
-            .renderPass = *_render_pass,
-            .subpass = 0,
-            .basePipelineHandle = VK_NULL_HANDLE,
-            .basePipelineIndex = -1,
+    // a world space length l at clip w covers l * |row 1| / w in ndc, half the rendered height per ndc unit, LODs
+    // coarsen along with the resolution
+    float pixels_per_unit = glm::length(glm::vec3(rows[1])) * 0.5f * static_cast<float>(_render_extent.height);
+    frame_uniforms.lod = { pixels_per_unit, _config.lod_error_pixels, 0.0f, 0.0f };
+
+    auto target = _resolution ? _resolution->target_extent(_swapchain_info.extent) : _swapchain_info.extent;
+    frame_uniforms.resolution = {
+            float(_render_extent.width) / float(target.width),
+            float(_render_extent.height) / float(target.height),
+            1.0f / float(target.width),
+            1.0f / float(target.height),
     };
 
-    auto [result, value] = _logical_device->createGraphicsPipelineUnique(VK_NULL_HANDLE, graphics_pipeline_create_info);
-    check(result == vk::Result::eSuccess);
-    _graphics_pipeline = std::move(value);
+    dynamic_offsets[0] = _streaming_buffer->push(frame_uniforms).offset;
+    // binding 1 is free for per frame storage, nothing uses it yet
+    dynamic_offsets[1] = 0;
 }
 
-void VulkanRenderer::create_framebuffers()
+void VulkanRenderer::record_commands(uint32_t frame_index, uint32_t image_index)
 {
-    _swapchain_framebuffers.reserve(_swapchain_images.size());
+    auto &frame = _frames[frame_index];
+    auto command_buffer = frame.command_buffer;
 
-    for (auto i : std::views::iota(0U, _swapchain_images.size()))
-    {
-		std::array<vk::ImageView, 1> attachments = {
-				*_swapchain_images[i].image_view
-		};
+    vk::CommandBufferBeginInfo command_buffer_begin_info = {
+            .sType = vk::StructureType::eCommandBufferBeginInfo,
+            .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+    };
 
-		vk::FramebufferCreateInfo frame_buffer_create_info = {
-				.sType = vk::StructureType::eFramebufferCreateInfo,
-				.renderPass = *_render_pass,
-				.attachmentCount = static_cast<uint32_t>(attachments.size()),
-				.pAttachments = attachments.data(),
-				.width = _swapchain_info.extent.width,
-				.height = _swapchain_info.extent.height,
-				.layers = 1,
-		};
+    // everything recorded for this frame last time is retired, reset the pools rather than single buffers
+    _logical_device->resetCommandPool(*frame.command_pool);
+    _recorder->begin_frame(frame_index);
+    command_buffer.begin(command_buffer_begin_info);
 
-		_swapchain_framebuffers.emplace_back(_logical_device->createFramebufferUnique(frame_buffer_create_info));
-	}
-}
+    if (_profiler)
+    {
+        _profiler->begin(command_buffer, frame_index);
+    }
+    if (_resolution)
+        _resolution->begin(command_buffer, frame_index);
 
-void VulkanRenderer::create_graphics_command_pool()
-{   
-	vk::CommandPoolCreateInfo command_pool_create_info = {
-			.sType = vk::StructureType::eCommandPoolCreateInfo,
-			.queueFamilyIndex = static_cast<uint32_t>(_queue_family_info.graphics_family_index),
-	};
+    // barriers and layout transitions between and around the passes come from the graph
+    const auto &target = _swapchain_images[image_index];
+    _render_graph->set_image(_backbuffer, target.image, *target.image_view);
+    _render_graph->execute(command_buffer, frame_index);
 
-	_command_pool = _logical_device->createCommandPoolUnique(command_pool_create_info);
+    if (_resolution)
+        _resolution->end(command_buffer, frame_index);
+    command_buffer.end();
 }
 
-void VulkanRenderer::create_command_buffers()
+void VulkanRenderer::record_cull_pass(vk::CommandBuffer command_buffer, uint32_t frame_index)
 {
-    vk::CommandBufferAllocateInfo command_buffer_alloc_info = {
-			.sType = vk::StructureType::eCommandBufferAllocateInfo,
-			.commandPool = *_command_pool,
-			.level = vk::CommandBufferLevel::ePrimary,
-			.commandBufferCount = static_cast<uint32_t>(_swapchain_framebuffers.size()),
+    uint32_t cull_scope = _profiler ? _profiler->begin_scope(command_buffer, frame_index, "cull") : 0;
+
+    vk::DescriptorSet descriptor_sets[] = {
+            _streaming_buffer->descriptor_set(),
+            _bindless->descriptor_set(),
     };
 
-    _command_buffers = _logical_device->allocateCommandBuffersUnique(command_buffer_alloc_info);
+    command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, _cull_pipeline);
+    command_buffer.bindDescriptorSets(
+            vk::PipelineBindPoint::eCompute, *_pipeline_layout, 0, descriptor_sets, _frames[frame_index].dynamic_offsets);
+    command_buffer.pushConstants(
+            *_pipeline_layout, PUSH_CONSTANT_STAGES, 0, sizeof(PushConstants), &_scene->push_constants());
+    _scene->record_cull(command_buffer);
+
+    if (_profiler)
+        _profiler->end_scope(command_buffer, frame_index, cull_scope);
 }
 
-void VulkanRenderer::create_synchronization()
+void VulkanRenderer::record_main_pass(vk::CommandBuffer command_buffer, uint32_t frame_index)
 {
-    vk::SemaphoreCreateInfo semaphore_create_info = {
-            .sType = vk::StructureType::eSemaphoreCreateInfo,
+    uint32_t main_pass_scope = _profiler ? _profiler->begin_scope(command_buffer, frame_index, "main_pass", true) : 0;
+
+    const auto &dynamic_offsets = _frames[frame_index].dynamic_offsets;
+    vk::DescriptorSet descriptor_sets[] = {
+            _streaming_buffer->descriptor_set(),
+            _bindless->descriptor_set(),
     };
 
-    vk::FenceCreateInfo fence_create_info = {
-            .sType = vk::StructureType::eFenceCreateInfo,
-            .flags = vk::FenceCreateFlagBits::eSignaled,
+    vk::RenderingAttachmentInfo color_attachment = {
+            .sType = vk::StructureType::eRenderingAttachmentInfo,
+            .imageView = _render_graph->view(_scene_color),
+            .imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+            .loadOp = vk::AttachmentLoadOp::eClear,
+            .storeOp = vk::AttachmentStoreOp::eStore,
+            .clearValue = vk::ClearColorValue(0.5f, 0.6f, 0.4f, 1.0f),
     };
 
-    for ([[maybe_unused]] auto _ : std::views::iota(0U, MAX_FRAME_DRAWS))
-	{
-		_draw_locks.emplace_back(_logical_device->createSemaphoreUnique(semaphore_create_info));
-		_present_locks.emplace_back(_logical_device->createSemaphoreUnique(semaphore_create_info));
-        _draw_fences.emplace_back(_logical_device->createFenceUnique(fence_create_info));
-	}
+    // transient, nothing after the pass reads it
+    vk::RenderingAttachmentInfo depth_attachment = {
+            .sType = vk::StructureType::eRenderingAttachmentInfo,
+            .imageView = _render_graph->view(_depth),
+            .imageLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
+            .loadOp = vk::AttachmentLoadOp::eClear,
+            .storeOp = vk::AttachmentStoreOp::eDontCare,
+            .clearValue = vk::ClearValue(vk::ClearDepthStencilValue{ .depth = 1.0f, .stencil = 0 }),
+    };
+
+    vk::RenderingInfo rendering_info = {
+            .sType = vk::StructureType::eRenderingInfo,
+            .flags = vk::RenderingFlagBits::eContentsSecondaryCommandBuffers,
+            .renderArea = {
+                    .offset = { 0, 0 },
+                    .extent = _render_extent,
+            },
+            .layerCount = 1,
+            .colorAttachmentCount = 1,
+            .pColorAttachments = &color_attachment,
+            .pDepthAttachment = &depth_attachment,
+    };
+
+    auto color_format = _swapchain_info.surface_format.format;
+    vk::CommandBufferInheritanceRenderingInfo inheritance_rendering_info = {
+            .sType = vk::StructureType::eCommandBufferInheritanceRenderingInfo,
+            .colorAttachmentCount = 1,
+            .pColorAttachmentFormats = &color_format,
+            .depthAttachmentFormat = _depth_format,
+            .rasterizationSamples = vk::SampleCountFlagBits::e1,
+    };
+
+    vk::CommandBufferInheritanceInfo inheritance_info = {
+            .sType = vk::StructureType::eCommandBufferInheritanceInfo,
+            .pNext = &inheritance_rendering_info,
+            .pipelineStatistics = _profiler ? _profiler->statistics_flags() : vk::QueryPipelineStatisticFlags(),
+    };
+
+    vk::Viewport viewport = {
+            .x = 0.0f,
+            .y = 0.0f,
+            .width = static_cast<float>(_render_extent.width),
+            .height = static_cast<float>(_render_extent.height),
+            .minDepth = 0.0f,
+            .maxDepth = 1.0f,
+    };
+
+    command_buffer.beginRendering(rendering_info);
+
+    // secondaries inherit no state, every one binds its own pipeline and sets
+    auto secondaries = _recorder->record(
+            inheritance_info,
+            static_cast<uint32_t>(_meshes.size()),
+            [&](vk::CommandBuffer secondary, uint32_t first, uint32_t last) {
+                secondary.setViewport(0, viewport);
+                secondary.setScissor(0, rendering_info.renderArea);
+                secondary.bindPipeline(vk::PipelineBindPoint::eGraphics, _graphics_pipeline);
+                secondary.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *_pipeline_layout, 0, descriptor_sets, dynamic_offsets);
+                secondary.pushConstants(
+                        *_pipeline_layout, PUSH_CONSTANT_STAGES, 0, sizeof(PushConstants), &_scene->push_constants());
+                _scene->record_draws(secondary, _meshes, first, last);
+            });
+
+    command_buffer.executeCommands(secondaries);
+    command_buffer.endRendering();
+
+    if (_profiler)
+        _profiler->end_scope(command_buffer, frame_index, main_pass_scope);
 }
 
-void VulkanRenderer::record_commands()
+void VulkanRenderer::record_upscale_pass(vk::CommandBuffer command_buffer, uint32_t frame_index)
 {
-    vk::CommandBufferBeginInfo command_buffer_begin_info = {
-            .sType = vk::StructureType::eCommandBufferBeginInfo,
+    uint32_t upscale_scope = _profiler ? _profiler->begin_scope(command_buffer, frame_index, "upscale") : 0;
+
+    vk::DescriptorSet descriptor_sets[] = {
+            _streaming_buffer->descriptor_set(),
+            _bindless->descriptor_set(),
     };
 
-    vk::ClearValue clear_values[] = {
-            vk::ClearColorValue(0.5f, 0.6f, 0.4f, 1.0f)
+    // every pixel is written, the previous contents never matter
+    vk::RenderingAttachmentInfo color_attachment = {
+            .sType = vk::StructureType::eRenderingAttachmentInfo,
+            .imageView = _render_graph->view(_backbuffer),
+            .imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+            .loadOp = vk::AttachmentLoadOp::eDontCare,
+            .storeOp = vk::AttachmentStoreOp::eStore,
     };
 
-    vk::RenderPassBeginInfo render_pass_begin_info = {
-            .sType = vk::StructureType::eRenderPassBeginInfo,
-            .renderPass = *_render_pass,
+    vk::RenderingInfo rendering_info = {
+            .sType = vk::StructureType::eRenderingInfo,
             .renderArea = {
                     .offset = { 0, 0 },
                     .extent = _swapchain_info.extent,
             },
-            .clearValueCount = sizeof clear_values / sizeof *clear_values,
-            .pClearValues = clear_values,
+            .layerCount = 1,
+            .colorAttachmentCount = 1,
+            .pColorAttachments = &color_attachment,
     };
 
-    for (size_t i = 0; i < _command_buffers.size(); i++)
-    {
-        _command_buffers[i]->begin(command_buffer_begin_info);
+    vk::Viewport viewport = {
+            .x = 0.0f,
+            .y = 0.0f,
+            .width = static_cast<float>(_swapchain_info.extent.width),
+            .height = static_cast<float>(_swapchain_info.extent.height),
+            .minDepth = 0.0f,
+            .maxDepth = 1.0f,
+    };
 
-        render_pass_begin_info.framebuffer = *_swapchain_framebuffers[i];
-		_command_buffers[i]->beginRenderPass(render_pass_begin_info, vk::SubpassContents::eInline);
-        // Render Pass
-        {
-			_command_buffers[i]->bindPipeline(vk::PipelineBindPoint::eGraphics, *_graphics_pipeline);
-			_command_buffers[i]->draw(3, 1, 0, 0);
-        }
+    command_buffer.beginRendering(rendering_info);
+    command_buffer.setViewport(0, viewport);
+    command_buffer.setScissor(0, rendering_info.renderArea);
+    command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, _upscale_pipeline);
+    command_buffer.bindDescriptorSets(
+            vk::PipelineBindPoint::eGraphics, *_pipeline_layout, 0, descriptor_sets, _frames[frame_index].dynamic_offsets);
+    command_buffer.draw(3, 1, 0, 0);
+    command_buffer.endRendering();
+
+    if (_profiler)
+        _profiler->end_scope(command_buffer, frame_index, upscale_scope);
+}
 
-		_command_buffers[i]->endRenderPass();
+PipelineDesc VulkanRenderer::make_graphics_pipeline_desc() const
+{
+    auto vertex_bindings = Vertex::bindings();
+    auto vertex_attributes = Vertex::attributes();
+
+    return {
+            .vertex_shader = spirv::shader_vert,
+            .fragment_shader = spirv::shader_frag,
+            .vertex_bindings = { vertex_bindings.begin(), vertex_bindings.end() },
+            .vertex_attributes = { vertex_attributes.begin(), vertex_attributes.end() },
+            .cull_mode = vk::CullModeFlagBits::eBack,
+            .alpha_blend = false,
+            .layout = *_pipeline_layout,
+            .color_formats = { _swapchain_info.surface_format.format },
+            .depth_format = _depth_format,
+    };
+}
 
-        _command_buffers[i]->end();
-    }
+PipelineDesc VulkanRenderer::make_upscale_pipeline_desc() const
+{
+    // a fullscreen triangle made up in the vertex shader, no vertex input and no depth
+    return {
+            .vertex_shader = spirv::upscale_vert,
+            .fragment_shader = spirv::upscale_frag,
+            .cull_mode = vk::CullModeFlagBits::eNone,
+            .alpha_blend = false,
+            .layout = *_pipeline_layout,
+            .color_formats = { _swapchain_info.surface_format.format },
+    };
 }
 
 vk::UniqueImageView
@@ -572,70 +1167,107 @@ VulkanRenderer::make_image_view(vk::Image image, vk::Format format, vk::ImageAsp
     return _logical_device->createImageViewUnique(image_view_create_info);
 }
 
-vk::UniqueShaderModule VulkanRenderer::make_shader_module(const char *path) const
-{
-    std::ifstream ifs(path, std::ios::binary); // raii
-    check_DEBUG(ifs.is_open());
-    auto code = std::vector<char>(std::istreambuf_iterator<char>(ifs), {});
-
-    vk::ShaderModuleCreateInfo shader_module_create_info = {
-            .sType = vk::StructureType::eShaderModuleCreateInfo,
-            .codeSize = code.size(),
-            .pCode = reinterpret_cast<const uint32_t *>(code.data()),
-    };
-
-    return _logical_device->createShaderModuleUnique(shader_module_create_info);
-}
-
 void VulkanRenderer::retrieve_physical_device()
 {
+    //--- Candidates
+    auto required_exts = required_device_extensions();
     auto devs = _instance->enumeratePhysicalDevices();
-    for (const auto &dev : devs)
+
+    std::vector<DeviceProfile> profiles;
+    std::vector<size_t> suitable; // into profiles
+    for (size_t i = 0; i < devs.size(); i++)
     {
-        auto queue_family_info = QueueFamilyInfo::get_info(dev, *_surface);
-        if (queue_family_info.is_valid())
+        auto &profile = profiles.emplace_back(DeviceProfile::query(devs[i], *_surface));
+
+        const char *missing = profile.missing_requirement(required_exts);
+        if (missing == nullptr && !_window->is_headless() && !SwapchainInfo::get_info(devs[i], *_surface, _window).is_valid())
+            missing = "a usable swapchain";
+
+        if (missing != nullptr)
         {
-            check_DEBUG(verify_physical_device_suitable(dev));
-            _physical_device = dev;
-            _queue_family_info = queue_family_info;
-            return;
+            log(Info, "gpu " << i << " '" << profile.name() << "' skipped, lacks " << missing);
+            continue;
         }
+
+        log(Info, "gpu " << i << " '" << profile.name() << "' scored " << profile.score());
+        suitable.push_back(i);
     }
-}
+    checkf(!suitable.empty(), "no gpu supports the renderer");
 
-bool VulkanRenderer::verify_instance_extension_support(const std::span<const char *> extensions)
-{
-    auto available_exts = vk::enumerateInstanceExtensionProperties();
+    //--- Choice
+    // best score unless overridden by index or name, the environment beats the config so a shipped config can be
+    // worked around on a machine where it picks wrong
+    auto best = *std::ranges::max_element(suitable, {}, [&](size_t i) { return profiles[i].score(); });
 
-    for (const auto ext : extensions)
+    const char *preferred = std::getenv("VENTURE_GPU");
+    if (preferred == nullptr || *preferred == '\0')
+        preferred = _config.gpu;
+
+    if (preferred != nullptr && *preferred != '\0')
     {
-        auto match_ext = [=](vk::ExtensionProperties prop) -> bool {
-            return std::strcmp(ext, prop.extensionName) == 0;
+        std::string_view wanted = preferred;
+        auto matches = [&](size_t i) {
+            if (std::ranges::all_of(wanted, [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; }))
+                return std::to_string(i) == wanted;
+            auto lower = [](char c) { return std::tolower(static_cast<unsigned char>(c)); };
+            return !std::ranges::search(profiles[i].name(), wanted, {}, lower, lower).empty();
         };
 
-        if (std::ranges::find_if(available_exts, match_ext) == available_exts.end())
-        {
-            logf(Error, "instance extension '%s' not supported", ext);
-            return false;
-        }
+        auto match = std::ranges::find_if(suitable, matches);
+        if (match != suitable.end())
+            best = *match;
+        else
+            log(Warning, "no suitable gpu matches '" << wanted << "', using the best scored one");
     }
 
-    return true;
+    _device_profile = profiles[best];
+    _physical_device = _device_profile.physical_device();
+    _queue_family_info = _device_profile.queue_families();
+    log(Info, "using gpu " << best << " '" << _device_profile.name() << "', "
+              << (_device_profile.device_local_bytes() >> 20) << " MiB device local");
 }
 
-bool VulkanRenderer::verify_device_extension_support(vk::PhysicalDevice physical_device)
+std::vector<const char *> VulkanRenderer::required_device_extensions() const
 {
-    auto available_exts = physical_device.enumerateDeviceExtensionProperties();
+    // headless never presents so it needs no swapchain
+    if (_window->is_headless())
+        return {};
+
+    return { DEVICE_EXTENSIONS.begin(), DEVICE_EXTENSIONS.end() };
+}
 
-    for (const auto &dev_ext : DEVICE_EXTENSIONS)
+bool VulkanRenderer::supports_present_wait() const
+{
+    // optional, enabled when the profile has both PRESENT_WAIT_EXTENSIONS and their features
+    return !_window->is_headless() && _device_profile.supports_present_wait();
+}
+
+vk::Format VulkanRenderer::find_depth_format() const
+{
+    // D16 is the only depth format every device has to support as an attachment
+    constexpr vk::Format candidates[] = { vk::Format::eD32Sfloat, vk::Format::eD16Unorm };
+    for (auto format : candidates)
+    {
+        auto props = _physical_device.getFormatProperties(format);
+        if (props.optimalTilingFeatures & vk::FormatFeatureFlagBits::eDepthStencilAttachment)
+            return format;
+    }
+    return vk::Format::eD16Unorm;
+}
+
+bool VulkanRenderer::verify_instance_extension_support(const std::span<const char *> extensions)
+{
+    auto available_exts = vk::enumerateInstanceExtensionProperties();
+
+    for (const auto ext : extensions)
     {
-        auto match_ext = [=](vk::ExtensionProperties ext) -> bool {
-            return std::strcmp(dev_ext, ext.extensionName) == 0;
+        auto match_ext = [=](vk::ExtensionProperties prop) -> bool {
+            return std::strcmp(ext, prop.extensionName) == 0;
         };
 
         if (std::ranges::find_if(available_exts, match_ext) == available_exts.end())
         {
-            logf(Error, "device extension '%s' not supported", dev_ext);
+            logf(Error, "instance extension '%s' not supported", ext);
             return false;
         }
     }
@@ -663,13 +1295,4 @@ bool VulkanRenderer::verify_instance_validation_layer_support()
     return true;
 }
 
-bool VulkanRenderer::verify_physical_device_suitable(vk::PhysicalDevice physical_device) const
-{
-    bool queue_family_valid = QueueFamilyInfo::get_info(physical_device, *_surface).is_valid();
-    bool swap_chain_valid = SwapchainInfo::get_info(physical_device, *_surface, _window).is_valid();
-    bool dev_ext_support = verify_device_extension_support(physical_device);
-
-    return queue_family_valid && swap_chain_valid && dev_ext_support;
-}
-
 } // venture::vulkan
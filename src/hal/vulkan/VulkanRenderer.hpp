@@ -1,13 +1,37 @@
 #pragma once
 
 #include "VulkanApi.hpp"
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <memory>
+#include <optional>
 #include <span>
 #include "VulkanWindow.hpp"
 #include "hal/IRenderer.hpp"
+#include "hal/RendererConfig.hpp"
+#include "AsyncCompute.hpp"
+#include "BindlessHeap.hpp"
+#include "DeviceAllocator.hpp"
+#include "DeviceProfile.hpp"
+#include "DynamicResolution.hpp"
+#include "GpuProfiler.hpp"
+#include "GpuScene.hpp"
+#include "Mesh.hpp"
+#include "ParallelRecorder.hpp"
+#include "PipelineCache.hpp"
+#include "PipelineManager.hpp"
+#include "PresentLatency.hpp"
+#include "RenderGraph.hpp"
+#include "ShaderRegistry.hpp"
+#include "StreamingBuffer.hpp"
+#include "StagingUploader.hpp"
+#include "threading/ThreadPool.hpp"
 #include "QueueFamilyInfo.hpp"
+#include "QueueTimeline.hpp"
 #include "SwapchainInfo.hpp"
 #include "SwapchainImage.hpp"
+#include "TextureStreamer.hpp"
 
 namespace venture::vulkan {
 
@@ -15,82 +39,200 @@ class VulkanRenderer : IRenderer
 {
 public:
     /** VulkanRenderer does not own VulkanWindow the Engine does */
-    explicit VulkanRenderer(VulkanWindow *window);
+    explicit VulkanRenderer(VulkanWindow *window, const RendererConfig &config = {});
     ~VulkanRenderer();
 
     void draw() override;
+    void wait_idle() override;
+
+    /** nullptr unless RendererConfig::gpu_profiling is set */
+    [[nodiscard]]
+    inline const GpuProfiler *profiler() const noexcept;
+    /** nullptr when headless or VK_KHR_present_wait is unsupported */
+    [[nodiscard]]
+    inline const PresentLatency *present_latency() const noexcept;
+    /** nullptr unless RendererConfig::dynamic_resolution is set */
+    [[nodiscard]]
+    inline const DynamicResolution *dynamic_resolution() const noexcept;
+    /** cpu time of every draw() so far without the timeline wait, the sum of each frame's cpu_ms */
+    [[nodiscard]]
+    inline double total_cpu_ms() const noexcept;
+
+    /** takes effect when the swapchain is recreated at the start of the next frame */
+    void set_present_policy(PresentPolicy policy);
 
 private:
     // mutate internal state of renderer
     void create_instance();
     void create_surface();
     void create_logical_device();
-    void create_swapchain();
-    void create_render_pass();
+    void create_queue_timelines();
+    void create_async_compute();
+    void create_present_latency();
+    void create_allocator();
+    void create_uploader();
+    void create_bindless_heap();
+    void create_texture_streamer();
+    void create_streaming_buffer();
+    void create_gpu_scene();
+    void create_pipeline_cache();
+    void create_shader_registry();
+    void create_swapchain(vk::SwapchainKHR old_swapchain = {});
+    /** false while the window is minimized */
+    bool recreate_swapchain();
+    void create_offscreen_targets();
     void create_graphics_pipeline();
-    void create_framebuffers();
-    void create_graphics_command_pool();
-    void create_command_buffers();
-    void create_synchronization();
-
-    void record_commands();
+    void create_frame_contexts();
+    void create_parallel_recorder();
+    void create_gpu_profiler();
+    void create_dynamic_resolution();
+    void create_meshes();
+    void create_render_graph();
+
+    void write_frame_data(std::span<uint32_t, 2> dynamic_offsets);
+    void record_commands(uint32_t frame_index, uint32_t image_index);
+    // render graph passes
+    void record_cull_pass(vk::CommandBuffer command_buffer, uint32_t frame_index);
+    void record_main_pass(vk::CommandBuffer command_buffer, uint32_t frame_index);
+    void record_upscale_pass(vk::CommandBuffer command_buffer, uint32_t frame_index);
 
     // make objects without mutating renderer
     [[nodiscard]]
+    PipelineDesc make_graphics_pipeline_desc() const;
+    [[nodiscard]]
+    PipelineDesc make_upscale_pipeline_desc() const;
+    [[nodiscard]]
     vk::UniqueImageView make_image_view(vk::Image image, vk::Format format, vk::ImageAspectFlagBits flags) const;
+
+    // query, non-mutating
+    [[nodiscard]]
+    inline uint32_t frames_in_flight() const noexcept;
     [[nodiscard]]
-    vk::UniqueShaderModule make_shader_module(const char *path) const;
+    bool supports_present_wait() const;
+    [[nodiscard]]
+    vk::Format find_depth_format() const;
 
     // assign existing data to internal state, nothing created
+    /** the best scored device that can run the renderer, RendererConfig::gpu or VENTURE_GPU override the choice */
     void retrieve_physical_device();
 
+    // query, non-mutating
+    [[nodiscard]]
+    std::vector<const char *> required_device_extensions() const;
+
     // verify, non-mutating
     static bool verify_instance_extension_support(std::span<const char *> extensions);
-    static bool verify_device_extension_support(vk::PhysicalDevice physical_device);
     static bool verify_instance_validation_layer_support();
-    [[nodiscard]]
-    bool verify_physical_device_suitable(vk::PhysicalDevice physical_device) const;
 
 private:
+    /** Owned by one frame in flight, reused once the graphics timeline has reached the frame's value */
+    struct FrameContext
+    {
+        vk::UniqueCommandPool command_pool; // transient, reset wholesale when the frame is recorded again
+        vk::CommandBuffer command_buffer;   // freed with the pool
+        vk::UniqueSemaphore image_available; // binary, acquire cannot signal a timeline
+        std::array<uint32_t, 2> dynamic_offsets = {}; // into the streaming buffer, set 0
+
+        // what was submitted last time this context was used
+        uint64_t timeline_value = 0; // on the graphics timeline, zero is reached from the start
+        uint64_t frame_number = 0;
+        double cpu_ms = 0.0;
+        bool pending = false;
+    };
+
     //--- Core
     vk::UniqueInstance _instance;
     vk::UniqueSurfaceKHR _surface;
     vk::PhysicalDevice _physical_device;
+    DeviceProfile _device_profile; // queried once, subsystems read limits and features from it
     vk::UniqueDevice _logical_device;
+    ThreadPool _workers;
+    std::unique_ptr<DeviceAllocator> _allocator;
 
     //--- Queue
     QueueFamilyInfo _queue_family_info;
     vk::Queue _graphics_queue;
     vk::Queue _presentation_queue;
+    vk::Queue _transfer_queue; // graphics queue when there is no dedicated transfer family
+    std::unique_ptr<QueueTimeline> _graphics_timeline;
+    std::unique_ptr<QueueTimeline> _transfer_timeline; // null when there is no dedicated transfer family
+    vk::Queue _compute_queue; // graphics queue when there is no dedicated compute family
+    std::unique_ptr<QueueTimeline> _compute_timeline; // null when there is no dedicated compute family
+    std::unique_ptr<AsyncCompute> _async_compute; // waits for its submissions, destroyed before the timelines
 
     //--- Swapchain
     SwapchainInfo _swapchain_info;
     vk::UniqueSwapchainKHR _swapchain;
+    std::vector<AllocatedImage> _offscreen_images; // headless only
     std::vector<SwapchainImage> _swapchain_images;
-    std::vector<vk::UniqueFramebuffer> _swapchain_framebuffers;
-    vk::UniqueCommandPool _command_pool;
-    std::vector<vk::UniqueCommandBuffer> _command_buffers;
-
-    //--- Render Pass
-    vk::UniqueRenderPass _render_pass;
+    std::vector<vk::UniqueSemaphore> _present_locks; // per image, presentation holds it until the image returns
+    bool _swapchain_dirty = false; // out of date or suboptimal, recreate before the next frame
+    std::unique_ptr<PresentLatency> _present_latency;
+
+    /** Replaced by a resize but possibly still used by frames in flight */
+    struct RetiredSwapchain
+    {
+        vk::UniqueSwapchainKHR swapchain;
+        std::vector<SwapchainImage> images;
+        std::vector<vk::UniqueSemaphore> present_locks;
+        std::unique_ptr<RenderGraph> render_graph; // transient attachments are sized for the old extent
+        uint64_t retire_frame = 0; // first frame number recorded against the replacement
+    };
+    std::vector<RetiredSwapchain> _retired_swapchains;
+
+    //--- Frames
+    std::vector<FrameContext> _frames;
+    uint32_t _frame_index = 0;
+    uint64_t _frame_number = 0;
+    std::unique_ptr<ParallelRecorder> _recorder;
+
+    //--- Resources
+    std::unique_ptr<StagingUploader> _uploader;
+    std::unique_ptr<BindlessHeap> _bindless; // outlives everything holding slots in it
+    std::unique_ptr<TextureStreamer> _textures;
+    std::optional<TextureHandle> _detail_texture; // RendererConfig::texture_path, laid over the scene in screen space
+    std::vector<Mesh> _meshes;
+    std::unique_ptr<StreamingBuffer> _streaming_buffer;
+    std::unique_ptr<GpuScene> _scene;
+    std::chrono::steady_clock::time_point _start_time = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point _last_frame_time = _start_time;
+
+    //--- Pipelines
+    std::unique_ptr<PipelineCache> _pipeline_cache;
+    std::unique_ptr<ShaderRegistry> _shader_registry;
     vk::UniquePipelineLayout _pipeline_layout;
-    vk::UniquePipeline _graphics_pipeline;
-
-    //--- Synchronization
-    std::vector<vk::UniqueSemaphore> _draw_locks;
-    std::vector<vk::UniqueSemaphore> _present_locks;
-    std::vector<vk::UniqueFence> _draw_fences;
-    int32_t _frame_counter = 0;
+    std::unique_ptr<PipelineManager> _pipelines;
+    vk::Pipeline _graphics_pipeline; // owned by _pipelines
+    vk::Pipeline _cull_pipeline; // owned by _pipelines
+    vk::Pipeline _upscale_pipeline; // owned by _pipelines, null without dynamic resolution
+
+    //--- Render Graph
+    // rebuilt with the swapchain, transient attachments follow its extent
+    std::unique_ptr<RenderGraph> _render_graph;
+    RenderGraphResource _backbuffer = 0; // the acquired swapchain image, or offscreen target when headless
+    RenderGraphResource _depth = 0;
+    vk::Format _depth_format = vk::Format::eUndefined;
+    RenderGraphResource _scene_color = 0; // what the main pass renders to, the backbuffer without dynamic resolution
+    uint32_t _scene_color_slot = UINT32_MAX; // in the bindless heap, sampled by the upscale pass
+    vk::Extent2D _render_extent; // rendered part of the scene color, this frame's
+
+    //--- Profiling
+    RendererConfig _config;
+    double _total_cpu_ms = 0.0;
+    std::unique_ptr<GpuProfiler> _profiler;
+    std::unique_ptr<DynamicResolution> _resolution;
 
-    constexpr static uint32_t MAX_FRAME_DRAWS = 2; // zero indexed so 2 is 3
-    constexpr static const char *VERT_PATH = "../spirv/vert.spv";
-    constexpr static const char *FRAG_PATH = "../spirv/frag.spv";
     constexpr static std::array<const char *, 1> VALIDATION_LAYERS = {
             "VK_LAYER_KHRONOS_validation",
     };
     constexpr static std::array<const char *, 1> DEVICE_EXTENSIONS = {
             VK_KHR_SWAPCHAIN_EXTENSION_NAME
     };
+    // optional, enabled when supported for present latency measurement
+    constexpr static std::array<const char *, 2> PRESENT_WAIT_EXTENSIONS = {
+            VK_KHR_PRESENT_ID_EXTENSION_NAME,
+            VK_KHR_PRESENT_WAIT_EXTENSION_NAME,
+    };
 
 #ifndef V_DIST
     constexpr static bool VALIDATION_LAYERS_ENABLED = true;
@@ -99,4 +241,10 @@ private:
 #endif
 };
 
+const GpuProfiler *VulkanRenderer::profiler() const noexcept { return _profiler.get(); }
+const PresentLatency *VulkanRenderer::present_latency() const noexcept { return _present_latency.get(); }
+const DynamicResolution *VulkanRenderer::dynamic_resolution() const noexcept { return _resolution.get(); }
+double VulkanRenderer::total_cpu_ms() const noexcept { return _total_cpu_ms; }
+uint32_t VulkanRenderer::frames_in_flight() const noexcept { return std::max(_config.frames_in_flight, 1U); }
+
 } // venture
@@ -3,29 +3,70 @@
 
 namespace venture::vulkan {
 
-VulkanWindow::VulkanWindow(int32_t width, int32_t height, std::string_view name, bool resizeable)
+VulkanWindow::VulkanWindow(int32_t width, int32_t height, std::string_view name, bool resizeable, bool headless)
+        : _width(width),
+          _height(height),
+          _headless(headless)
 {
+    // no display required, nothing to create
+    if (_headless)
+        return;
+
     glfwInit();
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE); // TODO
-    (void)resizeable;                           // TODO
+    glfwWindowHint(GLFW_RESIZABLE, resizeable ? GLFW_TRUE : GLFW_FALSE);
 
     _window = glfwCreateWindow(width, height, name.data(), nullptr, nullptr);
     checkf(_window != nullptr, "glfw create window");
+
+    glfwSetWindowUserPointer(_window, this);
+    glfwSetFramebufferSizeCallback(_window, framebuffer_size_callback);
 }
 
 VulkanWindow::~VulkanWindow()
 {
+    if (_headless)
+        return;
+
     glfwDestroyWindow(_window);
     glfwTerminate();
 }
 
 vk::UniqueSurfaceKHR VulkanWindow::create_surface_unique(vk::Instance instance) const
 {
+    check_DEBUG(!_headless);
+
     VkSurfaceKHR surface;
     check(glfwCreateWindowSurface(instance, _window, nullptr, &surface) == VK_SUCCESS);
     return vk::UniqueSurfaceKHR(surface, instance);
 }
 
-} // venture::vulkan
+vk::Extent2D VulkanWindow::framebuffer_extent() const
+{
+    if (_headless)
+        return extent();
+
+    int width, height;
+    glfwGetFramebufferSize(_window, &width, &height);
+    return { static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
+}
 
+void VulkanWindow::framebuffer_size_callback(GLFWwindow *window, int width, int height)
+{
+    auto *self = static_cast<VulkanWindow *>(glfwGetWindowUserPointer(window));
+    self->_width = width;
+    self->_height = height;
+    self->_resized = true;
+}
+
+std::vector<const char *> VulkanWindow::required_instance_extensions() const
+{
+    if (_headless)
+        return {};
+
+    uint32_t glfw_ext_count;
+    const char **glfw_exts = glfwGetRequiredInstanceExtensions(&glfw_ext_count);
+    return { glfw_exts, glfw_exts + glfw_ext_count };
+}
+
+} // venture::vulkan
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "VulkanApi.hpp"
+#include <utility>
+#include <vector>
 #include "hal/IWindow.hpp"
 
 namespace venture::vulkan {
@@ -10,22 +12,50 @@ class SwapchainInfo;
 class VulkanWindow : public IWindow
 {
 public:
-    explicit VulkanWindow(int32_t width, int32_t height, std::string_view name = "Venture", bool resizeable = false);
+    /** a headless window has no GLFW window or surface, the renderer draws to offscreen images instead */
+    explicit VulkanWindow(int32_t width, int32_t height, std::string_view name = "Venture", bool resizeable = false,
+                          bool headless = false);
     ~VulkanWindow();
 
     [[nodiscard]]
     inline bool should_close() noexcept override;
     inline void poll_events() noexcept override;
+    /** block until the next event arrives, nothing to wait for when headless */
+    inline void wait_events() noexcept;
     [[nodiscard]]
     vk::UniqueSurfaceKHR create_surface_unique(vk::Instance instance) const;
+    [[nodiscard]]
+    std::vector<const char *> required_instance_extensions() const;
+
+    [[nodiscard]]
+    inline bool is_headless() const noexcept;
+    [[nodiscard]]
+    inline vk::Extent2D extent() const noexcept;
+    /** size in pixels, zero while minimized */
+    [[nodiscard]]
+    vk::Extent2D framebuffer_extent() const;
+    /** true once after the framebuffer changed size */
+    [[nodiscard]]
+    inline bool consume_resize() noexcept;
+
+private:
+    static void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 
 private:
-    GLFWwindow *_window;
+    GLFWwindow *_window = nullptr;
+    int32_t _width;
+    int32_t _height;
+    bool _headless;
+    bool _resized = false;
 
     friend SwapchainInfo;
 };
 
-bool VulkanWindow::should_close() noexcept { return glfwWindowShouldClose(_window); }
-void VulkanWindow::poll_events() noexcept { glfwPollEvents(); }
+bool VulkanWindow::should_close() noexcept { return !_headless && glfwWindowShouldClose(_window); }
+void VulkanWindow::poll_events() noexcept { if (!_headless) glfwPollEvents(); }
+void VulkanWindow::wait_events() noexcept { if (!_headless) glfwWaitEvents(); }
+bool VulkanWindow::is_headless() const noexcept { return _headless; }
+vk::Extent2D VulkanWindow::extent() const noexcept { return { (uint32_t)_width, (uint32_t)_height }; }
+bool VulkanWindow::consume_resize() noexcept { return std::exchange(_resized, false); }
 
 } // venture::vulkan
@@ -0,0 +1,49 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+namespace venture {
+
+ThreadPool::ThreadPool(uint32_t thread_count)
+{
+    if (thread_count == 0)
+        thread_count = std::max(2U, std::thread::hardware_concurrency()) - 1;
+
+    _workers.reserve(thread_count);
+    for (uint32_t i = 0; i < thread_count; i++)
+        _workers.emplace_back([this] { worker_loop(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _stopping = true;
+    }
+    _condition.notify_all();
+
+    for (auto &worker : _workers)
+        worker.join();
+}
+
+void ThreadPool::worker_loop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(_mutex);
+            _condition.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+
+            if (_stopping && _tasks.empty())
+                return;
+
+            task = std::move(_tasks.front());
+            _tasks.pop();
+        }
+
+        // exceptions are captured by the packaged_task and rethrown from the future
+        task();
+    }
+}
+
+} // venture
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace venture {
+
+/** Fixed size pool of worker threads consuming a FIFO task queue */
+class ThreadPool
+{
+public:
+    /** thread_count of 0 uses one worker per hardware thread, minus the main thread */
+    explicit ThreadPool(uint32_t thread_count = 0);
+    /** finishes every queued task before joining */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    void operator=(const ThreadPool&) = delete;
+
+    template<typename F>
+    [[nodiscard]]
+    std::future<std::invoke_result_t<F>> submit(F &&task);
+
+    [[nodiscard]]
+    inline uint32_t size() const noexcept;
+
+private:
+    void worker_loop();
+
+private:
+    std::vector<std::thread> _workers;
+    std::queue<std::function<void()>> _tasks;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _stopping = false;
+};
+
+template<typename F>
+std::future<std::invoke_result_t<F>> ThreadPool::submit(F &&task)
+{
+    // std::function must be copyable so the move only packaged_task is shared
+    auto packaged = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::forward<F>(task));
+    auto future = packaged->get_future();
+    {
+        std::lock_guard lock(_mutex);
+        _tasks.emplace([packaged] { (*packaged)(); });
+    }
+    _condition.notify_one();
+    return future;
+}
+
+uint32_t ThreadPool::size() const noexcept { return static_cast<uint32_t>(_workers.size()); }
+
+} // venture
@@ -0,0 +1,274 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "hal/vulkan/AsyncCompute.hpp"
+#include "hal/vulkan/QueueTimeline.hpp"
+#include "Expect.hpp"
+
+using namespace venture;
+using namespace venture::vulkan;
+using namespace venture::tests;
+
+// AsyncCompute begin / submit / take_handoff on a headless device. Compute work fills values that the graphics
+// submission waiting on the handoff copies out, run once with compute on the graphics queue (the fallback) and once on
+// a dedicated compute family when the device has one. Exits with EXIT_FAILURE when a check fails and SKIP_EXIT_CODE
+// without a Vulkan 1.3 device
+
+namespace {
+
+constexpr int SKIP_EXIT_CODE = 77;
+constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+constexpr uint32_t ITERATIONS = 4; // every frame's command pool is reused at least once
+
+struct Device
+{
+    vk::UniqueInstance instance;
+    vk::PhysicalDevice physical_device;
+    vk::UniqueDevice device;
+    uint32_t graphics_family = UINT32_MAX;
+    std::optional<uint32_t> compute_family; // compute without graphics
+};
+
+std::optional<Device> create_device()
+{
+    vk::ApplicationInfo app_info = {
+            .sType = vk::StructureType::eApplicationInfo,
+            .pApplicationName = "AsyncComputeTests",
+            .apiVersion = VK_API_VERSION_1_3,
+    };
+    vk::InstanceCreateInfo instance_create_info = {
+            .sType = vk::StructureType::eInstanceCreateInfo,
+            .pApplicationInfo = &app_info,
+    };
+
+    Device result;
+    try {
+        result.instance = vk::createInstanceUnique(instance_create_info);
+    } catch (const vk::IncompatibleDriverError &) {
+        return std::nullopt;
+    }
+
+    for (auto physical_device : result.instance->enumeratePhysicalDevices())
+    {
+        if (physical_device.getProperties().apiVersion < VK_API_VERSION_1_3)
+            continue;
+
+        auto families = physical_device.getQueueFamilyProperties();
+        std::optional<uint32_t> graphics_family;
+        for (uint32_t i = 0; i < families.size(); i++)
+        {
+            bool graphics = bool(families[i].queueFlags & vk::QueueFlagBits::eGraphics);
+            bool compute = bool(families[i].queueFlags & vk::QueueFlagBits::eCompute);
+            if (graphics && !graphics_family)
+                graphics_family = i;
+            if (compute && !graphics && !result.compute_family)
+                result.compute_family = i;
+        }
+
+        if (graphics_family)
+        {
+            result.physical_device = physical_device;
+            result.graphics_family = *graphics_family;
+            break;
+        }
+        result.compute_family.reset();
+    }
+
+    if (!result.physical_device)
+        return std::nullopt;
+
+    float priority = 1.0f;
+    std::vector<vk::DeviceQueueCreateInfo> queue_create_infos;
+    for (auto family : { std::optional(result.graphics_family), result.compute_family })
+    {
+        if (!family)
+            continue;
+        queue_create_infos.push_back({
+                .sType = vk::StructureType::eDeviceQueueCreateInfo,
+                .queueFamilyIndex = *family,
+                .queueCount = 1,
+                .pQueuePriorities = &priority,
+        });
+    }
+
+    // what QueueTimeline needs
+    vk::PhysicalDeviceVulkan13Features features_13 = {
+            .sType = vk::StructureType::ePhysicalDeviceVulkan13Features,
+            .synchronization2 = true,
+    };
+    vk::PhysicalDeviceVulkan12Features features_12 = {
+            .sType = vk::StructureType::ePhysicalDeviceVulkan12Features,
+            .pNext = &features_13,
+            .timelineSemaphore = true,
+    };
+    vk::DeviceCreateInfo device_create_info = {
+            .sType = vk::StructureType::eDeviceCreateInfo,
+            .pNext = &features_12,
+            .queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size()),
+            .pQueueCreateInfos = queue_create_infos.data(),
+    };
+    result.device = result.physical_device.createDeviceUnique(device_create_info);
+    return result;
+}
+
+/** host visible, two compute submissions fill a uint32 each and graphics copies both to the two after them */
+struct HostBuffer
+{
+    vk::UniqueBuffer buffer;
+    vk::UniqueDeviceMemory memory;
+    uint32_t *data = nullptr;
+
+    HostBuffer(const Device &device, std::span<const uint32_t> families)
+    {
+        vk::BufferCreateInfo buffer_create_info = {
+                .sType = vk::StructureType::eBufferCreateInfo,
+                .size = 4 * sizeof(uint32_t),
+                .usage = vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst,
+                .sharingMode = families.size() > 1 ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive,
+                .queueFamilyIndexCount = families.size() > 1 ? static_cast<uint32_t>(families.size()) : 0U,
+                .pQueueFamilyIndices = families.size() > 1 ? families.data() : nullptr,
+        };
+        buffer = device.device->createBufferUnique(buffer_create_info);
+
+        auto requirements = device.device->getBufferMemoryRequirements(*buffer);
+        auto memory_properties = device.physical_device.getMemoryProperties();
+        constexpr auto wanted = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+        uint32_t memory_type = UINT32_MAX;
+        for (uint32_t i = 0; i < memory_properties.memoryTypeCount && memory_type == UINT32_MAX; i++)
+        {
+            if ((requirements.memoryTypeBits & (1U << i)) && (memory_properties.memoryTypes[i].propertyFlags & wanted) == wanted)
+                memory_type = i;
+        }
+
+        vk::MemoryAllocateInfo memory_allocate_info = {
+                .sType = vk::StructureType::eMemoryAllocateInfo,
+                .allocationSize = requirements.size,
+                .memoryTypeIndex = memory_type,
+        };
+        memory = device.device->allocateMemoryUnique(memory_allocate_info);
+        device.device->bindBufferMemory(*buffer, *memory, 0);
+        data = static_cast<uint32_t *>(device.device->mapMemory(*memory, 0, VK_WHOLE_SIZE));
+    }
+};
+
+void run(const Device &device, QueueTimeline *compute, QueueTimeline *graphics, bool expect_async)
+{
+    auto async_compute = std::make_unique<AsyncCompute>(*device.device, compute, graphics, FRAMES_IN_FLIGHT);
+    expect(async_compute->is_async() == expect_async, "is_async matches the queue setup");
+    expect(async_compute->sharing_families().size() == (expect_async ? 2U : 1U), "sharing families match the queue setup");
+    expect(!async_compute->take_handoff(), "no handoff before any submission");
+
+    HostBuffer host(device, async_compute->sharing_families());
+
+    vk::CommandPoolCreateInfo command_pool_create_info = {
+            .sType = vk::StructureType::eCommandPoolCreateInfo,
+            .flags = vk::CommandPoolCreateFlagBits::eTransient,
+            .queueFamilyIndex = graphics->family_index(),
+    };
+    auto graphics_pool = device.device->createCommandPoolUnique(command_pool_create_info);
+
+    uint64_t graphics_value = 0;
+    for (uint32_t i = 0; i < ITERATIONS; i++)
+    {
+        uint32_t frame_index = i % FRAMES_IN_FLIGHT;
+        uint32_t values[] = { 0xC0DE0000 + 2 * i, 0xC0DE0001 + 2 * i };
+
+        // two submissions before the handoff, the one wait has to cover both
+        auto compute_commands = async_compute->begin(frame_index);
+        compute_commands.fillBuffer(*host.buffer, 0, sizeof(uint32_t), values[0]);
+        uint64_t first = async_compute->submit(frame_index, vk::PipelineStageFlagBits2::eCopy);
+
+        uint32_t next_frame_index = (frame_index + 1) % FRAMES_IN_FLIGHT;
+        compute_commands = async_compute->begin(next_frame_index);
+        compute_commands.fillBuffer(*host.buffer, sizeof(uint32_t), sizeof(uint32_t), values[1]);
+        uint64_t second = async_compute->submit(next_frame_index, vk::PipelineStageFlagBits2::eCopy);
+        expect(second > first, "submissions reach increasing values");
+
+        auto handoff = async_compute->take_handoff();
+        expect(handoff.has_value(), "handoff after a submission");
+        expect(!async_compute->take_handoff(), "handoff is taken once");
+        if (!handoff)
+            return;
+        expect(handoff->value == second, "handoff waits for the latest submission");
+        expect(handoff->stageMask == vk::PipelineStageFlagBits2::eCopy, "handoff waits at the submitted stages");
+
+        // the copy only sees the values when the handoff orders it after both fills
+        graphics->wait(graphics_value);
+        device.device->resetCommandPool(*graphics_pool);
+        vk::CommandBufferAllocateInfo command_buffer_allocate_info = {
+                .sType = vk::StructureType::eCommandBufferAllocateInfo,
+                .commandPool = *graphics_pool,
+                .level = vk::CommandBufferLevel::ePrimary,
+                .commandBufferCount = 1,
+        };
+        auto graphics_commands = std::move(device.device->allocateCommandBuffersUnique(command_buffer_allocate_info).front());
+
+        vk::CommandBufferBeginInfo command_buffer_begin_info = {
+                .sType = vk::StructureType::eCommandBufferBeginInfo,
+                .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+        };
+        graphics_commands->begin(command_buffer_begin_info);
+        graphics_commands->copyBuffer(*host.buffer, *host.buffer, vk::BufferCopy{
+                .srcOffset = 0,
+                .dstOffset = 2 * sizeof(uint32_t),
+                .size = 2 * sizeof(uint32_t),
+        });
+        vk::MemoryBarrier2 host_barrier = {
+                .sType = vk::StructureType::eMemoryBarrier2,
+                .srcStageMask = vk::PipelineStageFlagBits2::eCopy,
+                .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+                .dstStageMask = vk::PipelineStageFlagBits2::eHost,
+                .dstAccessMask = vk::AccessFlagBits2::eHostRead,
+        };
+        graphics_commands->pipelineBarrier2({
+                .sType = vk::StructureType::eDependencyInfo,
+                .memoryBarrierCount = 1,
+                .pMemoryBarriers = &host_barrier,
+        });
+        graphics_commands->end();
+
+        graphics_value = graphics->submit(std::span(&graphics_commands.get(), 1), std::span(&*handoff, 1));
+        graphics->wait(graphics_value);
+        expect(host.data[2] == values[0] && host.data[3] == values[1], "graphics sees what both submissions wrote");
+    }
+
+    // the destructor waits for the compute work still in flight
+    async_compute.reset();
+}
+
+} // anonymous
+
+int main()
+{
+    try {
+        auto device = create_device();
+        if (!device)
+        {
+            std::printf("no Vulkan 1.3 device, skipped\n");
+            return SKIP_EXIT_CODE;
+        }
+
+        QueueTimeline graphics(*device->device, device->device->getQueue(device->graphics_family, 0), device->graphics_family);
+        run(*device, &graphics, &graphics, false);
+
+        if (device->compute_family)
+        {
+            auto family = *device->compute_family;
+            QueueTimeline compute(*device->device, device->device->getQueue(family, 0), family);
+            run(*device, &compute, &graphics, true);
+        }
+        else
+        {
+            std::printf("no dedicated compute family, only the fallback path ran\n");
+        }
+
+        device->device->waitIdle();
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "FAILED: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    return report("AsyncCompute");
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// Checks shared by the tests, a failed check is printed and counted and the test carries on
+
+namespace venture::tests {
+
+inline int failures = 0;
+
+inline void expect(bool condition, const char *what)
+{
+    if (!condition)
+    {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/** prints how the checks went, returns the exit code for main */
+inline int report(const char *name)
+{
+    if (failures > 0)
+    {
+        std::fprintf(stderr, "%d %s checks failed\n", failures, name);
+        return EXIT_FAILURE;
+    }
+    std::printf("%s checks passed\n", name);
+    return EXIT_SUCCESS;
+}
+
+} // venture::tests
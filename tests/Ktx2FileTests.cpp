@@ -0,0 +1,180 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+#include "hal/vulkan/Ktx2File.hpp"
+#include "Expect.hpp"
+
+using namespace venture;
+using namespace venture::vulkan;
+using namespace venture::tests;
+
+// Ktx2File::open against hand built files, the texture streamer trusts whatever it accepts. Writes its files to the
+// directory given as the only argument, the build directory under ctest, exits with EXIT_FAILURE when a check fails
+
+namespace {
+
+std::filesystem::path directory;
+
+struct Header
+{
+    uint8_t identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+    uint32_t vk_format = static_cast<uint32_t>(vk::Format::eR8G8B8A8Unorm);
+    uint32_t type_size = 1;
+    uint32_t pixel_width = 4;
+    uint32_t pixel_height = 4;
+    uint32_t pixel_depth = 0;
+    uint32_t layer_count = 0;
+    uint32_t face_count = 1;
+    uint32_t level_count = 3;
+    uint32_t supercompression_scheme = 0;
+    uint32_t dfd_byte_offset = 0;
+    uint32_t dfd_byte_length = 0;
+    uint32_t kvd_byte_offset = 0;
+    uint32_t kvd_byte_length = 0;
+    uint64_t sgd_byte_offset = 0;
+    uint64_t sgd_byte_length = 0;
+};
+
+struct Level
+{
+    uint64_t byte_offset;
+    uint64_t byte_length;
+    uint64_t uncompressed_byte_length;
+};
+
+/** a 4x4 RGBA8 texture with all three levels, smallest level first like the format asks for */
+struct TestFile
+{
+    Header header;
+    std::vector<Level> levels;
+    std::vector<std::byte> data;
+
+    TestFile()
+    {
+        uint64_t data_offset = sizeof(Header) + 3 * sizeof(Level);
+        levels = {
+                { .byte_offset = data_offset + 20, .byte_length = 64, .uncompressed_byte_length = 64 },
+                { .byte_offset = data_offset + 4, .byte_length = 16, .uncompressed_byte_length = 16 },
+                { .byte_offset = data_offset, .byte_length = 4, .uncompressed_byte_length = 4 },
+        };
+        data.resize(84, std::byte{ 0x7F });
+    }
+
+    std::vector<std::byte> bytes() const
+    {
+        std::vector<std::byte> bytes(sizeof header);
+        std::memcpy(bytes.data(), &header, sizeof header);
+        auto index = std::as_bytes(std::span(levels));
+        bytes.insert(bytes.end(), index.begin(), index.end());
+        bytes.insert(bytes.end(), data.begin(), data.end());
+        return bytes;
+    }
+};
+
+std::filesystem::path write(const char *name, std::span<const std::byte> bytes)
+{
+    auto path = directory / name;
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc); // raii
+    ofs.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return path;
+}
+
+void valid_file()
+{
+    auto file = Ktx2File::open(write("venture_valid.ktx2", TestFile().bytes()));
+    expect(file.has_value(), "valid file opens");
+    if (!file)
+        return;
+
+    expect(file->level_count() == 3, "valid file has three levels");
+    expect(file->level(1).extent.width == 2 && file->level(1).extent.height == 2, "level 1 is 2x2");
+    expect(file->level_bytes(1) == 20, "levels 1 and 2 take 20 bytes");
+
+    auto data = file->read_levels(1);
+    expect(data.has_value() && data->size() == 20, "levels 1 and 2 read back");
+}
+
+void truncated_header()
+{
+    auto bytes = TestFile().bytes();
+    bytes.resize(sizeof(Header) - 8);
+    expect(!Ktx2File::open(write("venture_truncated_header.ktx2", bytes)), "truncated header is rejected");
+}
+
+void truncated_level_index()
+{
+    auto bytes = TestFile().bytes();
+    bytes.resize(sizeof(Header) + sizeof(Level));
+    expect(!Ktx2File::open(write("venture_truncated_index.ktx2", bytes)), "truncated level index is rejected");
+}
+
+void level_count_out_of_range()
+{
+    // a 4x4 texture has three levels, and a garbage count must not size the level index
+    TestFile test;
+    test.header.level_count = 4;
+    expect(!Ktx2File::open(write("venture_level_count.ktx2", test.bytes())), "level past 1x1 is rejected");
+
+    test.header.level_count = UINT32_MAX;
+    expect(!Ktx2File::open(write("venture_level_count_max.ktx2", test.bytes())), "huge level count is rejected");
+}
+
+void level_out_of_range()
+{
+    TestFile past_end;
+    past_end.levels[0].byte_offset += 1;
+    expect(!Ktx2File::open(write("venture_level_past_end.ktx2", past_end.bytes())), "level past the end is rejected");
+
+    // offset + length wraps around to a small value
+    TestFile wrapping;
+    wrapping.levels[0].byte_offset = UINT64_MAX - 16;
+    expect(!Ktx2File::open(write("venture_level_wrap.ktx2", wrapping.bytes())), "wrapping level is rejected");
+}
+
+void level_size_mismatch()
+{
+    TestFile test;
+    test.levels[2].byte_length = 8;
+    expect(!Ktx2File::open(write("venture_level_size.ktx2", test.bytes())), "level of the wrong size is rejected");
+}
+
+void truncated_after_open()
+{
+    auto bytes = TestFile().bytes();
+    auto path = write("venture_truncated_after_open.ktx2", bytes);
+    auto file = Ktx2File::open(path);
+    expect(file.has_value(), "file opens before truncation");
+    if (!file)
+        return;
+
+    // the streamer reads levels long after open, a read failure is an error rather than a throw
+    std::filesystem::resize_file(path, sizeof(Header) + 3 * sizeof(Level) + 4);
+    expect(file->read_levels(2).has_value(), "level still in the file reads");
+    expect(!file->read_levels(0).has_value(), "level cut off reports an error");
+}
+
+} // anonymous
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::fprintf(stderr, "usage: %s OUTPUT_DIRECTORY\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    directory = argv[1];
+
+    valid_file();
+    truncated_header();
+    truncated_level_index();
+    level_count_out_of_range();
+    level_out_of_range();
+    level_size_mismatch();
+    truncated_after_open();
+
+    return report("Ktx2File");
+}